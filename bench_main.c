@@ -0,0 +1,701 @@
+/*
+ * Copyright (c) 2025 Rohit Ballurgi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software... [rest of standard MIT short-text]
+ * ...
+ * MIT License (see LICENSE file for full text)
+ */
+
+// Host microbenchmarks (not run by CTest). Usage: ./doda_bench [name-filter]
+#ifdef DRIVERSQL_THREADS
+#define _POSIX_C_SOURCE 200112L // clock_gettime
+#endif
+#include "doda_engine.h"
+#include "doda_scan.h"
+#include "doda_agg.h"
+#include "doda_compress.h"
+#ifdef DRIVERSQL_TIMESERIES
+#include "doda_api.h"
+#include "doda_ring.h"
+#endif
+#ifdef DRIVERSQL_THREADS
+#include "doda_shared.h"
+#include <pthread.h>
+#endif
+#ifdef DODA_PERSIST
+#include "doda_persist.h"
+#include "doda_flash_log.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now_sec(void) { return (double)clock() / (double)CLOCKS_PER_SEC; }
+
+static uint32_t xorshift32(uint32_t *state) {
+    uint32_t x = *state; x ^= x << 13; x ^= x >> 17; x ^= x << 5; *state = x; return x;
+}
+
+static void cb_count(const Table *t, size_t row, void *user) { (void)t; (void)row; (*(size_t *)user)++; }
+
+// Allocate an arena table; returns the arena (caller frees) or NULL
+static void *bench_table(Table *t, const char *name, int ncols, const char **cols, const ColumnType *types, size_t rows) {
+    size_t need = table_arena_bytes(ncols, types, rows);
+    void *arena = malloc(need);
+    if (!arena) return NULL;
+    if (init_table_arena(t, name, ncols, cols, types, arena, need, rows) != DS_OK) { free(arena); return NULL; }
+    return arena;
+}
+
+// Sustained delete/insert churn on the pk hash at 75% table fill.
+static void bench_pk_hash_churn(void) {
+    const char *cols[] = {"id", "v"};
+    ColumnType types[] = {COL_INT, COL_INT};
+    const size_t sizes[] = {1000u, 100000u, 1000000u};
+    printf("pk_hash_churn: rows | lookup ns | delete+insert ns | max_probe | avg_probe\n");
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+        size_t rows = sizes[s], live_n = rows * 3u / 4u;
+        Table *t = (Table *)malloc(sizeof(Table));
+        int *live = (int *)malloc(live_n * sizeof(int));
+        void *arena = t && live ? bench_table(t, "churn", 2, cols, types, rows) : NULL;
+        if (!arena) { free(t); free(live); printf("  %zu: allocation failed\n", rows); continue; }
+
+        uint32_t rng = 0x9E3779B9u; int next_id = 0;
+        for (size_t i = 0; i < live_n; ++i) { int id = next_id++, v = (int)i; const void *vals[] = {&id, &v}; insert_row(t, vals); live[i] = id; }
+
+        size_t ops = rows * 4u, deleted = 0;
+        double t0 = now_sec();
+        for (size_t i = 0; i < ops; ++i) {
+            size_t k = xorshift32(&rng) % live_n;
+            delete_where_eq(t, "id", &live[k], &deleted);
+            int id = next_id++, v = (int)i; const void *vals[] = {&id, &v};
+            insert_row(t, vals); live[k] = id;
+        }
+        double churn = now_sec() - t0;
+
+        size_t found = 0;
+        t0 = now_sec();
+        for (size_t i = 0; i < ops; ++i) select_where_eq(t, "id", &live[xorshift32(&rng) % live_n], cb_count, &found);
+        double lookup = now_sec() - t0;
+
+        PkHashStats hs; pk_hash_stats(t, &hs);
+        printf("  %9zu | %9.1f | %16.1f | %9zu | %9.2f%s\n", rows, lookup * 1e9 / (double)ops, churn * 1e9 / (double)ops,
+               hs.max_probe, hs.keys ? (double)hs.total_probe / (double)hs.keys : 0.0, found == ops ? "" : "  (MISSED KEYS)");
+        free(arena); free(live); free(t);
+    }
+}
+
+// qsort reference for index_build: same row-id permutation via a comparison sort
+static const Column *g_qsort_col;
+static int qsort_rows_cmp(const void *pa, const void *pb) {
+    uint32_t a = *(const uint32_t *)pa, b = *(const uint32_t *)pb; const Column *c = g_qsort_col;
+    switch (c->type) {
+        case COL_INT: return (c->data.int_data[a] > c->data.int_data[b]) - (c->data.int_data[a] < c->data.int_data[b]);
+#ifndef DRIVERSQL_NO_FLOAT
+        case COL_FLOAT: return (c->data.float_data[a] > c->data.float_data[b]) - (c->data.float_data[a] < c->data.float_data[b]);
+#endif
+#ifndef DRIVERSQL_NO_DOUBLE
+        case COL_DOUBLE: return (c->data.double_data[a] > c->data.double_data[b]) - (c->data.double_data[a] < c->data.double_data[b]);
+#endif
+#ifndef DRIVERSQL_NO_TEXT
+        case COL_TEXT: return strncmp(c->data.text_data[a], c->data.text_data[b], MAX_TEXT_LEN);
+#endif
+        default: return 0;
+    }
+}
+
+// index_build (radix) vs qsort on random keys, 1K..10M rows (TEXT up to 1M)
+static void bench_index_build(void) {
+    const struct { const char *name; ColumnType type; } kinds[] = {
+        {"int", COL_INT},
+#ifndef DRIVERSQL_NO_FLOAT
+        {"float", COL_FLOAT},
+#endif
+#ifndef DRIVERSQL_NO_DOUBLE
+        {"double", COL_DOUBLE},
+#endif
+#ifndef DRIVERSQL_NO_TEXT
+        {"text", COL_TEXT},
+#endif
+    };
+    const size_t sizes[] = {1000u, 10000u, 100000u, 1000000u, 10000000u};
+    printf("index_build: type | rows | radix ms | qsort ms\n");
+    for (size_t k = 0; k < sizeof(kinds) / sizeof(kinds[0]); ++k) {
+        const char *name = kinds[k].name; ColumnType kind = kinds[k].type;
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+            size_t rows = sizes[s];
+#ifndef DRIVERSQL_NO_TEXT
+            if (kind == COL_TEXT && rows > 1000000u) continue;
+#endif
+            const char *cols[] = {"id", "k"};
+            ColumnType types[] = {COL_INT, kind};
+            Table *t = (Table *)malloc(sizeof(Table));
+            Index *idx = (Index *)malloc(sizeof(Index));
+            uint32_t *buf = (uint32_t *)malloc(rows * sizeof(uint32_t));
+            void *arena = t && idx && buf ? bench_table(t, "ib", 2, cols, types, rows) : NULL;
+            if (!arena) { free(t); free(idx); free(buf); printf("  %s %zu: allocation failed\n", name, rows); continue; }
+
+            uint32_t rng = 0x2545F491u;
+            for (size_t r = 0; r < rows; ++r) {
+                int id = (int)r; uint32_t x = xorshift32(&rng);
+                int iv = (int)x; const void *v = &iv;
+#ifndef DRIVERSQL_NO_FLOAT
+                float fv = (float)(int)x * 1e-3f; if (kind == COL_FLOAT) v = &fv;
+#endif
+#ifndef DRIVERSQL_NO_DOUBLE
+                double dv = (double)(int)x * 1e-6; if (kind == COL_DOUBLE) v = &dv;
+#endif
+#ifndef DRIVERSQL_NO_TEXT
+                char sv[MAX_TEXT_LEN]; snprintf(sv, sizeof(sv), "dev-%08x", (unsigned)x); if (kind == COL_TEXT) v = sv;
+#endif
+                const void *vals[] = {&id, v};
+                insert_row(t, vals);
+            }
+
+            double t0 = now_sec();
+            index_build_arena(t, idx, "k", buf, rows);
+            double radix = now_sec() - t0;
+
+            for (size_t r = 0; r < rows; ++r) buf[r] = (uint32_t)r;
+            g_qsort_col = &t->columns[1];
+            t0 = now_sec();
+            qsort(buf, rows, sizeof(buf[0]), qsort_rows_cmp);
+            double ref = now_sec() - t0;
+
+            printf("  %6s | %8zu | %8.2f | %8.2f\n", name, rows, radix * 1e3, ref * 1e3);
+            free(arena); free(buf); free(idx); free(t);
+        }
+    }
+}
+
+#if !defined(DRIVERSQL_NO_FLOAT) && !defined(DRIVERSQL_NO_DOUBLE)
+// Threshold scans (select_where_op without an index) over 1M rows, 1/8 deleted
+static void bench_threshold_scan(void) {
+    const size_t rows = 1000000u; const int reps = 20;
+    const char *cols[] = {"id", "i", "f", "d"};
+    ColumnType types[] = {COL_INT, COL_INT, COL_FLOAT, COL_DOUBLE};
+    Table *t = (Table *)malloc(sizeof(Table));
+    void *arena = t ? bench_table(t, "scan", 4, cols, types, rows) : NULL;
+    if (!arena) { free(t); printf("threshold_scan: allocation failed\n"); return; }
+    uint32_t rng = 0xDEADBEEFu;
+    for (size_t r = 0; r < rows; ++r) {
+        int id = (int)r, iv = (int)(xorshift32(&rng) % 1000u); float fv = (float)iv; double dv = (double)iv;
+        const void *vals[] = {&id, &iv, &fv, &dv}; insert_row(t, vals);
+    }
+    for (size_t r = 0; r < rows; r += 8) delete_row(t, r);
+
+    printf("threshold_scan (%s kernels): column | ns/row | matches\n", scan_kernel_name());
+    int ik = 900; float fk = 900.0f; double dk = 900.0;
+    const void *keys[] = {&ik, &fk, &dk};
+    for (int c = 0; c < 3; ++c) {
+        size_t hits = 0;
+        double t0 = now_sec();
+        for (int i = 0; i < reps; ++i) select_where_op(t, cols[c + 1], OP_GT, keys[c], cb_count, &hits);
+        double dt = now_sec() - t0;
+        printf("  %6s | %6.2f | %zu\n", cols[c + 1], dt * 1e9 / ((double)rows * reps), hits / (size_t)reps);
+    }
+    free(arena); free(t);
+}
+#endif
+
+#ifndef DRIVERSQL_NO_DOUBLE
+// "Last minute" on a 1 Hz series of 1M time-ordered rows: scan and filtered aggregate with the
+// time column's zone map vs the same table with the zone map detached
+static void bench_zone_scan(void) {
+    const size_t rows = 1000000u; const int reps = 200;
+    const char *cols[] = {"id", "time", "v"};
+    ColumnType types[] = {COL_INT, COL_INT, COL_DOUBLE};
+    Table *t = (Table *)malloc(sizeof(Table));
+    void *arena = t ? bench_table(t, "zones", 3, cols, types, rows) : NULL;
+    if (!arena) { free(t); printf("zone_scan: allocation failed\n"); return; }
+    for (size_t r = 0; r < rows; ++r) { int id = (int)r, tm = (int)r; double v = (double)(r % 100u); const void *vals[] = {&id, &tm, &v}; insert_row(t, vals); }
+    int since = (int)rows - 60; Predicate last = {"time", OP_GTE, &since};
+    double *zone = t->columns[1].zone, cost[2][2]; size_t hits = 0; AggResult r;
+    for (int z = 0; z < 2; ++z) {
+        t->columns[1].zone = z ? NULL : zone;
+        double t0 = now_sec();
+        for (int i = 0; i < reps; ++i) select_where_op(t, "time", OP_GTE, &since, cb_count, &hits);
+        cost[z][0] = now_sec() - t0; t0 = now_sec();
+        for (int i = 0; i < reps; ++i) agg_column(t, "v", &last, 1, &r);
+        cost[z][1] = now_sec() - t0;
+    }
+    t->columns[1].zone = zone;
+    printf("zone_scan: last 60 of %zu rows | select %.1f us (no zone map %.1f us) | filtered agg %.1f us (no zone map %.1f us)\n",
+           rows, cost[0][0] * 1e6 / reps, cost[1][0] * 1e6 / reps, cost[0][1] * 1e6 / reps, cost[1][1] * 1e6 / reps);
+    free(arena); free(t);
+}
+#endif
+
+static void cb_sum(const Table *t, size_t row, void *user) { *(long long *)user += t->columns[1].data.int_data[row]; }
+
+// Consume a 50%-selective scan per row via callbacks vs 1024-row selection vectors
+static void bench_select_batch(void) {
+    const size_t rows = 1000000u; const int reps = 20;
+    const char *cols[] = {"id", "v"};
+    ColumnType types[] = {COL_INT, COL_INT};
+    Table *t = (Table *)malloc(sizeof(Table));
+    void *arena = t ? bench_table(t, "sel", 2, cols, types, rows) : NULL;
+    if (!arena) { free(t); printf("select_batch: allocation failed\n"); return; }
+    uint32_t rng = 0xC0FFEEu;
+    for (size_t r = 0; r < rows; ++r) { int id = (int)r, v = (int)(xorshift32(&rng) % 1000u); const void *vals[] = {&id, &v}; insert_row(t, vals); }
+
+    int key = 500; long long cb_total = 0, vec_total = 0;
+    double t0 = now_sec();
+    for (int i = 0; i < reps; ++i) select_where_op(t, "v", OP_GTE, &key, cb_sum, &cb_total);
+    double cb = now_sec() - t0;
+
+    uint32_t ids[1024]; Predicate p = {"v", OP_GTE, &key};
+    t0 = now_sec();
+    for (int i = 0; i < reps; ++i) {
+        SelectCursor cur; select_cursor_init(&cur); size_t n;
+        while (select_into(t, &p, ids, 1024u, &cur, &n) == DS_OK && n) for (size_t k = 0; k < n; ++k) vec_total += t->columns[1].data.int_data[ids[k]];
+    }
+    double vec = now_sec() - t0;
+    printf("select_batch: callback %.2f ns/row | select_into %.2f ns/row%s\n", cb * 1e9 / ((double)rows * reps),
+           vec * 1e9 / ((double)rows * reps), cb_total == vec_total ? "" : "  (MISMATCH)");
+    free(arena); free(t);
+}
+
+typedef struct { int t1; int sensor; size_t hits; } WindowFilter;
+static void cb_window(const Table *t, size_t row, void *user) {
+    WindowFilter *w = (WindowFilter *)user;
+    if (t->columns[1].data.int_data[row] < w->t1 && t->columns[2].data.int_data[row] == w->sensor) w->hits++;
+}
+
+// ts >= t0 AND ts < t1 AND sensor == 7 over 1M rows: one select_where_op plus a re-checking
+// callback vs select_where_all, without and with an attached index on ts
+static void bench_conjunctive(void) {
+    const size_t rows = 1000000u; const int reps = 20;
+    const char *cols[] = {"id", "ts", "sensor"};
+    ColumnType types[] = {COL_INT, COL_INT, COL_INT};
+    Table *t = (Table *)malloc(sizeof(Table));
+    Index *idx = (Index *)malloc(sizeof(Index));
+    uint32_t *idx_rows = (uint32_t *)malloc(rows * sizeof(uint32_t));
+    void *arena = t && idx && idx_rows ? bench_table(t, "win", 3, cols, types, rows) : NULL;
+    if (!arena) { free(t); free(idx); free(idx_rows); printf("conjunctive: allocation failed\n"); return; }
+    uint32_t rng = 0xBADC0DEu;
+    for (size_t r = 0; r < rows; ++r) { int id = (int)r, ts = (int)r, s = (int)(xorshift32(&rng) % 16u); const void *vals[] = {&id, &ts, &s}; insert_row(t, vals); }
+
+    int t0 = 200000, t1 = 400000, sensor = 7;
+    Predicate win[] = {{"ts", OP_GTE, &t0}, {"ts", OP_LT, &t1}, {"sensor", OP_EQ, &sensor}};
+    printf("conjunctive: path | callback ns/row | select_where_all ns/row\n");
+    for (int pass = 0; pass < 2; ++pass) {
+        if (pass == 1) { index_build_arena(t, idx, "ts", idx_rows, rows); index_attach(t, idx); }
+        WindowFilter w = {t1, sensor, 0}; size_t hits = 0;
+        double s0 = now_sec();
+        for (int i = 0; i < reps; ++i) select_where_op(t, "ts", OP_GTE, &t0, cb_window, &w);
+        double cb = now_sec() - s0;
+        s0 = now_sec();
+        for (int i = 0; i < reps; ++i) select_where_all(t, win, 3, cb_count, &hits);
+        double all = now_sec() - s0;
+        printf("  %5s | %15.2f | %22.2f%s\n", pass ? "index" : "scan", cb * 1e9 / ((double)rows * reps), all * 1e9 / ((double)rows * reps), w.hits == hits ? "" : "  (MISMATCH)");
+    }
+    free(arena); free(idx_rows); free(idx); free(t);
+}
+
+#if !defined(DRIVERSQL_NO_FLOAT) && !defined(DRIVERSQL_NO_DOUBLE)
+// count/sum/min/max/mean/variance of three metrics: one agg_columns pass vs one pass per
+// metric, plus a 16-device group-by; 1M rows, 1/8 deleted
+static void bench_aggregate(void) {
+    const size_t rows = 1000000u; const int reps = 10;
+    const char *cols[] = {"id", "dev", "i", "f", "d"};
+    ColumnType types[] = {COL_INT, COL_INT, COL_INT, COL_FLOAT, COL_DOUBLE};
+    Table *t = (Table *)malloc(sizeof(Table));
+    void *arena = t ? bench_table(t, "agg", 5, cols, types, rows) : NULL;
+    if (!arena) { free(t); printf("aggregate: allocation failed\n"); return; }
+    uint32_t rng = 0xA66u;
+    for (size_t r = 0; r < rows; ++r) {
+        int id = (int)r, dev = (int)(r % 16u), iv = (int)(xorshift32(&rng) % 100000u); float fv = (float)iv * 0.5f; double dv = (double)iv * 1e-3;
+        const void *vals[] = {&id, &dev, &iv, &fv, &dv}; insert_row(t, vals);
+    }
+    for (size_t r = 0; r < rows; r += 8) delete_row(t, r);
+
+    const char *metrics[] = {"i", "f", "d"}; AggResult out[3]; AggGroup groups[16]; size_t ng = 0;
+    double t0 = now_sec();
+    for (int i = 0; i < reps; ++i) agg_columns(t, metrics, 3, NULL, 0, out);
+    double one = now_sec() - t0;
+    t0 = now_sec();
+    for (int i = 0; i < reps; ++i) for (int k = 0; k < 3; ++k) agg_column(t, metrics[k], NULL, 0, &out[k]);
+    double each = now_sec() - t0;
+    t0 = now_sec();
+    for (int i = 0; i < reps; ++i) agg_group_by(t, "dev", "d", NULL, 0, groups, 16, &ng);
+    double grp = now_sec() - t0;
+    printf("aggregate: 3 metrics one pass %.2f ns/row | pass per metric %.2f ns/row | group_by(16) %.2f ns/row\n",
+           one * 1e9 / ((double)rows * reps), each * 1e9 / ((double)rows * reps), grp * 1e9 / ((double)rows * reps));
+    free(arena); free(t);
+}
+#endif
+
+// insert_row per row vs insert_columns per 10K batch, 1M INT/INT/INT rows
+static void bench_bulk_insert(void) {
+    const size_t rows = 1000000u, batch = 10000u;
+    const char *cols[] = {"id", "time", "value"};
+    ColumnType types[] = {COL_INT, COL_INT, COL_INT};
+    Table *t = (Table *)malloc(sizeof(Table));
+    int *ids = (int *)malloc(rows * sizeof(int)), *times = (int *)malloc(rows * sizeof(int)), *vals = (int *)malloc(rows * sizeof(int));
+    void *arena = t && ids && times && vals ? bench_table(t, "bulk", 3, cols, types, rows) : NULL;
+    if (!arena) { free(vals); free(times); free(ids); free(t); printf("bulk_insert: allocation failed\n"); return; }
+    for (size_t i = 0; i < rows; ++i) { ids[i] = (int)i; times[i] = (int)i * 10; vals[i] = (int)(i & 1023u); }
+
+    double t0 = now_sec();
+    for (size_t i = 0; i < rows; ++i) { const void *row[] = {&ids[i], &times[i], &vals[i]}; insert_row(t, row); }
+    double per_row = now_sec() - t0;
+    size_t n_rows = (size_t)agg_count(t);
+
+    table_clear(t);
+    size_t n_cols = 0;
+    t0 = now_sec();
+    for (size_t base = 0; base < rows; base += batch) {
+        const void *colv[] = {ids + base, times + base, vals + base}; size_t inserted = 0;
+        insert_columns(t, rows - base < batch ? rows - base : batch, colv, NULL, &inserted);
+        n_cols += inserted;
+    }
+    double columnar = now_sec() - t0;
+    printf("bulk_insert: %zu rows | insert_row %.1f ns (%zu) | insert_columns x%zu %.1f ns (%zu)\n", rows,
+           per_row * 1e9 / (double)rows, n_rows, batch, columnar * 1e9 / (double)rows, n_cols);
+    free(arena); free(vals); free(times); free(ids); free(t);
+}
+
+#if !defined(DRIVERSQL_NO_FLOAT) && !defined(DRIVERSQL_NO_DOUBLE)
+// 1 Hz sensor series (time, INT counter, quantized FLOAT/DOUBLE readings) sealed into one block:
+// bytes per sample, seal cost, and a filtered aggregate decoded block-at-a-time vs the table
+static void bench_compress(void) {
+    const size_t rows = 1000000u; const int reps = 5;
+    const char *cols[] = {"id", "time", "count", "temp", "volt"};
+    ColumnType types[] = {COL_INT, COL_INT, COL_INT, COL_FLOAT, COL_DOUBLE};
+    Table *t = (Table *)malloc(sizeof(Table));
+    void *arena = t ? bench_table(t, "series", 5, cols, types, rows) : NULL;
+    size_t cap = arena ? seal_bound_bytes(t, rows) : 0;
+    uint8_t *buf = cap ? (uint8_t *)malloc(cap) : NULL;
+    if (!buf) { free(arena); free(t); printf("compress: allocation failed\n"); return; }
+    uint32_t rng = 0x5E41u; int counter = 0; float temp = 21.0f;
+    for (size_t r = 0; r < rows; ++r) {
+        int id = (int)r, tm = 1700000000 + (int)r + ((r % 3600u) == 0 ? 2 : 0); counter += (int)(xorshift32(&rng) % 4u);
+        if (r % 30u == 0) temp = 21.0f + (float)(xorshift32(&rng) % 40u) * 0.1f;
+        double volt = 3.3 + (double)(xorshift32(&rng) % 8u) * 0.01;
+        const void *vals[] = {&id, &tm, &counter, &temp, &volt}; insert_row(t, vals);
+    }
+    SealedBlock b; double t0 = now_sec();
+    for (int i = 0; i < reps; ++i) seal_where(t, NULL, 0, "time", buf, cap, &b);
+    double seal = now_sec() - t0;
+    size_t raw = 3u * sizeof(int) + sizeof(float) + sizeof(double);
+    float hot = 23.0f; Predicate warm[] = {{"temp", OP_GT, &hot}}; const char *metrics[] = {"volt"}; AggResult out;
+    t0 = now_sec();
+    for (int i = 0; i < reps; ++i) sealed_agg_columns(&b, metrics, 1, warm, 1, &out);
+    double blk = now_sec() - t0;
+    t0 = now_sec();
+    for (int i = 0; i < reps; ++i) agg_columns(t, metrics, 1, warm, 1, &out);
+    double tab = now_sec() - t0;
+    printf("compress: %.2f bytes/sample sealed vs %zu raw | time col %.3f bits/sample | seal %.1f ns/row | filtered agg block %.2f ns/row vs table %.2f ns/row\n",
+           (double)b.bytes / (double)rows, raw, (double)b.cols[1].bytes * 8.0 / (double)rows, seal * 1e9 / ((double)rows * reps),
+           blk * 1e9 / ((double)rows * reps), tab * 1e9 / ((double)rows * reps));
+    free(buf); free(arena); free(t);
+}
+#endif
+
+#ifdef DRIVERSQL_TIMESERIES
+// Sliding 1M-sample retention window: each step expires the oldest 1/16 and appends as much again.
+// Plain mode row-deletes through a full time-column scan; chunked mode drops one chunk.
+static void bench_ts_retention(void) {
+    enum { CHUNKS = 16, CHUNK_ROWS = 65536, STEPS = 32 };
+    const size_t rows = (size_t)CHUNKS * CHUNK_ROWS;
+    const char *cols[] = {"id", "time", "value"};
+    ColumnType types[] = {COL_INT, COL_INT, COL_INT};
+    Table *t = (Table *)malloc(sizeof(Table));
+    DodaTSChunk *chunks = (DodaTSChunk *)malloc(CHUNKS * sizeof(DodaTSChunk));
+    size_t need = doda_tsdb_chunked_arena_bytes(CHUNKS, CHUNK_ROWS, 3, types);
+    void *arena = t ? bench_table(t, "plain", 3, cols, types, rows) : NULL, *ring = need ? malloc(need) : NULL;
+    if (!arena || !chunks || !ring) { free(arena); free(ring); free(chunks); free(t); printf("ts_retention: allocation failed\n"); return; }
+    DodaTSDB plain, ring_ts; doda_tsdb_init(&plain, t, "time");
+    doda_tsdb_init_chunked(&ring_ts, chunks, CHUNKS, CHUNK_ROWS, 3, cols, types, "time", ring, need);
+    DodaTSDB *modes[2] = {&plain, &ring_ts}; double cost[2] = {0.0, 0.0}; size_t dropped[2] = {0, 0};
+    for (int m = 0; m < 2; ++m) {
+        int tm = 0;
+        for (size_t r = 0; r < rows; ++r, ++tm) doda_tsdb_append_int3(modes[m], tm, tm, tm & 1023);
+        for (int s = 0; s < STEPS; ++s) {
+            size_t del = 0; double t0 = now_sec();
+            doda_tsdb_delete_older_than(modes[m], tm - (int)rows + CHUNK_ROWS, &del);
+            cost[m] += now_sec() - t0; dropped[m] += del;
+            for (int r = 0; r < CHUNK_ROWS; ++r, ++tm) doda_tsdb_append_int3(modes[m], tm, tm, tm & 1023);
+        }
+    }
+    printf("ts_retention: %d steps x %d rows | plain delete %.1f us/step (%.2f ns/row) | chunked drop %.3f us/step (%zu rows)\n",
+           STEPS, CHUNK_ROWS, cost[0] * 1e6 / STEPS, cost[0] * 1e9 / (double)(dropped[0] ? dropped[0] : 1u), cost[1] * 1e6 / STEPS, dropped[1]);
+    free(ring); free(chunks); free(arena); free(t);
+}
+
+// Producer cost of pushing a sample into the ingestion ring vs appending it directly, and the
+// drain cost per sample (ring of 4096, drained whenever it fills)
+static void bench_ts_ring(void) {
+    const size_t rows = 1000000u, cap = 4096u;
+    const char *cols[] = {"id", "time", "value"};
+    ColumnType types[] = {COL_INT, COL_INT, COL_INT};
+    Table *t = (Table *)malloc(sizeof(Table));
+    DodaTSSample *slots = (DodaTSSample *)malloc(cap * sizeof(DodaTSSample));
+    uint32_t *seqs = (uint32_t *)malloc(cap * sizeof(uint32_t));
+    void *arena = t && slots && seqs ? bench_table(t, "ring", 3, cols, types, rows) : NULL;
+    if (!arena) { free(seqs); free(slots); free(t); printf("ts_ring: allocation failed\n"); return; }
+    DodaTSDB ts; doda_tsdb_init(&ts, t, "time");
+    double t0 = now_sec();
+    for (size_t i = 0; i < rows; ++i) doda_tsdb_append_int3(&ts, (int)i, (int)i, (int)(i & 1023u));
+    double direct = now_sec() - t0;
+    printf("ts_ring: %zu samples | direct append %.1f ns", rows, direct * 1e9 / (double)rows);
+    for (int mode = 0; mode < 2; ++mode) {
+        DodaTSRing r; doda_ts_ring_init(&r, slots, mode ? seqs : NULL, cap);
+        table_clear(t);
+        double push = 0.0, drain = 0.0;
+        for (size_t base = 0; base < rows; base += cap) {
+            size_t n = rows - base < cap ? rows - base : cap;
+            t0 = now_sec();
+            for (size_t i = base; i < base + n; ++i) doda_ts_ring_push(&r, (int)i, (int)i, (int)(i & 1023u));
+            push += now_sec() - t0; t0 = now_sec();
+            doda_ts_ring_drain(&r, &ts, 0);
+            drain += now_sec() - t0;
+        }
+        DodaTSRingStats st; doda_ts_ring_stats(&r, &st);
+        printf(" | %s push %.1f ns, drain %.1f ns (%llu rows)", mode ? "mpsc" : "spsc", push * 1e9 / (double)rows, drain * 1e9 / (double)rows,
+               (unsigned long long)(st.drained - st.rejected));
+    }
+    printf("\n");
+    free(arena); free(seqs); free(slots); free(t);
+}
+#endif
+
+#ifdef DRIVERSQL_THREADS
+static double wall_sec(void) { struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts); return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9; }
+
+// N readers run filtered aggregations while one writer churns rows (delete oldest, insert
+// newest): every call under one global mutex vs the shared table's seqlock readers
+typedef struct {
+    DodaSharedTable *s;
+    pthread_mutex_t *mu;  // NULL: optimistic reads
+    int *done;
+    size_t queries;
+} ContendReader;
+
+static void *contend_reader(void *arg) {
+    ContendReader *r = (ContendReader *)arg;
+    const char *cname = "v"; int t0 = 0; Predicate p = {"time", OP_GTE, &t0};
+    do {
+        AggResult a;
+        t0 = (int)(r->queries % 1000u) * 10;
+        if (r->mu) { pthread_mutex_lock(r->mu); agg_columns(r->s->table, &cname, 1, &p, 1, &a); pthread_mutex_unlock(r->mu); }
+        else doda_shared_agg_columns(r->s, &cname, 1, &p, 1, &a);
+        r->queries++;
+    } while (!__atomic_load_n(r->done, __ATOMIC_ACQUIRE));
+    return NULL;
+}
+
+static void bench_shared_contention(void) {
+    const size_t rows = 65536u, live = 60000u, ops = 200000u;
+    const char *cols[] = {"id", "time", "v"};
+    ColumnType types[] = {COL_INT, COL_INT, COL_INT};
+    const int readers[] = {0, 1, 2, 4};
+    printf("shared_contention: %zu live rows, %zu writer ops; mode | readers | writer ops/s | reader queries/s | retries/query | locked/query\n", live, ops);
+    for (int mode = 0; mode < 2; ++mode) {
+        for (size_t k = 0; k < sizeof(readers) / sizeof(readers[0]); ++k) {
+            int n = readers[k];
+            Table *t = (Table *)malloc(sizeof(Table));
+            void *arena = t ? bench_table(t, "shared", 3, cols, types, rows) : NULL;
+            if (!arena) { free(t); printf("shared_contention: allocation failed\n"); return; }
+            for (size_t i = 0; i < live; ++i) { int id = (int)i, tm = (int)i, v = (int)(i % 97u); const void *vals[] = {&id, &tm, &v}; insert_row(t, vals); }
+            DodaSharedTable s; doda_shared_init(&s, t);
+            pthread_mutex_t mu; pthread_mutex_init(&mu, NULL);
+            ContendReader rd[4]; pthread_t th[4]; int done = 0;
+            for (int i = 0; i < n; ++i) {
+                rd[i].s = &s; rd[i].mu = mode == 0 ? &mu : NULL; rd[i].done = &done; rd[i].queries = 0;
+                pthread_create(&th[i], NULL, contend_reader, &rd[i]);
+            }
+            double w0 = wall_sec();
+            for (size_t i = 0; i < ops; ++i) {
+                int old = (int)i, id = (int)(live + i), tm = id, v = (int)(i % 97u); size_t d;
+                const void *vals[] = {&id, &tm, &v};
+                if (mode == 0) pthread_mutex_lock(&mu); else doda_shared_write_begin(&s);
+                delete_where_eq(t, "id", &old, &d);
+                insert_row(t, vals);
+                if (mode == 0) pthread_mutex_unlock(&mu); else doda_shared_write_end(&s);
+            }
+            double dt = wall_sec() - w0;
+            __atomic_store_n(&done, 1, __ATOMIC_RELEASE);
+            size_t q = 0;
+            for (int i = 0; i < n; ++i) { pthread_join(th[i], NULL); q += rd[i].queries; }
+            printf("  %-7s | %d | %10.0f | %8.0f | %.3f | %.3f\n", mode == 0 ? "mutex" : "seqlock", n, (double)ops / dt, (double)q / dt,
+                   q ? (double)s.read_retries / (double)q : 0.0, q ? (double)s.read_locked / (double)q : 0.0);
+            pthread_mutex_destroy(&mu);
+            free(arena); free(t);
+        }
+    }
+}
+#endif
+
+#ifdef DODA_PERSIST
+// Bit-at-a-time CRC32 as persistence computed it before the table/hardware paths
+static uint32_t crc32_bitwise(uint32_t crc, const uint8_t *p, size_t len) {
+    crc = ~crc;
+    for (size_t i = 0; i < len; ++i) {
+        crc ^= p[i];
+        for (int b = 0; b < 8; ++b) crc = (crc >> 1) ^ (0xEDB88320u & -(crc & 1u));
+    }
+    return ~crc;
+}
+
+// CRC32 throughput over a 1 MiB buffer and over 64-byte pieces (snapshot staging-buffer sizes)
+static void bench_crc32(void) {
+    const size_t bytes = 1u << 20; const int reps = 64;
+    uint8_t *buf = (uint8_t *)malloc(bytes);
+    if (!buf) { printf("crc32: allocation failed\n"); return; }
+    uint32_t rng = 0xC3C3u;
+    for (size_t i = 0; i < bytes; ++i) buf[i] = (uint8_t)xorshift32(&rng);
+    uint32_t ref = 0, crc = 0, pieces = 0;
+    double t0 = now_sec();
+    ref = crc32_bitwise(0u, buf, bytes);
+    double bit = now_sec() - t0;
+    t0 = now_sec();
+    for (int i = 0; i < reps; ++i) crc = doda_persist_crc32(0u, buf, bytes);
+    double big = (now_sec() - t0) / reps;
+    t0 = now_sec();
+    for (int i = 0; i < reps; ++i) { pieces = 0; for (size_t o = 0; o < bytes; o += 64u) pieces = doda_persist_crc32(pieces, buf + o, 64u); }
+    double small = (now_sec() - t0) / reps;
+    double mib = (double)bytes / (1024.0 * 1024.0);
+    printf("crc32 (%s): %.0f MiB/s 1 MiB, %.0f MiB/s 64 B pieces | bitwise %.0f MiB/s | %s\n", doda_persist_crc32_impl(),
+           mib / big, mib / small, mib / bit, (crc == ref && pieces == ref) ? "match" : "MISMATCH");
+    free(buf);
+}
+
+// RAM fake flash with simulated program/erase latencies (nothing sleeps; time is accumulated)
+typedef struct {
+    uint8_t *mem;
+    size_t page, erase, blocks;
+    double prog_us, erase_us; // per page program, per block erase
+    double sim_us;
+    uint32_t *wear;           // erases per block
+} BenchFlash;
+
+static bool bf_erase(void *user, uintptr_t addr, size_t size) {
+    BenchFlash *f = (BenchFlash *)user;
+    memset(f->mem + addr, 0xFF, size);
+    for (size_t b = addr / f->erase; b < (addr + size) / f->erase; ++b) { f->wear[b]++; f->sim_us += f->erase_us; }
+    return true;
+}
+static bool bf_program(void *user, uintptr_t addr, const void *data, size_t size) {
+    BenchFlash *f = (BenchFlash *)user;
+    memcpy(f->mem + addr, data, size);
+    f->sim_us += f->prog_us * (double)((size + f->page - 1u) / f->page);
+    return true;
+}
+static bool bf_read(void *user, uintptr_t addr, void *data, size_t size) { memcpy(data, ((BenchFlash *)user)->mem + addr, size); return true; }
+
+// Linear layout of the flash stub: erase the whole region, then program from offset 0
+typedef struct { BenchFlash *f; size_t pos; } BenchLinear;
+static bool bl_write_all(void *ctx, const void *data, size_t size) {
+    BenchLinear *l = (BenchLinear *)ctx;
+    if (l->pos + size > l->f->erase * l->f->blocks) return false;
+    memcpy(l->f->mem + l->pos, data, size);
+    size_t first = l->pos / l->f->page, end = (l->pos + size + l->f->page - 1u) / l->f->page;
+    if (l->pos % l->f->page) first++; // the partially programmed page was already counted
+    l->f->sim_us += l->f->prog_us * (double)(end - first);
+    l->pos += size;
+    return true;
+}
+static bool bl_erase(void *ctx) { BenchLinear *l = (BenchLinear *)ctx; l->pos = 0; return bf_erase(l->f, 0, l->f->erase * l->f->blocks); }
+
+static void bench_flash_run(const char *label, size_t page, size_t erase, size_t blocks, double prog_us, double erase_us) {
+    const int saves = 500;
+    const char *cols[] = {"id", "time", "value"};
+    ColumnType types[] = {COL_INT, COL_INT, COL_INT};
+    Table *t = (Table *)malloc(sizeof(Table));
+    void *arena = t ? bench_table(t, "flash", 3, cols, types, 1000u) : NULL;
+    size_t pages = blocks * erase / page;
+    uint8_t *mem = (uint8_t *)malloc(blocks * erase);
+    uint8_t *work = (uint8_t *)malloc(2u * page);
+    uint32_t *wear = (uint32_t *)calloc(blocks, sizeof(uint32_t));
+    uint32_t *counts = (uint32_t *)calloc(blocks, sizeof(uint32_t));
+    DodaFlashLogPage *map = (DodaFlashLogPage *)calloc(pages, sizeof(DodaFlashLogPage));
+    if (!arena || !mem || !work || !wear || !counts || !map) { printf("flashlog: allocation failed\n"); goto done; }
+    for (int i = 0; i < 1000; ++i) { int tm = i * 10, v = i; const void *vals[] = {&i, &tm, &v}; insert_row(t, vals); }
+
+    BenchFlash f = { mem, page, erase, blocks, prog_us, erase_us, 0.0, wear };
+    memset(mem, 0xFF, blocks * erase);
+    BenchLinear lin = { &f, 0 };
+    DodaStorage ls = DODA_STORAGE_INIT(&lin, bl_write_all, NULL, bl_erase);
+    for (int s = 0; s < saves; ++s) { t->columns[2].data.int_data[s % 1000] = s; doda_persist_save_table(t, &ls); }
+    double lin_ms = f.sim_us / 1000.0 / saves;
+    uint32_t lin_max = 0;
+    for (size_t b = 0; b < blocks; ++b) if (wear[b] > lin_max) lin_max = wear[b];
+    size_t snap = lin.pos;
+
+    memset(mem, 0xFF, blocks * erase);
+    memset(wear, 0, blocks * sizeof(uint32_t));
+    f.sim_us = 0.0;
+    DodaFlashLogConfig cfg = { &f, 0, page, erase, blocks, 0, bf_erase, bf_program, bf_read, map, counts, work };
+    DodaFlashLog log;
+    DodaStorage st;
+    if (doda_flash_log_mount(&log, &cfg) != DODA_PERSIST_OK) { printf("flashlog: mount failed\n"); goto done; }
+    doda_flash_log_storage(&log, 0, &st);
+    double wall = now_sec();
+    int ok = 0;
+    for (int s = 0; s < saves; ++s) { t->columns[2].data.int_data[s % 1000] = s; ok += doda_persist_save_table(t, &st) == DODA_PERSIST_OK; }
+    wall = now_sec() - wall;
+    DodaFlashLogStats fs;
+    doda_flash_log_stats(&log, &fs);
+    double log_ms = f.sim_us / 1000.0 / saves;
+    printf("flashlog %s (%zu B pages, %zu KiB x%zu blocks): snapshot %zu B | linear %.1f ms/save, %.2f erases/save, max wear %u"
+           " | log %.1f ms/save, %.2f erases/save, wear %u..%u, %.2f relocated pages/save | %d/%d saved, %.1f us host/save\n",
+           label, page, erase / 1024u, blocks, snap, lin_ms, (double)blocks, lin_max,
+           log_ms, (double)fs.erases / saves, fs.erase_min, fs.erase_max, (double)fs.pages_relocated / saves, ok, saves, wall * 1e6 / saves);
+done:
+    free(map); free(counts); free(wear); free(work); free(mem); free(arena); free(t);
+}
+
+// Snapshot saves on simulated flash: flash-stub layout (full-region erase per save) vs the
+// wear-leveled log store. Latencies are typical datasheet figures.
+static void bench_flash_log(void) {
+    bench_flash_run("nor", 256u, 4096u, 16u, 700.0, 45000.0);
+    bench_flash_run("nand", 2048u, 131072u, 8u, 300.0, 2000.0);
+}
+#endif
+
+typedef struct { const char *name; void (*fn)(void); } BenchCase;
+
+static const BenchCase g_benches[] = {
+    { "pk_hash_churn", bench_pk_hash_churn },
+    { "index_build", bench_index_build },
+#if !defined(DRIVERSQL_NO_FLOAT) && !defined(DRIVERSQL_NO_DOUBLE)
+    { "threshold_scan", bench_threshold_scan },
+#endif
+#ifndef DRIVERSQL_NO_DOUBLE
+    { "zone_scan", bench_zone_scan },
+#endif
+    { "select_batch", bench_select_batch },
+    { "conjunctive", bench_conjunctive },
+#if !defined(DRIVERSQL_NO_FLOAT) && !defined(DRIVERSQL_NO_DOUBLE)
+    { "aggregate", bench_aggregate },
+#endif
+    { "bulk_insert", bench_bulk_insert },
+#if !defined(DRIVERSQL_NO_FLOAT) && !defined(DRIVERSQL_NO_DOUBLE)
+    { "compress", bench_compress },
+#endif
+#ifdef DRIVERSQL_TIMESERIES
+    { "ts_retention", bench_ts_retention },
+    { "ts_ring", bench_ts_ring },
+#endif
+#ifdef DRIVERSQL_THREADS
+    { "shared_contention", bench_shared_contention },
+#endif
+#ifdef DODA_PERSIST
+    { "crc32", bench_crc32 },
+    { "flashlog", bench_flash_log },
+#endif
+};
+
+int main(int argc, char **argv) {
+    const char *filter = argc > 1 ? argv[1] : NULL;
+    for (size_t i = 0; i < sizeof(g_benches) / sizeof(g_benches[0]); ++i) {
+        if (filter && !strstr(g_benches[i].name, filter)) continue;
+        g_benches[i].fn();
+    }
+    return 0;
+}
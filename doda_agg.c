@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2025 Rohit Ballurgi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software... [rest of standard MIT short-text]
+ * ...
+ * MIT License (see LICENSE file for full text)
+ */
+
+#include "doda_agg.h"
+#include "doda_scan.h"
+
+#include <string.h>
+
+// Running state (AggAcc): Welford mean/M2 merged block-wise (Chan et al.), exact int64 sum for INT
+static void acc_merge(AggAcc *a, size_t nb, double sumb, double minb, double maxb, double m2b) {
+    double meanb = sumb / (double)nb;
+    if (a->n == 0) { a->n = nb; a->mean = meanb; a->m2 = m2b; a->min = minb; a->max = maxb; a->sum = sumb; return; }
+    size_t n = a->n + nb; double delta = meanb - a->mean;
+    a->mean += delta * (double)nb / (double)n;
+    a->m2 += m2b + delta * delta * (double)a->n * (double)nb / (double)n;
+    a->sum += sumb; a->n = n;
+    if (minb < a->min) a->min = minb;
+    if (maxb > a->max) a->max = maxb;
+}
+
+void agg_acc_finish(const AggAcc *a, ColumnType ct, AggResult *out) {
+    bool is_int = ct == COL_INT;
+    memset(out, 0, sizeof(*out));
+    if (a->n == 0) return;
+    out->count = a->n; out->min = a->min; out->max = a->max;
+    out->sum = is_int ? (double)a->isum : a->sum;
+    out->mean = is_int ? (double)a->isum / (double)a->n : a->mean;
+    out->variance = a->m2 / (double)a->n;
+}
+
+// Stats of the selected cells of one 64-row block. Partial words are first packed into a
+// local buffer, so every block runs the same dense loops. Those keep AGG_LANES independent
+// accumulators: floating-point sums cannot be reordered by the compiler on its own, while
+// fixed lanes vectorize under strict IEEE rules. M2 is taken around the block mean while the
+// cells are still in L1.
+#define AGG_LANES 4u
+#define DEFINE_AGG_BLOCK(name, T, SUM_T, IS_INT) \
+static void name(const T *v, uint64_t m, AggAcc *acc) { \
+    T packed[DODA_SCAN_WORD], first = v[scan_ctz64(m)]; const T *x = v; size_t nb = DODA_SCAN_WORD, i, k; \
+    if (m != ~0ULL) { nb = 0; for (; m; m &= m - 1u) packed[nb++] = v[scan_ctz64(m)]; x = packed; } \
+    SUM_T s[AGG_LANES]; T lo[AGG_LANES], hi[AGG_LANES]; double q[AGG_LANES]; \
+    for (k = 0; k < AGG_LANES; ++k) { s[k] = 0; lo[k] = hi[k] = first; q[k] = 0.0; } \
+    for (i = 0; i + AGG_LANES <= nb; i += AGG_LANES) \
+        for (k = 0; k < AGG_LANES; ++k) { T y = x[i + k]; s[k] += (SUM_T)y; lo[k] = y < lo[k] ? y : lo[k]; hi[k] = y > hi[k] ? y : hi[k]; } \
+    for (; i < nb; ++i) { T y = x[i]; s[0] += (SUM_T)y; lo[0] = y < lo[0] ? y : lo[0]; hi[0] = y > hi[0] ? y : hi[0]; } \
+    for (k = 1; k < AGG_LANES; ++k) { s[0] += s[k]; lo[0] = lo[k] < lo[0] ? lo[k] : lo[0]; hi[0] = hi[k] > hi[0] ? hi[k] : hi[0]; } \
+    double mean = (double)s[0] / (double)nb; \
+    for (i = 0; i + AGG_LANES <= nb; i += AGG_LANES) \
+        for (k = 0; k < AGG_LANES; ++k) { double d = (double)x[i + k] - mean; q[k] += d * d; } \
+    for (; i < nb; ++i) { double d = (double)x[i] - mean; q[0] += d * d; } \
+    if (IS_INT) acc->isum += (int64_t)s[0]; \
+    for (k = 1; k < AGG_LANES; ++k) q[0] += q[k]; \
+    acc_merge(acc, nb, (double)s[0], (double)lo[0], (double)hi[0], q[0]); \
+}
+
+DEFINE_AGG_BLOCK(agg_block_int, int, int64_t, true)
+#ifndef DRIVERSQL_NO_FLOAT
+DEFINE_AGG_BLOCK(agg_block_float, float, double, false)
+#endif
+#ifndef DRIVERSQL_NO_DOUBLE
+DEFINE_AGG_BLOCK(agg_block_double, double, double, false)
+#endif
+
+void agg_acc_word(AggAcc *acc, const Column *c, size_t base, uint64_t m) {
+    if (!m) return;
+    switch (c->type) {
+        case COL_INT: agg_block_int(c->data.int_data + base, m, acc); break;
+#ifndef DRIVERSQL_NO_FLOAT
+        case COL_FLOAT: agg_block_float(c->data.float_data + base, m, acc); break;
+#endif
+#ifndef DRIVERSQL_NO_DOUBLE
+        case COL_DOUBLE: agg_block_double(c->data.double_data + base, m, acc); break;
+#endif
+        default: break;
+    }
+}
+
+static DSStatus resolve_filters(const Table *t, const Predicate *filters, size_t nfilters, int *cols) {
+    if (nfilters > MAX_PREDICATES || (nfilters && !filters)) return DS_ERR_INVALID;
+    for (size_t i = 0; i < nfilters; ++i) {
+        if (!filters[i].col_name || !filters[i].value) return DS_ERR_INVALID;
+        if ((cols[i] = column_index(t, filters[i].col_name)) < 0) return DS_ERR_NOT_FOUND;
+    }
+    return DS_OK;
+}
+
+// Live rows of the word at `base` that pass every filter (count is read once, so a shared
+// table's torn pass never reads past the column)
+static uint64_t selected_word(const Table *t, const Predicate *filters, size_t nfilters, const int *fcols, size_t base) {
+    size_t count = t->count; if (base >= count) return 0;
+    uint64_t m = ~t->deleted_bits[base / 64u] & scan_tail_mask(base, count);
+    size_t len = count - base < DODA_SCAN_WORD ? count - base : DODA_SCAN_WORD;
+    for (size_t i = 0; i < nfilters && m; ++i) m &= scan_column_word(&t->columns[fcols[i]], base, len, filters[i].op, filters[i].value);
+    return m;
+}
+
+DSStatus agg_columns(const Table *t, const char **col_names, size_t ncols, const Predicate *filters, size_t nfilters, AggResult *out) {
+    if (!t || !col_names || !out || ncols == 0 || ncols > MAX_COLUMNS) return DS_ERR_INVALID;
+    int cols[MAX_COLUMNS], fcols[MAX_PREDICATES]; AggAcc acc[MAX_COLUMNS];
+    for (size_t i = 0; i < ncols; ++i) {
+        if (!col_names[i]) return DS_ERR_INVALID;
+        if ((cols[i] = column_index(t, col_names[i])) < 0) return DS_ERR_NOT_FOUND;
+        if (!scan_type_supported(t->columns[cols[i]].type)) return DS_ERR_UNSUPPORTED;
+    }
+    DSStatus st = resolve_filters(t, filters, nfilters, fcols); if (st != DS_OK) return st;
+    memset(acc, 0, ncols * sizeof(acc[0]));
+    for (size_t base = 0; base < t->count; base += DODA_SCAN_WORD) {
+        uint64_t m = selected_word(t, filters, nfilters, fcols, base);
+        if (!m) continue;
+        for (size_t i = 0; i < ncols; ++i) agg_acc_word(&acc[i], &t->columns[cols[i]], base, m);
+    }
+    for (size_t i = 0; i < ncols; ++i) agg_acc_finish(&acc[i], t->columns[cols[i]].type, &out[i]);
+    return DS_OK;
+}
+
+// Group-by: groups stay sorted by key, found by binary search (new keys shift the tail once)
+static int group_cmp(const Column *g, const AggGroup *grp, size_t r) {
+#ifndef DRIVERSQL_NO_TEXT
+    if (g->type == COL_TEXT) return strncmp(g->data.text_data[grp->key_row], g->data.text_data[r], MAX_TEXT_LEN);
+#endif
+    int k = g->type == COL_BOOL ? (int)g->data.bool_data[r] : g->data.int_data[r];
+    return (grp->key > k) - (grp->key < k);
+}
+
+static double cell_value(const Column *c, size_t r) {
+    switch (c->type) {
+#ifndef DRIVERSQL_NO_FLOAT
+        case COL_FLOAT: return (double)c->data.float_data[r];
+#endif
+#ifndef DRIVERSQL_NO_DOUBLE
+        case COL_DOUBLE: return c->data.double_data[r];
+#endif
+        default: return (double)c->data.int_data[r];
+    }
+}
+
+DSStatus agg_group_by(const Table *t, const char *group_col, const char *value_col, const Predicate *filters, size_t nfilters, AggGroup *groups, size_t max_groups, size_t *ngroups_out) {
+    if (!t || !group_col || !groups || !ngroups_out) return DS_ERR_INVALID;
+    *ngroups_out = 0;
+    int gc = column_index(t, group_col), vc = -1, fcols[MAX_PREDICATES];
+    if (gc < 0) return DS_ERR_NOT_FOUND;
+    const Column *g = &t->columns[gc];
+    bool key_ok = g->type == COL_INT || g->type == COL_BOOL;
+#ifndef DRIVERSQL_NO_TEXT
+    key_ok = key_ok || g->type == COL_TEXT;
+#endif
+    if (!key_ok) return DS_ERR_UNSUPPORTED;
+    if (value_col) {
+        if ((vc = column_index(t, value_col)) < 0) return DS_ERR_NOT_FOUND;
+        if (!scan_type_supported(t->columns[vc].type)) return DS_ERR_UNSUPPORTED;
+    }
+    DSStatus st = resolve_filters(t, filters, nfilters, fcols); if (st != DS_OK) return st;
+
+    size_t ng = 0, last = 0; bool full = false;
+    for (size_t base = 0; base < t->count; base += DODA_SCAN_WORD) {
+        for (uint64_t m = selected_word(t, filters, nfilters, fcols, base); m; m &= m - 1u) {
+            size_t r = base + scan_ctz64(m), pos;
+            if (ng && group_cmp(g, &groups[last], r) == 0) pos = last;
+            else {
+                size_t lo = 0, hi = ng;
+                while (lo < hi) { size_t mid = (lo + hi) >> 1; if (group_cmp(g, &groups[mid], r) < 0) lo = mid + 1; else hi = mid; }
+                pos = lo;
+                if (pos == ng || group_cmp(g, &groups[pos], r) != 0) {
+                    if (ng == max_groups) { full = true; continue; } // only new keys are dropped
+                    memmove(&groups[pos + 1], &groups[pos], (ng - pos) * sizeof(groups[0]));
+                    memset(&groups[pos], 0, sizeof(groups[0])); ng++;
+                    groups[pos].key_row = (uint32_t)r;
+                    groups[pos].key = g->type == COL_BOOL ? (int)g->data.bool_data[r] : g->type == COL_INT ? g->data.int_data[r] : 0;
+                }
+            }
+            last = pos;
+            // Welford update; stats.variance holds M2 until the end
+            AggResult *s = &groups[pos].stats; s->count++;
+            if (vc < 0) continue;
+            double x = cell_value(&t->columns[vc], r), d = x - s->mean;
+            if (s->count == 1) { s->min = s->max = x; }
+            else { if (x < s->min) s->min = x; if (x > s->max) s->max = x; }
+            s->sum += x; s->mean += d / (double)s->count; s->variance += d * (x - s->mean);
+        }
+    }
+    for (size_t i = 0; i < ng; ++i) groups[i].stats.variance /= (double)groups[i].stats.count;
+    *ngroups_out = ng;
+    return full ? DS_ERR_FULL : DS_OK;
+}
+
+static bool agg_int_column(const Table *t, const char *col_name, AggResult *r) {
+    if (!t || !col_name) return false;
+    int idx = column_index(t, col_name); if (idx < 0 || t->columns[idx].type != COL_INT) return false;
+    return agg_column(t, col_name, NULL, 0, r) == DS_OK && r->count > 0;
+}
+
+bool agg_min_int(const Table *t, const char *col_name, int *out) {
+    AggResult r; if (!out || !agg_int_column(t, col_name, &r)) return false; *out = (int)r.min; return true;
+}
+
+bool agg_max_int(const Table *t, const char *col_name, int *out) {
+    AggResult r; if (!out || !agg_int_column(t, col_name, &r)) return false; *out = (int)r.max; return true;
+}
+
+bool agg_avg_int(const Table *t, const char *col_name, double *out) {
+    AggResult r; if (!out || !agg_int_column(t, col_name, &r)) return false; *out = r.mean; return true;
+}
+
+// Every deleted row sits on the free list, so the live count needs no scan
+size_t agg_count(const Table *t) { return t ? t->count - t->free_top : 0; }
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2025 Rohit Ballurgi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software... [rest of standard MIT short-text]
+ * ...
+ * MIT License (see LICENSE file for full text)
+ */
+
+#pragma once
+#include "doda_engine.h"
+
+// Aggregation engine.
+//
+// One pass over the table computes count/sum/min/max/mean/variance for any number of
+// INT/FLOAT/DOUBLE columns. Rows are visited 64 at a time through the deleted bitmap
+// (ANDed with optional filter predicates); full words run dense, auto-vectorizable loops
+// and partial words walk their set bits. Blocks are merged with the parallel variance
+// formula, so variance stays numerically stable without a second pass.
+
+typedef struct {
+    size_t count;
+    double sum;      // INT columns are summed exactly in 64 bits
+    double min, max;
+    double mean;
+    double variance; // population variance
+} AggResult;
+
+// out[i] receives the stats of col_names[i] over live rows matching every filter
+// (filters may be NULL with nfilters == 0). Empty selections give count == 0 and zeroes.
+DSStatus agg_columns(const Table *t, const char **col_names, size_t ncols, const Predicate *filters, size_t nfilters, AggResult *out);
+static inline DSStatus agg_column(const Table *t, const char *col_name, const Predicate *filters, size_t nfilters, AggResult *out) { return agg_columns(t, &col_name, 1, filters, nfilters, out); }
+
+// GROUP BY an INT/BOOL/TEXT column. Groups come back sorted by key; `key` holds INT/BOOL keys,
+// key_row is a row carrying the group's key (read TEXT keys from it). value_col may be NULL
+// to count only. With more than max_groups keys, the first max_groups keys met in row order
+// still get complete stats over every matching row, rows of other keys are skipped, and the
+// result is DS_ERR_FULL.
+typedef struct { int key; uint32_t key_row; AggResult stats; } AggGroup;
+DSStatus agg_group_by(const Table *t, const char *group_col, const char *value_col, const Predicate *filters, size_t nfilters, AggGroup *groups, size_t max_groups, size_t *ngroups_out);
+
+// Streaming form for cells that do not live in a Table (e.g. decoded sealed blocks): feed the
+// selected cells `m` of the word starting at `base` of c, then finish. Zero-initialize acc.
+typedef struct { size_t n; int64_t isum; double sum, min, max, mean, m2; } AggAcc;
+void agg_acc_word(AggAcc *acc, const Column *c, size_t base, uint64_t m);
+void agg_acc_finish(const AggAcc *acc, ColumnType ct, AggResult *out);
+
+// Single-metric helpers over non-deleted rows of INT columns
+bool agg_min_int(const Table *t, const char *col_name, int *out);
+bool agg_max_int(const Table *t, const char *col_name, int *out);
+bool agg_avg_int(const Table *t, const char *col_name, double *out);
+size_t agg_count(const Table *t);
+
+// DODA API aliases
+typedef AggResult DodaAggResult;
+typedef AggGroup DodaAggGroup;
+static inline DodaStatus doda_agg_columns(const DodaTable *t, const char **col_names, size_t ncols, const DodaPredicate *filters, size_t nfilters, DodaAggResult *out) { return (DodaStatus)agg_columns((const Table*)t, col_names, ncols, (const Predicate*)filters, nfilters, (AggResult*)out); }
+static inline DodaStatus doda_agg_column(const DodaTable *t, const char *col_name, const DodaPredicate *filters, size_t nfilters, DodaAggResult *out) { return (DodaStatus)agg_column((const Table*)t, col_name, (const Predicate*)filters, nfilters, (AggResult*)out); }
+static inline DodaStatus doda_agg_group_by(const DodaTable *t, const char *group_col, const char *value_col, const DodaPredicate *filters, size_t nfilters, DodaAggGroup *groups, size_t max_groups, size_t *ngroups_out) { return (DodaStatus)agg_group_by((const Table*)t, group_col, value_col, (const Predicate*)filters, nfilters, (AggGroup*)groups, max_groups, ngroups_out); }
@@ -9,37 +9,94 @@
 
 #pragma once
 #include "doda_engine.h"
+#include "doda_agg.h"
+#include "doda_compress.h"
 
 #ifdef DRIVERSQL_TIMESERIES
 
 // Timeseries convenience API built on core without changing core logic
 // Assumes a schema with primary key 'id' (int) and a timestamp column 'time' (int)
 
+// Chunked mode: samples live in a ring of fixed-size arena tables, each covering a time span
+// recorded in min_time/max_time. Appends go to the head chunk (the next chunk is cleared and
+// becomes the head when it fills), retention drops whole chunks in O(1) and time range reads
+// skip chunks by their metadata. The pk hash is per chunk, so ids are only unique within one.
 typedef struct {
-    DodaTable *table;
+    DodaTable *table;       // header carved from the chunked arena (doda_table_header_bytes())
+    int min_time, max_time; // bounds of the samples appended to this chunk
+} DodaTSChunk;
+
+typedef struct {
+    DodaTable *table;     // plain mode: the table; chunked mode: the head chunk (NULL while empty)
     const char *time_col; // e.g., "time"
+    DodaTSChunk *chunks;  // NULL in plain mode
+    size_t chunk_count;
+    size_t oldest, live;  // live chunks run from `oldest` around the ring
+    int time_idx;
 } DodaTSDB;
 
 void doda_tsdb_init(DodaTSDB *ts, DodaTable *t, const char *time_col);
 
+// Arena bytes for chunk_count chunks of chunk_rows rows each, table headers included
+size_t doda_tsdb_chunked_arena_bytes(size_t chunk_count, size_t chunk_rows, int column_count, const DodaColumnType *col_types);
+// Set up chunked mode over caller chunk descriptors and one arena. Each chunk's table header
+// lives in the arena without the MAX_ROWS static storage of a DodaTable, so a chunk costs its
+// header plus its rows. time_col must be an INT column.
+DodaStatus doda_tsdb_init_chunked(DodaTSDB *ts, DodaTSChunk *chunks, size_t chunk_count, size_t chunk_rows, int column_count, const char **col_names, const DodaColumnType *col_types, const char *time_col, void *arena, size_t arena_bytes);
+
+// Append one row of any schema (values as for doda_insert_row). In chunked mode DS_ERR_FULL means
+// every chunk holds data: drop old chunks first (delete_older_than / drop_oldest_chunk).
+DodaStatus doda_tsdb_append(DodaTSDB *ts, const void *values[]);
+// Chunked mode: release the oldest chunk in O(1) (its rows are cleared when the ring reuses it)
+DodaStatus doda_tsdb_drop_oldest_chunk(DodaTSDB *ts, size_t *dropped_rows_out);
+
 // Append sample with monotonic time (optional check). Returns DodaStatus.
 DodaStatus doda_tsdb_append_int3(DodaTSDB *ts, int id, int time, int value);
 
-// Range query on time using core select_where_op; user callback handles rows.
+// Range query on time using core select_where_op; user callback handles rows. In chunked mode the
+// callback's table is the chunk holding the row; chunks outside the range are not visited.
 DodaStatus doda_tsdb_select_time_ge(const DodaTSDB *ts, int t0, doda_row_callback cb, void *user);
 DodaStatus doda_tsdb_select_time_gt(const DodaTSDB *ts, int t0, doda_row_callback cb, void *user);
 DodaStatus doda_tsdb_select_time_lt(const DodaTSDB *ts, int t1, doda_row_callback cb, void *user);
+// Half-open window [t0, t1): one BETWEEN {t0, t1 - 1}, O(log n + R) with a time index
+DodaStatus doda_tsdb_select_time_range(const DodaTSDB *ts, int t0, int t1, doda_row_callback cb, void *user);
 
-// Build index on time column for efficient ranges
+// Build index on time column and attach it to the table, so appends/deletes keep it
+// current and the time range selects use it. idx must outlive ts->table's use.
+// Not available in chunked mode (chunks are time partitions already).
 bool doda_tsdb_build_time_index(DodaTSDB *ts, DodaIndex *idx);
 
-// Delete samples older than cutoff time
+// Delete samples older than cutoff time. Chunked mode drops every chunk entirely older than cutoff
+// in O(1) and deletes row by row only in the chunk straddling it.
 DodaStatus doda_tsdb_delete_older_than(DodaTSDB *ts, int cutoff_time, size_t *deleted_out);
 
-// Aggregations over non-deleted rows for numeric columns
-bool agg_min_int(const Table *t, const char *col_name, int *out);
-bool agg_max_int(const Table *t, const char *col_name, int *out);
-bool agg_avg_int(const Table *t, const char *col_name, double *out);
-size_t agg_count(const Table *t);
+// Seal samples older than cutoff into a compressed block in buf (delta-of-delta on the time
+// column; see doda_compress.h), then delete them from the table. Time order is kept when the
+// time index is attached. Nothing is deleted if sealing fails (e.g. DS_ERR_FULL).
+// Plain mode only; in chunked mode seal whole chunks with doda_tsdb_seal_oldest_chunk.
+DodaStatus doda_tsdb_seal_older_than(DodaTSDB *ts, int cutoff_time, uint8_t *buf, size_t cap, DodaSealedBlock *out, size_t *sealed_out);
+// Chunked mode: seal the oldest chunk into a block, then drop it
+DodaStatus doda_tsdb_seal_oldest_chunk(DodaTSDB *ts, uint8_t *buf, size_t cap, DodaSealedBlock *out, size_t *sealed_out);
+
+// Downsampling: samples are folded into fixed time buckets [k*width, (k+1)*width) in time order
+// (via the attached time index, else row order, which must then be non-decreasing in time;
+// in chunked mode across the chunks from oldest to head).
+enum {
+    DODA_ROLLUP_COUNT = 1u << 0,
+    DODA_ROLLUP_MIN   = 1u << 1,
+    DODA_ROLLUP_MAX   = 1u << 2,
+    DODA_ROLLUP_AVG   = 1u << 3,
+    DODA_ROLLUP_FIRST = 1u << 4,
+    DODA_ROLLUP_LAST  = 1u << 5
+};
+
+typedef struct { int bucket; size_t count; double min, max, avg, first, last; } DodaRollupBucket;
+typedef void (*doda_rollup_callback)(const DodaRollupBucket *b, void *user);
+
+// Each finished bucket goes to cb (optional) and, if dest is given, becomes one dest row:
+// column 0 = bucket start (INT), then one INT/FLOAT/DOUBLE column per bit set in agg_set,
+// in the enum order above. value_col must be INT/FLOAT/DOUBLE. _range limits to [t0, t1).
+DodaStatus doda_tsdb_rollup(const DodaTSDB *ts, const char *value_col, int bucket_width, unsigned agg_set, DodaTable *dest, doda_rollup_callback cb, void *user);
+DodaStatus doda_tsdb_rollup_range(const DodaTSDB *ts, const char *value_col, int t0, int t1, int bucket_width, unsigned agg_set, DodaTable *dest, doda_rollup_callback cb, void *user);
 
 #endif // DRIVERSQL_TIMESERIES
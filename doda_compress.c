@@ -0,0 +1,534 @@
+/*
+ * Copyright (c) 2025 Rohit Ballurgi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software... [rest of standard MIT short-text]
+ * ...
+ * MIT License (see LICENSE file for full text)
+ */
+
+#include "doda_compress.h"
+#include "doda_scan.h"
+
+#include <string.h>
+
+// Block layout (little-endian):
+//   u32 rows | u16 column_count | u16 header_bytes
+//   per column: u8 type | u8 codec | u8 name_len | u8 0 | u32 stream_bytes | name + NUL
+//   column streams, back to back, in column order
+#define SEAL_HEAD 8u
+#define SEAL_COL_HEAD 8u
+#define SEAL_TEXT_CHUNK 8u // TEXT cells are decoded 8 at a time to bound stack use
+#if !defined(DRIVERSQL_NO_FLOAT) || !defined(DRIVERSQL_NO_DOUBLE)
+#define SEAL_HAS_XOR 1
+#endif
+
+static void wr_u32(uint8_t *p, uint32_t v) { p[0]=(uint8_t)v; p[1]=(uint8_t)(v>>8); p[2]=(uint8_t)(v>>16); p[3]=(uint8_t)(v>>24); }
+static void wr_u16(uint8_t *p, uint16_t v) { p[0]=(uint8_t)v; p[1]=(uint8_t)(v>>8); }
+static uint32_t rd_u32(const uint8_t *p) { return (uint32_t)p[0] | ((uint32_t)p[1]<<8) | ((uint32_t)p[2]<<16) | ((uint32_t)p[3]<<24); }
+static uint16_t rd_u16(const uint8_t *p) { return (uint16_t)((uint16_t)p[0] | ((uint16_t)p[1]<<8)); }
+
+static uint64_t zigzag(int64_t x) { return x < 0 ? ~((uint64_t)x << 1) : (uint64_t)x << 1; }
+static int64_t unzigzag(uint64_t z) { return (z & 1u) ? -(int64_t)(z >> 1) - 1 : (int64_t)(z >> 1); }
+
+static unsigned clz64(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_clzll(x);
+#else
+    unsigned n = 0; while (!(x & (1ULL << 63))) { x <<= 1; n++; } return n;
+#endif
+}
+
+// MSB-first bit stream
+typedef struct { uint8_t *p; size_t cap, bits; bool full; } BitWriter;
+// Reader keeps a left-aligned 64-bit buffer; `bits` counts consumed bits for bounds checks
+typedef struct { const uint8_t *p; size_t nbytes, pos, nbits, bits; uint64_t buf; unsigned avail; bool bad; } BitReader;
+
+static void bw_put(BitWriter *w, uint64_t v, unsigned n) {
+    size_t byte = w->bits >> 3; unsigned used = (unsigned)(w->bits & 7u);
+    // Fast path: merge into the partial byte and store 8 bytes at once (bytes past the cursor are scratch)
+    if (n <= 56u && byte + 8u <= w->cap) {
+        uint64_t x = ((uint64_t)(w->p[byte] & (0xFF00u >> used)) << 56) | ((v & ((1ULL << n) - 1u)) << (64u - used - n));
+        for (unsigned i = 0; i < 8u; ++i) w->p[byte + i] = (uint8_t)(x >> (56u - 8u * i));
+        w->bits += n; return;
+    }
+    while (n) {
+        unsigned take = 8u - used;
+        if (take > n) take = n;
+        if (byte >= w->cap) { w->full = true; return; }
+        if (!used) w->p[byte] = 0;
+        w->p[byte] |= (uint8_t)(((v >> (n - take)) & ((1u << take) - 1u)) << (8u - used - take));
+        w->bits += take; n -= take; byte = w->bits >> 3; used = (unsigned)(w->bits & 7u);
+    }
+}
+
+static void br_init(BitReader *r, const uint8_t *p, size_t nbytes) { memset(r, 0, sizeof(*r)); r->p = p; r->nbytes = nbytes; r->nbits = nbytes * 8u; }
+
+// Top up to at least 57 buffered bits (zero padding past the end). The 8-byte path may also
+// buffer bits beyond `avail`; they are the stream's next bits, so OR-ing them in again is harmless.
+static void br_refill(BitReader *r) {
+    if (r->pos + 8u <= r->nbytes) {
+        const uint8_t *p = r->p + r->pos;
+        uint64_t w = ((uint64_t)p[0] << 56) | ((uint64_t)p[1] << 48) | ((uint64_t)p[2] << 40) | ((uint64_t)p[3] << 32) | ((uint64_t)p[4] << 24) | ((uint64_t)p[5] << 16) | ((uint64_t)p[6] << 8) | (uint64_t)p[7];
+        r->buf |= w >> r->avail; r->pos += (63u - r->avail) >> 3; r->avail |= 56u;
+        return;
+    }
+    while (r->avail <= 56u && r->pos < r->nbytes) { r->buf |= (uint64_t)r->p[r->pos++] << (56u - r->avail); r->avail += 8u; }
+}
+
+// Next bits, left-aligned (at least 57 valid); consume them with br_skip (n <= 56)
+static uint64_t br_peek(BitReader *r) { if (r->avail < 57u) br_refill(r); return r->buf; }
+static void br_skip(BitReader *r, unsigned n) {
+    if (r->bits + n > r->nbits) { r->bad = true; r->bits = r->nbits; r->buf = 0; r->avail = 0; return; }
+    r->buf <<= n; r->avail = r->avail > n ? r->avail - n : 0u; r->bits += n;
+}
+
+static uint64_t br_get(BitReader *r, unsigned n) {
+    if (n == 0) return 0;
+    if (n > 56u) { uint64_t hi = br_get(r, n - 32u); return (hi << 32) | br_get(r, 32u); }
+    uint64_t v = br_peek(r) >> (64u - n);
+    br_skip(r, n);
+    return r->bad ? 0 : v;
+}
+
+static bool sealable(ColumnType ct) {
+    switch (ct) {
+        case COL_INT: case COL_BOOL: return true;
+#ifndef DRIVERSQL_NO_TEXT
+        case COL_TEXT: return true;
+#endif
+#ifndef DRIVERSQL_NO_FLOAT
+        case COL_FLOAT: return true;
+#endif
+#ifndef DRIVERSQL_NO_DOUBLE
+        case COL_DOUBLE: return true;
+#endif
+        default: return false;
+    }
+}
+
+static uint8_t codec_for(ColumnType ct, bool is_time) {
+    switch (ct) {
+        case COL_INT: return is_time ? SEAL_DOD : SEAL_VARINT;
+        case COL_BOOL: return SEAL_BITS;
+#ifndef DRIVERSQL_NO_TEXT
+        case COL_TEXT: return SEAL_TEXT;
+#endif
+        default: return SEAL_XOR;
+    }
+}
+
+static unsigned xor_width(ColumnType ct) {
+#ifndef DRIVERSQL_NO_FLOAT
+    if (ct == COL_FLOAT) return 32u;
+#endif
+    (void)ct; return 64u;
+}
+
+// Per-value worst cases: DoD 4 + 36 bits, varint 5 bytes, XOR 2 + 5 + len bits + W bits
+static size_t stream_bound(ColumnType ct, size_t n) {
+    if (n == 0) return 0;
+    switch (ct) {
+        case COL_INT: { size_t dod = (32u + (n - 1u) * 40u + 7u) / 8u, var = n * 5u; return dod > var ? dod : var; }
+        case COL_BOOL: return (n + 7u) / 8u;
+#ifndef DRIVERSQL_NO_TEXT
+        case COL_TEXT: return n * (size_t)MAX_TEXT_LEN;
+#endif
+        default: { size_t w = xor_width(ct); return (w + (n - 1u) * (2u + 5u + (w == 64u ? 6u : 5u) + w) + 7u) / 8u; }
+    }
+}
+
+static size_t name_len(const char *name) { size_t n = 0; while (n < MAX_NAME_LEN - 1u && name[n]) n++; return n; }
+
+size_t seal_bound_bytes(const Table *t, size_t nrows) {
+    if (!t) return 0;
+    size_t n = SEAL_HEAD;
+    for (int c = 0; c < t->column_count; ++c) n += SEAL_COL_HEAD + name_len(t->columns[c].name) + 1u + stream_bound(t->columns[c].type, nrows);
+    return n;
+}
+
+// Row source for sealing: the selection is re-run once per column stream, 64 rows at a time
+typedef struct { const Table *t; const Predicate *preds; size_t npreds; SelectCursor cur; size_t base; } SealRows;
+
+static void seal_rows_begin(SealRows *it) { select_cursor_init(&it->cur); it->base = 0; }
+
+static DSStatus seal_rows_next(SealRows *it, uint32_t *ids, size_t *n) {
+    *n = 0;
+    if (it->npreds) return select_into_all(it->t, it->preds, it->npreds, ids, DODA_SCAN_WORD, &it->cur, n);
+    for (; it->base < it->t->count && *n == 0; it->base += DODA_SCAN_WORD)
+        for (uint64_t m = ~it->t->deleted_bits[it->base / 64u] & scan_tail_mask(it->base, it->t->count); m; m &= m - 1u) ids[(*n)++] = (uint32_t)(it->base + scan_ctz64(m));
+    return DS_OK;
+}
+
+// Encoder state for one column stream; varint and TEXT streams are byte aligned, so they share the
+// bit writer's buffer and position
+typedef struct { BitWriter w; uint32_t n; int64_t prev, delta; uint64_t prev_bits; unsigned lead, trail; } SealEnc;
+
+static void enc_varint(BitWriter *w, uint64_t z) {
+    do { uint8_t b = (uint8_t)(z & 0x7Fu); z >>= 7; bw_put(w, (uint64_t)(b | (z ? 0x80u : 0u)), 8u); } while (z);
+}
+
+static void enc_dod(SealEnc *e, int v) {
+    if (e->n == 0) { bw_put(&e->w, (uint32_t)v, 32u); e->prev = v; return; }
+    int64_t delta = (int64_t)v - e->prev; uint64_t z = zigzag(delta - e->delta);
+    e->prev = v; e->delta = delta;
+    if (z == 0) bw_put(&e->w, 0u, 1u);
+    else if (z < (1u << 7)) { bw_put(&e->w, 2u, 2u); bw_put(&e->w, z, 7u); }
+    else if (z < (1u << 9)) { bw_put(&e->w, 6u, 3u); bw_put(&e->w, z, 9u); }
+    else if (z < (1u << 12)) { bw_put(&e->w, 14u, 4u); bw_put(&e->w, z, 12u); }
+    else { bw_put(&e->w, 15u, 4u); bw_put(&e->w, z, 36u); }
+}
+
+#ifdef SEAL_HAS_XOR
+// Gorilla: '0' = same value; '10' = XOR fits the previous leading/trailing-zero window;
+// '11' + 5-bit leading zeros + length - 1 + meaningful bits = new window
+static void enc_xor(SealEnc *e, uint64_t bits, unsigned width) {
+    if (e->n == 0) { bw_put(&e->w, bits, width); e->prev_bits = bits; e->lead = 0xFFu; return; }
+    uint64_t x = bits ^ e->prev_bits; e->prev_bits = bits;
+    if (!x) { bw_put(&e->w, 0u, 1u); return; }
+    unsigned lead = clz64(x) - (64u - width), trail = scan_ctz64(x);
+    if (lead > 31u) lead = 31u;
+    if (e->lead != 0xFFu && lead >= e->lead && trail >= e->trail) { bw_put(&e->w, 2u, 2u); bw_put(&e->w, x >> e->trail, width - e->lead - e->trail); return; }
+    unsigned len = width - lead - trail;
+    bw_put(&e->w, 3u, 2u); bw_put(&e->w, lead, 5u); bw_put(&e->w, len - 1u, width == 64u ? 6u : 5u); bw_put(&e->w, x >> trail, len);
+    e->lead = lead; e->trail = trail;
+}
+
+#endif
+
+static void enc_xor_cell(SealEnc *e, const Column *c, size_t r) {
+#ifndef DRIVERSQL_NO_FLOAT
+    if (c->type == COL_FLOAT) { uint32_t u; memcpy(&u, &c->data.float_data[r], sizeof(u)); enc_xor(e, u, 32u); return; }
+#endif
+#ifndef DRIVERSQL_NO_DOUBLE
+    if (c->type == COL_DOUBLE) { uint64_t u; memcpy(&u, &c->data.double_data[r], sizeof(u)); enc_xor(e, u, 64u); }
+#endif
+    (void)e; (void)c; (void)r;
+}
+
+static void enc_cell(SealEnc *e, const Column *c, uint8_t codec, size_t r) {
+    switch (codec) {
+        case SEAL_DOD: enc_dod(e, c->data.int_data[r]); break;
+        case SEAL_VARINT: { int v = c->data.int_data[r]; enc_varint(&e->w, zigzag((int64_t)v - e->prev)); e->prev = v; break; }
+        case SEAL_BITS: bw_put(&e->w, c->data.bool_data[r] != 0, 1u); break;
+#ifndef DRIVERSQL_NO_TEXT
+        case SEAL_TEXT: { const char *s = c->data.text_data[r]; size_t i = 0; for (; i < MAX_TEXT_LEN - 1u && s[i]; ++i) bw_put(&e->w, (uint8_t)s[i], 8u); bw_put(&e->w, 0u, 8u); break; }
+#endif
+        default: enc_xor_cell(e, c, r); break;
+    }
+    e->n++;
+}
+
+DSStatus seal_where(const Table *t, const Predicate *preds, size_t npreds, const char *time_col, uint8_t *buf, size_t cap, SealedBlock *out) {
+    if (!t || !buf || !out || (npreds && !preds)) return DS_ERR_INVALID;
+    int tc = -1;
+    if (time_col) { if ((tc = column_index(t, time_col)) < 0) return DS_ERR_NOT_FOUND; if (t->columns[tc].type != COL_INT) return DS_ERR_UNSUPPORTED; }
+    size_t head = SEAL_HEAD;
+    for (int c = 0; c < t->column_count; ++c) {
+        if (!sealable(t->columns[c].type)) return DS_ERR_UNSUPPORTED;
+        head += SEAL_COL_HEAD + name_len(t->columns[c].name) + 1u;
+    }
+    if (head > cap || head > 0xFFFFu) return DS_ERR_FULL;
+
+    SealRows it = { t, preds, npreds, {0}, 0 }; uint32_t ids[DODA_SCAN_WORD];
+    size_t pos = head, desc = SEAL_HEAD; uint32_t rows = 0;
+    for (int c = 0; c < t->column_count; ++c) {
+        const Column *col = &t->columns[c]; uint8_t codec = codec_for(col->type, c == tc);
+        SealEnc e; memset(&e, 0, sizeof(e)); e.w.p = buf + pos; e.w.cap = cap - pos;
+        seal_rows_begin(&it);
+        for (;;) {
+            size_t n; DSStatus st = seal_rows_next(&it, ids, &n); if (st != DS_OK) return st;
+            if (n == 0) break;
+            for (size_t i = 0; i < n; ++i) enc_cell(&e, col, codec, ids[i]);
+            if (e.w.full) return DS_ERR_FULL;
+        }
+        if (c == 0) rows = e.n;
+        size_t len = name_len(col->name), bytes = (e.w.bits + 7u) / 8u;
+        buf[desc] = (uint8_t)col->type; buf[desc + 1] = codec; buf[desc + 2] = (uint8_t)len; buf[desc + 3] = 0;
+        wr_u32(&buf[desc + 4], (uint32_t)bytes);
+        memcpy(&buf[desc + SEAL_COL_HEAD], col->name, len); buf[desc + SEAL_COL_HEAD + len] = 0;
+        desc += SEAL_COL_HEAD + len + 1u; pos += bytes;
+    }
+    wr_u32(&buf[0], rows); wr_u16(&buf[4], (uint16_t)t->column_count); wr_u16(&buf[6], (uint16_t)head);
+    return sealed_open(out, buf, pos);
+}
+
+DSStatus sealed_open(SealedBlock *b, const uint8_t *data, size_t bytes) {
+    if (!b || !data || bytes < SEAL_HEAD) return DS_ERR_INVALID;
+    memset(b, 0, sizeof(*b));
+    uint16_t ncols = rd_u16(&data[4]), head = rd_u16(&data[6]);
+    if (ncols == 0 || ncols > MAX_COLUMNS || head > bytes) return DS_ERR_INVALID;
+    size_t desc = SEAL_HEAD, pos = head;
+    for (uint16_t c = 0; c < ncols; ++c) {
+        if (desc + SEAL_COL_HEAD > head) return DS_ERR_INVALID;
+        ColumnType ct = (ColumnType)data[desc]; uint8_t codec = data[desc + 1], len = data[desc + 2]; uint32_t sb = rd_u32(&data[desc + 4]);
+        if (!sealable(ct)) return DS_ERR_UNSUPPORTED;
+        if (codec != codec_for(ct, codec == SEAL_DOD) || len >= MAX_NAME_LEN || desc + SEAL_COL_HEAD + len + 1u > head || data[desc + SEAL_COL_HEAD + len] != 0) return DS_ERR_INVALID;
+        if (sb > bytes - pos) return DS_ERR_INVALID;
+        b->cols[c].name = (const char *)&data[desc + SEAL_COL_HEAD]; b->cols[c].type = ct; b->cols[c].codec = codec;
+        b->cols[c].offset = (uint32_t)pos; b->cols[c].bytes = sb;
+        desc += SEAL_COL_HEAD + len + 1u; pos += sb;
+    }
+    b->data = data; b->bytes = pos; b->rows = rd_u32(&data[0]); b->column_count = ncols;
+    return DS_OK;
+}
+
+int sealed_column_index(const SealedBlock *b, const char *col_name) {
+    if (!b || !col_name) return -1;
+    for (int c = 0; c < b->column_count; ++c) if (strncmp(b->cols[c].name, col_name, MAX_NAME_LEN) == 0) return c;
+    return -1;
+}
+
+// Streaming decoder for one column; byte-aligned codecs read through the bit reader as well
+typedef struct { BitReader br; ColumnType type; uint8_t codec; uint32_t left, n; int64_t prev, delta; uint64_t prev_bits; unsigned lead, trail; } SealReader;
+
+static void reader_init(SealReader *r, const SealedBlock *b, int col) {
+    memset(r, 0, sizeof(*r));
+    br_init(&r->br, b->data + b->cols[col].offset, b->cols[col].bytes);
+    r->type = b->cols[col].type; r->codec = b->cols[col].codec; r->left = b->rows; r->lead = 0xFFu;
+}
+
+// Varint and TEXT streams are byte aligned and read straight from the bytes (`pos`), bypassing the bit buffer
+static uint64_t dec_varint(BitReader *br) {
+    uint64_t z = 0;
+    for (unsigned shift = 0; shift < 64u && br->pos < br->nbytes; shift += 7u) {
+        uint8_t byte = br->p[br->pos++]; z |= (uint64_t)(byte & 0x7Fu) << shift;
+        if (!(byte & 0x80u)) return z;
+    }
+    br->bad = true; return 0;
+}
+
+// Prefix codes are read from one peeked window: 0 | 10+7 | 110+9 | 1110+12 | 1111+36 bits
+static int dec_dod(SealReader *r) {
+    if (r->n == 0) { r->prev = (int32_t)(uint32_t)br_get(&r->br, 32u); return (int)r->prev; }
+    uint64_t w = br_peek(&r->br), z;
+    if (!(w >> 63)) { br_skip(&r->br, 1u); z = 0; }
+    else if (!((w >> 62) & 1u)) { br_skip(&r->br, 9u); z = (w << 2) >> 57; }
+    else if (!((w >> 61) & 1u)) { br_skip(&r->br, 12u); z = (w << 3) >> 55; }
+    else if (!((w >> 60) & 1u)) { br_skip(&r->br, 16u); z = (w << 4) >> 52; }
+    else { br_skip(&r->br, 4u); z = br_get(&r->br, 36u); }
+    r->delta += unzigzag(z); r->prev += r->delta;
+    return (int)(int32_t)(uint32_t)r->prev;
+}
+
+#ifdef SEAL_HAS_XOR
+static uint64_t dec_xor(SealReader *r, unsigned width) {
+    if (r->n == 0) return r->prev_bits = br_get(&r->br, width);
+    uint64_t w = br_peek(&r->br);
+    if (!(w >> 63)) { br_skip(&r->br, 1u); return r->prev_bits; }
+    if ((w >> 62) & 1u) {
+        unsigned lb = width == 64u ? 6u : 5u, lead = (unsigned)((w << 2) >> 59), len = (unsigned)((w << 7) >> (64u - lb)) + 1u;
+        if (lead + len > width) { r->br.bad = true; return 0; }
+        r->lead = lead; r->trail = width - lead - len;
+        br_skip(&r->br, 7u + lb);
+    } else {
+        if (r->lead == 0xFFu) { r->br.bad = true; return 0; }
+        br_skip(&r->br, 2u);
+    }
+    return r->prev_bits ^= br_get(&r->br, width - r->lead - r->trail) << r->trail;
+}
+#endif
+
+// Steady runs: a '0' code (DoD unchanged / XOR value repeated) is one bit, so up to `max` of them
+// are consumed at once from the leading zeros of the bit buffer. Never applies to the first value.
+static size_t dec_zero_run(SealReader *r, size_t max) {
+    if (r->n == 0) return 0;
+    uint64_t w = br_peek(&r->br);
+    if (w >> 63) return 0;
+    size_t run = w ? clz64(w) : 64u;
+    if (run > r->br.avail) run = r->br.avail;
+    if (run > max) run = max;
+    br_skip(&r->br, (unsigned)run); r->n += (uint32_t)run;
+    return r->br.bad ? 0 : run;
+}
+
+// Decode the next n (<= left) cells into a typed array; false on a corrupt stream
+static bool reader_next(SealReader *r, void *out, size_t n) {
+    if (n > r->left) return false;
+    size_t i = 0;
+    switch (r->codec) {
+        case SEAL_DOD:
+            while (i < n) {
+                size_t run = dec_zero_run(r, n - i);
+                for (size_t e = i + run; i < e; ++i) { r->prev += r->delta; ((int *)out)[i] = (int)(int32_t)(uint32_t)r->prev; }
+                if (i < n) { ((int *)out)[i++] = dec_dod(r); r->n++; }
+            }
+            break;
+        case SEAL_VARINT: for (; i < n; ++i) { r->prev += unzigzag(dec_varint(&r->br)); ((int *)out)[i] = (int)(int32_t)(uint32_t)r->prev; } break;
+        case SEAL_BITS: for (; i < n; ++i) ((uint8_t *)out)[i] = (uint8_t)br_get(&r->br, 1u); break;
+#ifndef DRIVERSQL_NO_TEXT
+        case SEAL_TEXT:
+            for (; i < n; ++i) {
+                char *s = ((char (*)[MAX_TEXT_LEN])out)[i]; size_t k = 0;
+                for (;;) { if (r->br.pos == r->br.nbytes || k == MAX_TEXT_LEN) return false; char ch = (char)r->br.p[r->br.pos++]; s[k++] = ch; if (!ch) break; }
+            }
+            break;
+#endif
+        default:
+#ifndef DRIVERSQL_NO_FLOAT
+            if (r->type == COL_FLOAT) {
+                while (i < n) {
+                    uint32_t u = (uint32_t)r->prev_bits; size_t run = dec_zero_run(r, n - i);
+                    for (size_t e = i + run; i < e; ++i) memcpy(&((float *)out)[i], &u, sizeof(u));
+                    if (i < n) { u = (uint32_t)dec_xor(r, 32u); memcpy(&((float *)out)[i++], &u, sizeof(u)); r->n++; }
+                }
+                break;
+            }
+#endif
+#ifndef DRIVERSQL_NO_DOUBLE
+            while (i < n) {
+                uint64_t u = r->prev_bits; size_t run = dec_zero_run(r, n - i);
+                for (size_t e = i + run; i < e; ++i) memcpy(&((double *)out)[i], &u, sizeof(u));
+                if (i < n) { u = dec_xor(r, 64u); memcpy(&((double *)out)[i++], &u, sizeof(u)); r->n++; }
+            }
+#endif
+            break;
+    }
+    if (r->br.bad) return false;
+    r->left -= (uint32_t)n;
+    return true;
+}
+
+// 64 decoded cells of any sealable type, viewed as a Column so the scan/agg kernels apply
+typedef union {
+    int i[DODA_SCAN_WORD];
+    uint8_t b[DODA_SCAN_WORD];
+#ifndef DRIVERSQL_NO_FLOAT
+    float f[DODA_SCAN_WORD];
+#endif
+#ifndef DRIVERSQL_NO_DOUBLE
+    double d[DODA_SCAN_WORD];
+#endif
+#ifndef DRIVERSQL_NO_TEXT
+    char s[SEAL_TEXT_CHUNK][MAX_TEXT_LEN];
+#endif
+} SealWord;
+
+static void word_column(Column *c, ColumnType ct, SealWord *w) {
+    memset(c, 0, sizeof(*c)); c->type = ct;
+    switch (ct) {
+        case COL_BOOL: c->data.bool_data = w->b; break;
+#ifndef DRIVERSQL_NO_TEXT
+        case COL_TEXT: c->data.text_data = w->s; break;
+#endif
+#ifndef DRIVERSQL_NO_FLOAT
+        case COL_FLOAT: c->data.float_data = w->f; break;
+#endif
+#ifndef DRIVERSQL_NO_DOUBLE
+        case COL_DOUBLE: c->data.double_data = w->d; break;
+#endif
+        default: c->data.int_data = w->i; break;
+    }
+}
+
+// Selection bitmap of predicate p over the next n (<= 64) cells of r
+static bool reader_match_word(SealReader *r, const Predicate *p, size_t n, uint64_t *m) {
+    SealWord w; Column c; word_column(&c, r->type, &w);
+#ifndef DRIVERSQL_NO_TEXT
+    if (r->type == COL_TEXT) {
+        *m = 0;
+        for (size_t k = 0; k < n; k += SEAL_TEXT_CHUNK) {
+            size_t len = n - k < SEAL_TEXT_CHUNK ? n - k : SEAL_TEXT_CHUNK;
+            if (!reader_next(r, w.s, len)) return false;
+            *m |= scan_column_word(&c, 0, len, p->op, p->value) << k;
+        }
+        return true;
+    }
+#endif
+    if (!reader_next(r, &w, n)) return false;
+    *m = scan_column_word(&c, 0, n, p->op, p->value);
+    return true;
+}
+
+static DSStatus resolve_sealed(const SealedBlock *b, const Predicate *preds, size_t npreds, SealReader *readers) {
+    if (npreds > MAX_PREDICATES || (npreds && !preds)) return DS_ERR_INVALID;
+    for (size_t i = 0; i < npreds; ++i) {
+        if (!preds[i].col_name || !preds[i].value) return DS_ERR_INVALID;
+        int c = sealed_column_index(b, preds[i].col_name); if (c < 0) return DS_ERR_NOT_FOUND;
+        reader_init(&readers[i], b, c);
+    }
+    return DS_OK;
+}
+
+DSStatus sealed_decode_column(const SealedBlock *b, int col, void *out, size_t cap_rows) {
+    if (!b || !out || col < 0 || col >= b->column_count) return DS_ERR_INVALID;
+    if (cap_rows < b->rows) return DS_ERR_FULL;
+    SealReader r; reader_init(&r, b, col);
+    return reader_next(&r, out, b->rows) ? DS_OK : DS_ERR_INVALID;
+}
+
+DSStatus sealed_select(const SealedBlock *b, const Predicate *preds, size_t npreds, uint64_t *sel, size_t sel_words, size_t *count_out) {
+    if (!b || !sel) return DS_ERR_INVALID;
+    size_t words = ((size_t)b->rows + 63u) / 64u, total = 0;
+    if (sel_words < words) return DS_ERR_FULL;
+    SealReader readers[MAX_PREDICATES];
+    DSStatus st = resolve_sealed(b, preds, npreds, readers); if (st != DS_OK) return st;
+    for (size_t w = 0; w < words; ++w) {
+        size_t base = w * 64u, n = b->rows - base < DODA_SCAN_WORD ? b->rows - base : DODA_SCAN_WORD;
+        uint64_t m = scan_tail_mask(base, b->rows);
+        for (size_t i = 0; i < npreds; ++i) { uint64_t pm; if (!reader_match_word(&readers[i], &preds[i], n, &pm)) return DS_ERR_INVALID; m &= pm; }
+        sel[w] = m; total += scan_popcount64(m);
+    }
+    if (count_out) *count_out = total;
+    return DS_OK;
+}
+
+DSStatus sealed_agg_columns(const SealedBlock *b, const char **col_names, size_t ncols, const Predicate *filters, size_t nfilters, AggResult *out) {
+    if (!b || !col_names || !out || ncols == 0 || ncols > MAX_COLUMNS) return DS_ERR_INVALID;
+    SealReader fr[MAX_PREDICATES], vr[MAX_COLUMNS]; AggAcc acc[MAX_COLUMNS];
+    for (size_t i = 0; i < ncols; ++i) {
+        if (!col_names[i]) return DS_ERR_INVALID;
+        int c = sealed_column_index(b, col_names[i]); if (c < 0) return DS_ERR_NOT_FOUND;
+        if (!scan_type_supported(b->cols[c].type)) return DS_ERR_UNSUPPORTED;
+        reader_init(&vr[i], b, c);
+    }
+    DSStatus st = resolve_sealed(b, filters, nfilters, fr); if (st != DS_OK) return st;
+    memset(acc, 0, ncols * sizeof(acc[0]));
+    for (size_t base = 0; base < b->rows; base += DODA_SCAN_WORD) {
+        size_t n = b->rows - base < DODA_SCAN_WORD ? b->rows - base : DODA_SCAN_WORD;
+        uint64_t m = scan_tail_mask(base, b->rows);
+        for (size_t i = 0; i < nfilters; ++i) { uint64_t pm; if (!reader_match_word(&fr[i], &filters[i], n, &pm)) return DS_ERR_INVALID; m &= pm; }
+        // Value streams are sequential, so every word is decoded even when nothing is selected
+        for (size_t i = 0; i < ncols; ++i) {
+            SealWord w; Column c; word_column(&c, vr[i].type, &w);
+            if (!reader_next(&vr[i], &w, n)) return DS_ERR_INVALID;
+            agg_acc_word(&acc[i], &c, 0, m);
+        }
+    }
+    for (size_t i = 0; i < ncols; ++i) agg_acc_finish(&acc[i], vr[i].type, &out[i]);
+    return DS_OK;
+}
+
+DSStatus sealed_unseal(const SealedBlock *b, Table *dest) {
+    if (!b || !dest) return DS_ERR_INVALID;
+    SealReader readers[MAX_COLUMNS];
+    for (int c = 0; c < dest->column_count; ++c) {
+        int sc = sealed_column_index(b, dest->columns[c].name);
+        if (sc < 0) return DS_ERR_NOT_FOUND;
+        if (b->cols[sc].type != dest->columns[c].type) return DS_ERR_INVALID;
+        reader_init(&readers[c], b, sc);
+    }
+    // One decoded cell per column; insert_row takes BOOL values as int
+    typedef union {
+        int i; uint8_t b;
+#ifndef DRIVERSQL_NO_FLOAT
+        float f;
+#endif
+#ifndef DRIVERSQL_NO_DOUBLE
+        double d;
+#endif
+#ifndef DRIVERSQL_NO_TEXT
+        char s[1][MAX_TEXT_LEN];
+#endif
+    } SealCell;
+    for (uint32_t r = 0; r < b->rows; ++r) {
+        const void *vals[MAX_COLUMNS]; SealCell cells[MAX_COLUMNS];
+        for (int c = 0; c < dest->column_count; ++c) {
+            if (!reader_next(&readers[c], &cells[c], 1u)) return DS_ERR_INVALID;
+            if (readers[c].type == COL_BOOL) cells[c].i = cells[c].b;
+            vals[c] = &cells[c];
+        }
+        DSStatus st = insert_row(dest, vals); if (st != DS_OK) return st;
+    }
+    return DS_OK;
+}
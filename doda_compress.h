@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2025 Rohit Ballurgi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software... [rest of standard MIT short-text]
+ * ...
+ * MIT License (see LICENSE file for full text)
+ */
+
+#pragma once
+#include "doda_engine.h"
+#include "doda_agg.h"
+
+// Compressed sealed blocks.
+//
+// Rows that will not change any more (e.g. samples older than a retention horizon) can be
+// sealed into one immutable, self-describing byte block in a caller buffer, one stream per
+// column:
+//  - time column (INT): delta-of-delta, bucketed bit codes (a steady 1 Hz series costs 1 bit/row)
+//  - other INT: zig-zag varint of the delta to the previous row
+//  - FLOAT/DOUBLE: Gorilla XOR against the previous value
+//  - BOOL: one bit per row; TEXT: NUL-terminated strings
+// POINTER columns cannot be sealed. The layout is little-endian and position independent, so
+// a block can be written to storage as is and opened again in place (sealed_open).
+// Scans and aggregates decode 64 rows at a time into a local buffer and reuse the scan/agg
+// kernels; rows in a block are numbered 0..rows-1 in seal order.
+
+typedef enum { SEAL_DOD = 1, SEAL_VARINT, SEAL_XOR, SEAL_BITS, SEAL_TEXT } SealCodec;
+
+typedef struct {
+    const uint8_t *data;  // encoded block (caller memory, must outlive the view)
+    size_t bytes;
+    uint32_t rows;
+    int column_count;
+    struct { const char *name; ColumnType type; uint8_t codec; uint32_t offset, bytes; } cols[MAX_COLUMNS];
+} SealedBlock;
+
+// Worst-case encoded size of nrows rows of t's schema
+size_t seal_bound_bytes(const Table *t, size_t nrows);
+// Encode the live rows matching every predicate (npreds == 0: all live rows) into buf and open
+// the result into *out. Rows are taken in select_into_all order, so an attached index on the
+// time column seals in time order. time_col (INT, may be NULL) selects the delta-of-delta codec.
+// DS_ERR_FULL if cap is too small (seal_bound_bytes is always enough).
+DSStatus seal_where(const Table *t, const Predicate *preds, size_t npreds, const char *time_col, uint8_t *buf, size_t cap, SealedBlock *out);
+// Validate an encoded block (e.g. read back from storage) and build its view
+DSStatus sealed_open(SealedBlock *b, const uint8_t *data, size_t bytes);
+int sealed_column_index(const SealedBlock *b, const char *col_name);
+
+// Decode column `col` into a typed array of b->rows cells (int/uint8_t/float/double/char[MAX_TEXT_LEN])
+DSStatus sealed_decode_column(const SealedBlock *b, int col, void *out, size_t cap_rows);
+// Bitmap of block rows matching every predicate; sel needs (rows + 63) / 64 words
+DSStatus sealed_select(const SealedBlock *b, const Predicate *preds, size_t npreds, uint64_t *sel, size_t sel_words, size_t *count_out);
+// Same results as agg_columns over the block rows that match every filter
+DSStatus sealed_agg_columns(const SealedBlock *b, const char **col_names, size_t ncols, const Predicate *filters, size_t nfilters, AggResult *out);
+// Append the block's rows to dest (same column names/types, in any order)
+DSStatus sealed_unseal(const SealedBlock *b, Table *dest);
+
+// DODA API aliases
+typedef SealedBlock DodaSealedBlock;
+static inline size_t doda_seal_bound_bytes(const DodaTable *t, size_t nrows) { return seal_bound_bytes((const Table*)t, nrows); }
+static inline DodaStatus doda_seal_where(const DodaTable *t, const DodaPredicate *preds, size_t npreds, const char *time_col, uint8_t *buf, size_t cap, DodaSealedBlock *out) { return (DodaStatus)seal_where((const Table*)t, (const Predicate*)preds, npreds, time_col, buf, cap, (SealedBlock*)out); }
+static inline DodaStatus doda_sealed_open(DodaSealedBlock *b, const uint8_t *data, size_t bytes) { return (DodaStatus)sealed_open((SealedBlock*)b, data, bytes); }
+static inline int doda_sealed_column_index(const DodaSealedBlock *b, const char *col_name) { return sealed_column_index((const SealedBlock*)b, col_name); }
+static inline DodaStatus doda_sealed_decode_column(const DodaSealedBlock *b, int col, void *out, size_t cap_rows) { return (DodaStatus)sealed_decode_column((const SealedBlock*)b, col, out, cap_rows); }
+static inline DodaStatus doda_sealed_select(const DodaSealedBlock *b, const DodaPredicate *preds, size_t npreds, uint64_t *sel, size_t sel_words, size_t *count_out) { return (DodaStatus)sealed_select((const SealedBlock*)b, (const Predicate*)preds, npreds, sel, sel_words, count_out); }
+static inline DodaStatus doda_sealed_agg_columns(const DodaSealedBlock *b, const char **col_names, size_t ncols, const DodaPredicate *filters, size_t nfilters, DodaAggResult *out) { return (DodaStatus)sealed_agg_columns((const SealedBlock*)b, col_names, ncols, (const Predicate*)filters, nfilters, (AggResult*)out); }
+static inline DodaStatus doda_sealed_unseal(const DodaSealedBlock *b, DodaTable *dest) { return (DodaStatus)sealed_unseal((const SealedBlock*)b, (Table*)dest); }
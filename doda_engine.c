@@ -8,6 +8,9 @@
  */
 
 #include "doda_engine.h"
+#include "doda_scan.h"
+#include <math.h>
+#include <stddef.h>
 #include <string.h>
 #ifndef DRIVERSQL_NO_STDIO
 #include <stdio.h>
@@ -19,64 +22,260 @@ static inline void set_deleted_bit(Table *t, size_t row, bool del) {
     if (del) t->deleted_bits[block] |= mask; else t->deleted_bits[block] &= ~mask;
 }
 
+static inline void mark_dirty(Table *t, size_t row) {
+    size_t block = row / 64u;
+    if (t->dirty_bits) t->dirty_bits[block / 64u] |= 1ULL << (block % 64u);
+}
+
 bool is_deleted(const Table *t, size_t row) {
     size_t block = row / 64, bit = row % 64;
     return (t->deleted_bits[block] >> bit) & 1ULL;
 }
 
+static void index_on_insert(Table *t, size_t row);
+static void index_on_delete(Table *t, size_t row);
+static const Index *attached_index(const Table *t, int col);
+
 static inline uint32_t hash32(uint32_t x) {
     x ^= x >> 16; x *= 0x7feb352d; x ^= x >> 15; x *= 0x846ca68b; x ^= x >> 16; return x;
 }
 
-static void pk_hash_clear(Table *t) { memset(t->pk_hash, 0, sizeof(t->pk_hash)); }
+// Primary-key index: open addressing with linear probing over the first INT column.
+// Slots hold row + 1 (0 = empty). Deletes use backward-shift instead of tombstones so
+// probe chains never accumulate dead entries, and the active slot range (hash_size)
+// doubles up to hash_capacity to keep the load factor <= 1/2.
+#define PK_HASH_MIN_SIZE 16u
+
+static inline bool has_pk(const Table *t) { return t->column_count > 0 && t->columns[0].type == COL_INT && t->hash_capacity > 0; }
+
+static inline size_t pk_home(const Table *t, int key) { return hash32((uint32_t)key) & (t->hash_size - 1u); }
+
+static void pk_hash_clear(Table *t) {
+    t->pk_count = 0;
+    t->hash_size = t->hash_capacity < PK_HASH_MIN_SIZE ? t->hash_capacity : PK_HASH_MIN_SIZE;
+    if (t->pk_hash) memset(t->pk_hash, 0, t->hash_size * sizeof(t->pk_hash[0]));
+}
+
+// Caller guarantees the key is absent and at least one slot is empty
+static void pk_hash_place(Table *t, int key, uint32_t row) {
+    size_t mask = t->hash_size - 1u, i = pk_home(t, key);
+    while (t->pk_hash[i] != 0) i = (i + 1u) & mask;
+    t->pk_hash[i] = row + 1u;
+}
+
+static void pk_hash_grow(Table *t) {
+    t->hash_size *= 2u;
+    memset(t->pk_hash, 0, t->hash_size * sizeof(t->pk_hash[0]));
+    for (size_t r = 0; r < t->count; ++r) if (!is_deleted(t, r)) pk_hash_place(t, t->columns[0].data.int_data[r], (uint32_t)r);
+}
+
+// Make room for one more key; false if the hash would have no empty slot left
+static bool pk_hash_reserve(Table *t) {
+    while ((t->pk_count + 1u) * 2u > t->hash_size && t->hash_size < t->hash_capacity) pk_hash_grow(t);
+    return t->pk_count + 1u < t->hash_size;
+}
 
-static bool pk_hash_insert(Table *t, int key, uint16_t row) {
-    uint32_t h = hash32((uint32_t)key);
-    for (uint32_t i = 0; i < HASH_SIZE; ++i) {
-        uint32_t idx = (h + i) & (HASH_SIZE - 1);
-        uint16_t slot = t->pk_hash[idx];
-        if (slot == 0) { t->pk_hash[idx] = (uint16_t)(row + 1); return true; }
-        uint16_t srow = (uint16_t)(slot - 1);
-        if (!is_deleted(t, srow) && t->columns[0].data.int_data[srow] == key) return false;
+static bool pk_hash_lookup(const Table *t, int key, size_t *slot_out) {
+    if (t->pk_count == 0) return false;
+    size_t mask = t->hash_size - 1u, i = pk_home(t, key);
+    for (size_t n = 0; n < t->hash_size; ++n, i = (i + 1u) & mask) {
+        uint32_t slot = t->pk_hash[i];
+        if (slot == 0) return false;
+        if (t->columns[0].data.int_data[slot - 1u] == key) { *slot_out = i; return true; }
     }
     return false;
 }
 
-static int pk_hash_find(const Table *t, int key) {
-    uint32_t h = hash32((uint32_t)key);
-    for (uint32_t i = 0; i < HASH_SIZE; ++i) {
-        uint32_t idx = (h + i) & (HASH_SIZE - 1);
-        uint16_t slot = t->pk_hash[idx];
-        if (slot == 0) return -1;
-        uint16_t row = (uint16_t)(slot - 1);
-        if (!is_deleted(t, row) && t->columns[0].data.int_data[row] == key) return (int)row;
+static bool pk_hash_find(const Table *t, int key, size_t *row_out) {
+    size_t i; if (!pk_hash_lookup(t, key, &i)) return false; *row_out = t->pk_hash[i] - 1u; return true;
+}
+
+static void pk_hash_remove_slot(Table *t, size_t i) {
+    size_t mask = t->hash_size - 1u, j = i;
+    for (;;) {
+        j = (j + 1u) & mask;
+        uint32_t slot = t->pk_hash[j];
+        if (slot == 0) break;
+        size_t home = pk_home(t, t->columns[0].data.int_data[slot - 1u]);
+        // Entry stays put if its home lies cyclically in (i, j]
+        if (((j - home) & mask) < ((j - i) & mask)) continue;
+        t->pk_hash[i] = slot; i = j;
     }
-    return -1;
+    t->pk_hash[i] = 0;
+    t->pk_count--;
 }
 
-static void pk_hash_remove(Table *t, int key) {
-    uint32_t h = hash32((uint32_t)key);
-    for (uint32_t i = 0; i < HASH_SIZE; ++i) {
-        uint32_t idx = (h + i) & (HASH_SIZE - 1);
-        uint16_t slot = t->pk_hash[idx];
-        if (slot == 0) return;
-        uint16_t row = (uint16_t)(slot - 1);
-        if (!is_deleted(t, row) && t->columns[0].data.int_data[row] == key) { t->pk_hash[idx] = 0; return; }
+void pk_hash_stats(const Table *t, PkHashStats *out) {
+    if (!out) return;
+    memset(out, 0, sizeof(*out));
+    if (!t || !has_pk(t)) return;
+    size_t mask = t->hash_size - 1u;
+    out->keys = t->pk_count; out->slots = t->hash_size;
+    for (size_t i = 0; i < t->hash_size; ++i) {
+        uint32_t slot = t->pk_hash[i]; if (slot == 0) continue;
+        size_t probe = ((i - pk_home(t, t->columns[0].data.int_data[slot - 1u])) & mask) + 1u;
+        out->total_probe += probe; if (probe > out->max_probe) out->max_probe = probe;
     }
 }
 
-// Firmware-safe initializer: caller supplies Table storage
-void init_table(Table *t, const char *name, int column_count, const char **col_names, const ColumnType *col_types) {
-    if (!t) return;
-    memset(t, 0, sizeof(*t));
+// Zone maps: an empty block is {+inf, -inf}; a NaN cell widens its block to {-inf, +inf}
+// so no predicate prunes it. Deletes never shrink a block, except that a block with no live
+// row left is reset.
+static void zone_reset(Table *t, size_t first_block, size_t nblocks) {
+    for (int i = 0; i < t->column_count; ++i) {
+        double *z = t->columns[i].zone; if (!z) continue;
+        for (size_t b = first_block; b < first_block + nblocks; ++b) { z[2u * b] = INFINITY; z[2u * b + 1u] = -INFINITY; }
+    }
+}
+
+static inline void zone_widen_cell(const Column *c, size_t row) {
+    size_t b = row / 64u; double *z = c->zone, v;
+    switch (c->type) {
+#ifndef DRIVERSQL_NO_FLOAT
+        case COL_FLOAT: v = (double)c->data.float_data[row]; break;
+#endif
+#ifndef DRIVERSQL_NO_DOUBLE
+        case COL_DOUBLE: v = c->data.double_data[row]; break;
+#endif
+        default: v = (double)c->data.int_data[row]; break;
+    }
+    if (v != v) { z[2u * b] = -INFINITY; z[2u * b + 1u] = INFINITY; return; }
+    if (v < z[2u * b]) z[2u * b] = v;
+    if (v > z[2u * b + 1u]) z[2u * b + 1u] = v;
+}
+
+static void zone_widen(Table *t, size_t row) {
+    for (int i = 0; i < t->column_count; ++i) if (t->columns[i].zone) zone_widen_cell(&t->columns[i], row);
+}
+
+// Leading bytes of a Table that an arena table uses: everything but the static `store`
+#ifndef DRIVERSQL_NO_STATIC_ROWS
+#define TABLE_HEADER_BYTES offsetof(Table, store)
+#else
+#define TABLE_HEADER_BYTES sizeof(Table)
+#endif
+
+static void init_schema(Table *t, const char *name, int column_count, const char **col_names, const ColumnType *col_types) {
+    memset(t, 0, TABLE_HEADER_BYTES);
     if (name) { strncpy(t->name, name, MAX_NAME_LEN - 1); t->name[MAX_NAME_LEN - 1] = '\0'; }
     t->column_count = column_count;
-    t->capacity = MAX_ROWS;
     for (int i = 0; i < column_count && i < MAX_COLUMNS; ++i) {
         if (col_names && col_names[i]) { strncpy(t->columns[i].name, col_names[i], MAX_NAME_LEN - 1); t->columns[i].name[MAX_NAME_LEN - 1] = '\0'; }
         t->columns[i].type = col_types ? col_types[i] : COL_INT;
     }
+}
+
+// Firmware-safe initializer: caller supplies Table storage
+void init_table(Table *t, const char *name, int column_count, const char **col_names, const ColumnType *col_types) {
+    if (!t) return;
+    init_schema(t, name, column_count, col_names, col_types);
+#ifndef DRIVERSQL_NO_STATIC_ROWS
+    memset(&t->store, 0, sizeof(t->store));
+    t->capacity = MAX_ROWS;
+    for (int i = 0; i < column_count && i < MAX_COLUMNS; ++i) t->columns[i].data.int_data = (int *)(void *)&t->store.columns[i];
+    t->deleted_bits = t->store.deleted_bits;
+    t->dirty_bits = t->store.dirty_bits;
+    t->free_list = t->store.free_list;
+    t->pk_hash = t->store.pk_hash;
+    t->hash_capacity = HASH_SIZE;
+#ifndef DRIVERSQL_NO_ZONE_MAPS
+    for (int i = 0; i < column_count && i < MAX_COLUMNS; ++i) if (scan_type_supported(t->columns[i].type)) t->columns[i].zone = t->store.zones[i];
+#endif
+#endif
+    zone_reset(t, 0, (t->capacity + 63u) / 64u);
+    pk_hash_clear(t);
+}
+
+static size_t cell_bytes(ColumnType ct) {
+    switch (ct) {
+        case COL_INT: return sizeof(int);
+#ifndef DRIVERSQL_NO_TEXT
+        case COL_TEXT: return MAX_TEXT_LEN;
+#endif
+        case COL_BOOL: return sizeof(uint8_t);
+#ifndef DRIVERSQL_NO_FLOAT
+        case COL_FLOAT: return sizeof(float);
+#endif
+#ifndef DRIVERSQL_NO_DOUBLE
+        case COL_DOUBLE: return sizeof(double);
+#endif
+#ifndef DRIVERSQL_NO_POINTER_COLUMN
+        case COL_POINTER: return sizeof(void *);
+#endif
+        default: return 0;
+    }
+}
+
+// Arena sections are 8-byte aligned (uint64_t bitmap words, doubles, pointers)
+#define ARENA_ALIGN 8u
+static inline size_t arena_round(size_t n) { return (n + (ARENA_ALIGN - 1u)) & ~(size_t)(ARENA_ALIGN - 1u); }
+
+// Largest row_capacity whose sections cannot overflow size_t: every section (a column of
+// the widest cell, the pk hash at up to 4 slots per row) stays below SIZE_MAX / 4
+#define ARENA_MAX_CELL (MAX_TEXT_LEN > 8 ? (size_t)MAX_TEXT_LEN : (size_t)8)
+#define ARENA_MAX_ROWS (SIZE_MAX / (4u * ARENA_MAX_CELL))
+
+// Smallest power of two holding row_capacity keys at <= 50% load
+static size_t arena_hash_size(size_t row_capacity) {
+    size_t n = 1; while (n < row_capacity * 2u) n <<= 1; return n;
+}
+
+// n += arena_round(add); false once the total no longer fits in size_t
+static inline bool arena_add(size_t *n, size_t add) {
+    add = arena_round(add);
+    if (add > SIZE_MAX - *n) return false;
+    *n += add; return true;
+}
+
+size_t table_arena_bytes(int column_count, const ColumnType *col_types, size_t row_capacity) {
+    if (column_count <= 0 || column_count > MAX_COLUMNS || !col_types || row_capacity == 0 || row_capacity > ARENA_MAX_ROWS) return 0;
+    size_t n = ARENA_ALIGN - 1u; // slack for an unaligned arena base
+    bool ok = arena_add(&n, ((row_capacity + 63u) / 64u) * sizeof(uint64_t));
+    ok = ok && arena_add(&n, ((row_capacity + 4095u) / 4096u) * sizeof(uint64_t));
+    ok = ok && arena_add(&n, row_capacity * sizeof(uint32_t));
+    ok = ok && arena_add(&n, arena_hash_size(row_capacity) * sizeof(uint32_t));
+    for (int i = 0; ok && i < column_count; ++i) {
+        size_t cb = cell_bytes(col_types[i]); if (cb == 0) return 0;
+        ok = arena_add(&n, row_capacity * cb);
+#ifndef DRIVERSQL_NO_ZONE_MAPS
+        if (ok && scan_type_supported(col_types[i])) ok = arena_add(&n, ((row_capacity + 63u) / 64u) * 2u * sizeof(double));
+#endif
+    }
+    return ok ? n : 0;
+}
+
+size_t table_header_bytes(void) { return arena_round(TABLE_HEADER_BYTES); }
+
+DSStatus init_table_arena(Table *t, const char *name, int column_count, const char **col_names, const ColumnType *col_types, void *arena, size_t arena_bytes, size_t row_capacity) {
+    if (!t || !arena || !col_types || row_capacity == 0 || row_capacity >= UINT32_MAX || row_capacity > ARENA_MAX_ROWS) return DS_ERR_INVALID;
+    size_t need = table_arena_bytes(column_count, col_types, row_capacity);
+    if (need == 0) {
+        if (column_count <= 0 || column_count > MAX_COLUMNS) return DS_ERR_INVALID;
+        for (int i = 0; i < column_count; ++i) if (cell_bytes(col_types[i]) == 0) return DS_ERR_UNSUPPORTED;
+        return DS_ERR_INVALID; // sizes overflow size_t
+    }
+    if (arena_bytes < need) return DS_ERR_INVALID;
+
+    init_schema(t, name, column_count, col_names, col_types);
+    uint8_t *p = (uint8_t *)arena;
+    p += (ARENA_ALIGN - ((uintptr_t)p & (ARENA_ALIGN - 1u))) & (ARENA_ALIGN - 1u);
+    size_t bits = ((row_capacity + 63u) / 64u) * sizeof(uint64_t);
+    t->deleted_bits = (uint64_t *)(void *)p; memset(p, 0, bits); p += arena_round(bits);
+    bits = ((row_capacity + 4095u) / 4096u) * sizeof(uint64_t);
+    t->dirty_bits = (uint64_t *)(void *)p; memset(p, 0, bits); p += arena_round(bits);
+    t->free_list = (uint32_t *)(void *)p; p += arena_round(row_capacity * sizeof(uint32_t));
+    t->hash_capacity = arena_hash_size(row_capacity);
+    t->pk_hash = (uint32_t *)(void *)p; p += arena_round(t->hash_capacity * sizeof(uint32_t));
+    for (int i = 0; i < column_count; ++i) {
+        t->columns[i].data.int_data = (int *)(void *)p; p += arena_round(row_capacity * cell_bytes(col_types[i]));
+#ifndef DRIVERSQL_NO_ZONE_MAPS
+        if (scan_type_supported(col_types[i])) { t->columns[i].zone = (double *)(void *)p; p += arena_round(((row_capacity + 63u) / 64u) * 2u * sizeof(double)); }
+#endif
+    }
+    t->capacity = row_capacity;
+    zone_reset(t, 0, (row_capacity + 63u) / 64u);
     pk_hash_clear(t);
+    return DS_OK;
 }
 
 // Remove create_table definition
@@ -107,16 +306,7 @@ static inline bool type_enabled(ColumnType ct) {
     }
 }
 
-DSStatus insert_row(Table *t, const void *values[]) {
-    if (!t || !values) return DS_ERR_INVALID;
-    // Validate types against feature gates
-    for (int i = 0; i < t->column_count; ++i) if (!type_enabled(t->columns[i].type)) return DS_ERR_UNSUPPORTED;
-
-    size_t row;
-    if (t->count >= t->capacity && t->free_top == 0) return DS_ERR_FULL;
-    if (t->count >= t->capacity) { row = t->free_list[--t->free_top]; }
-    else { row = t->count++; }
-
+static DSStatus write_cells(Table *t, size_t row, const void *values[]) {
     for (int i = 0; i < t->column_count; ++i) {
         Column *c = &t->columns[i];
         switch (c->type) {
@@ -137,9 +327,36 @@ DSStatus insert_row(Table *t, const void *values[]) {
             default: return DS_ERR_UNSUPPORTED;
         }
     }
+    return DS_OK;
+}
+
+// Cells are written; make the row live and enter it into the pk hash and attached indexes
+static void link_row(Table *t, size_t row, bool pk) {
     set_deleted_bit(t, row, false);
-    int pk = t->columns[0].data.int_data[row];
-    if (!pk_hash_insert(t, pk, (uint16_t)row)) return DS_ERR_UNSUPPORTED; // duplicate PK
+    zone_widen(t, row);
+    mark_dirty(t, row);
+    if (pk) { pk_hash_place(t, t->columns[0].data.int_data[row], (uint32_t)row); t->pk_count++; }
+    if (t->index_count) index_on_insert(t, row);
+}
+
+DSStatus insert_row(Table *t, const void *values[]) {
+    if (!t || !values) return DS_ERR_INVALID;
+    // Validate types against feature gates
+    for (int i = 0; i < t->column_count; ++i) if (!type_enabled(t->columns[i].type)) return DS_ERR_UNSUPPORTED;
+
+    size_t row;
+    if (t->count >= t->capacity && t->free_top == 0) return DS_ERR_FULL;
+    bool pk = has_pk(t);
+    if (pk) {
+        size_t dup;
+        if (pk_hash_find(t, *(const int *)values[0], &dup)) return DS_ERR_UNSUPPORTED; // duplicate PK
+        if (!pk_hash_reserve(t)) return DS_ERR_FULL;
+    }
+    if (t->count >= t->capacity) { row = t->free_list[--t->free_top]; }
+    else { row = t->count++; }
+
+    DSStatus st = write_cells(t, row, values); if (st != DS_OK) return st;
+    link_row(t, row, pk);
     return DS_OK;
 }
 
@@ -147,17 +364,117 @@ DSStatus insert_row_int_text_int(Table *t, int v0, const char *v1, int v2) {
     const void *vals[3]; vals[0] = &v0; vals[1] = v1; vals[2] = &v2; return insert_row(t, vals);
 }
 
+// Cells of input rows [first, first + n) go to rows [row, row + n): one memcpy per fixed-width column
+static void copy_column_cells(Table *t, size_t row, const void *columns[], size_t first, size_t n) {
+    for (int i = 0; i < t->column_count; ++i) {
+        Column *c = &t->columns[i];
+        switch (c->type) {
+            case COL_INT:    memcpy(&c->data.int_data[row], (const int *)columns[i] + first, n * sizeof(int)); break;
+#ifndef DRIVERSQL_NO_TEXT
+            case COL_TEXT:
+                for (size_t k = 0; k < n; ++k) {
+                    const char *s = ((const char *const *)columns[i])[first + k];
+                    strncpy(c->data.text_data[row + k], s ? s : "", MAX_TEXT_LEN - 1); c->data.text_data[row + k][MAX_TEXT_LEN - 1] = '\0';
+                }
+                break;
+#endif
+            case COL_BOOL:   for (size_t k = 0; k < n; ++k) c->data.bool_data[row + k] = (uint8_t)(((const uint8_t *)columns[i])[first + k] != 0); break;
+#ifndef DRIVERSQL_NO_FLOAT
+            case COL_FLOAT:  memcpy(&c->data.float_data[row], (const float *)columns[i] + first, n * sizeof(float)); break;
+#endif
+#ifndef DRIVERSQL_NO_DOUBLE
+            case COL_DOUBLE: memcpy(&c->data.double_data[row], (const double *)columns[i] + first, n * sizeof(double)); break;
+#endif
+#ifndef DRIVERSQL_NO_POINTER_COLUMN
+            case COL_POINTER:memcpy(&c->data.ptr_data[row], (void *const *)columns[i] + first, n * sizeof(void *)); break;
+#endif
+            default: break;
+        }
+    }
+}
+
+static void move_row_cells(Table *t, size_t dst, size_t src) {
+    for (int i = 0; i < t->column_count; ++i) {
+        Column *c = &t->columns[i]; size_t w = cell_bytes(c->type);
+        uint8_t *base = c->data.bool_data; // any member: the cells are w bytes apart
+        memcpy(base + dst * w, base + src * w, w);
+    }
+}
+
+static inline void mark_failed(uint64_t *failed, size_t j) { if (failed) failed[j / 64u] |= 1ULL << (j % 64u); }
+
+// Append block: cells are copied column by column into the tail, then rows are linked in input
+// order; a duplicate key is left out and later rows close the gap, so the block stays dense.
+// Room left by dropped rows takes the next block. Rows past the tail go to recycled slots one
+// at a time.
+DSStatus insert_columns(Table *t, size_t n, const void *columns[], uint64_t *failed, size_t *inserted_out) {
+    if (inserted_out) *inserted_out = 0;
+    if (!t || !columns) return DS_ERR_INVALID;
+    for (int i = 0; i < t->column_count; ++i) {
+        if (!type_enabled(t->columns[i].type)) return DS_ERR_UNSUPPORTED;
+        if (!columns[i] && n) return DS_ERR_INVALID;
+    }
+    if (failed) memset(failed, 0, ((n + 63u) / 64u) * sizeof(failed[0]));
+    bool pk = has_pk(t), full = false;
+    const int *keys = pk ? (const int *)columns[0] : NULL;
+    size_t j = 0, done = 0;
+    if (pk) while ((t->pk_count + n + 1u) * 2u > t->hash_size && t->hash_size < t->hash_capacity) pk_hash_grow(t);
+
+    while (j < n && t->count < t->capacity) {
+        size_t base = t->count, k = t->capacity - base < n - j ? t->capacity - base : n - j, w = base;
+        copy_column_cells(t, base, columns, j, k);
+        for (size_t i = 0; i < k; ++i) {
+            size_t dup;
+            if (pk && (pk_hash_find(t, keys[j + i], &dup) || t->pk_count + 1u >= t->hash_size)) { full |= t->pk_count + 1u >= t->hash_size; mark_failed(failed, j + i); continue; }
+            if (w != base + i) move_row_cells(t, w, base + i);
+            if (pk) { pk_hash_place(t, keys[j + i], (uint32_t)w); t->pk_count++; }
+            w++;
+        }
+        t->count = w;
+        for (size_t r = base; r < w; ++r) set_deleted_bit(t, r, false);
+        for (int i = 0; i < t->column_count; ++i) if (t->columns[i].zone) for (size_t r = base; r < w; ++r) zone_widen_cell(&t->columns[i], r);
+        for (size_t r = base; r < w; r = (r | 63u) + 1u) mark_dirty(t, r);
+        if (t->index_count) for (size_t r = base; r < w; ++r) index_on_insert(t, r);
+        done += w - base;
+        j += k;
+    }
+
+    for (; j < n; ++j) {
+        size_t dup;
+        if (t->free_top == 0 || (pk && !pk_hash_reserve(t))) { full = true; mark_failed(failed, j); continue; }
+        if (pk && pk_hash_find(t, keys[j], &dup)) { mark_failed(failed, j); continue; }
+        size_t row = t->free_list[--t->free_top];
+        copy_column_cells(t, row, columns, j, 1);
+        link_row(t, row, pk);
+        done++;
+    }
+    if (inserted_out) *inserted_out = done;
+    return full ? DS_ERR_FULL : DS_OK;
+}
+
+// Word-at-a-time scan: the match bitmap for 64 rows is ANDed with the live-row word
+// and callbacks are driven from the set bits. Dead words and words whose zone map
+// rules the predicate out are skipped without reading the column.
+static void scan_emit(const Table *t, const Column *c, Op op, const void *value, row_callback cb, void *user) {
+    size_t count = t->count;
+    for (size_t base = 0; base < count; base += DODA_SCAN_WORD) {
+        uint64_t live = ~t->deleted_bits[base / 64u] & scan_tail_mask(base, count);
+        if (!live) continue;
+        size_t n = count - base < DODA_SCAN_WORD ? count - base : DODA_SCAN_WORD;
+        uint64_t m = scan_column_word(c, base, n, op, value) & live;
+        while (m) { cb(t, base + scan_ctz64(m), user); m &= m - 1u; }
+    }
+}
+
 DSStatus select_where_eq(const Table *t, const char *col_name, const void *eq_value, row_callback cb, void *user) {
     if (!t || !col_name || !cb) return DS_ERR_INVALID;
     int idx = column_index(t, col_name); if (idx < 0) return DS_ERR_NOT_FOUND; const Column *c = &t->columns[idx];
     if (!type_enabled(c->type)) return DS_ERR_UNSUPPORTED;
-    if (idx == 0 && c->type == COL_INT) { int key = *(const int *)eq_value; int row = pk_hash_find(t, key); if (row >= 0) cb(t, (size_t)row, user); return DS_OK; }
+    if (idx == 0 && c->type == COL_INT) { int key = *(const int *)eq_value; size_t row; if (pk_hash_find(t, key, &row)) cb(t, row, user); return DS_OK; }
+    const Index *live = attached_index(t, idx);
+    if (live && index_select_eq(t, live, eq_value, cb, user) == IDX_OK) return DS_OK;
+    if (scan_type_supported(c->type)) { scan_emit(t, c, OP_EQ, eq_value, cb, user); return DS_OK; }
     switch (c->type) {
-        case COL_INT: {
-            int key = *(const int *)eq_value;
-            for (size_t r = 0; r < t->count; ++r) if (!is_deleted(t, r) && c->data.int_data[r] == key) cb(t, r, user);
-            break;
-        }
 #ifndef DRIVERSQL_NO_TEXT
         case COL_TEXT: {
             const char *key = (const char *)eq_value;
@@ -170,20 +487,6 @@ DSStatus select_where_eq(const Table *t, const char *col_name, const void *eq_va
             for (size_t r = 0; r < t->count; ++r) if (!is_deleted(t, r) && t->columns[idx].data.bool_data[r] == key) cb(t, r, user);
             break;
         }
-#ifndef DRIVERSQL_NO_FLOAT
-        case COL_FLOAT: {
-            float key = *(const float *)eq_value;
-            for (size_t r = 0; r < t->count; ++r) if (!is_deleted(t, r) && t->columns[idx].data.float_data[r] == key) cb(t, r, user);
-            break;
-        }
-#endif
-#ifndef DRIVERSQL_NO_DOUBLE
-        case COL_DOUBLE: {
-            double key = *(const double *)eq_value;
-            for (size_t r = 0; r < t->count; ++r) if (!is_deleted(t, r) && t->columns[idx].data.double_data[r] == key) cb(t, r, user);
-            break;
-        }
-#endif
 #ifndef DRIVERSQL_NO_POINTER_COLUMN
         case COL_POINTER: {
             const void *key = eq_value;
@@ -191,6 +494,7 @@ DSStatus select_where_eq(const Table *t, const char *col_name, const void *eq_va
             break;
         }
 #endif
+        default: break;
     }
     return DS_OK;
 }
@@ -199,39 +503,53 @@ DSStatus select_where_op(const Table *t, const char *col_name, Op op, const void
     if (!t || !col_name || !cb) return DS_ERR_INVALID;
     int idx = column_index(t, col_name); if (idx < 0) return DS_ERR_NOT_FOUND; const Column *c = &t->columns[idx];
     if (!type_enabled(c->type)) return DS_ERR_UNSUPPORTED;
-    if (c->type == COL_INT) {
-        int key = *(const int *)value;
-        for (size_t r = 0; r < t->count; ++r) {
-            if (is_deleted(t, r)) continue; int v = c->data.int_data[r]; bool m = false;
-            switch (op) { case OP_EQ: m = (v == key); break; case OP_GT: m = (v > key); break; case OP_LT: m = (v < key); break; case OP_GTE: m = (v >= key); break; }
-            if (m) cb(t, r, user);
-        }
-    }
-#ifndef DRIVERSQL_NO_FLOAT
-    else if (c->type == COL_FLOAT) {
-        float key = *(const float *)value;
-        for (size_t r = 0; r < t->count; ++r) {
-            if (is_deleted(t, r)) continue; float v = t->columns[idx].data.float_data[r]; bool m = false;
-            switch (op) { case OP_EQ: m = (v == key); break; case OP_GT: m = (v > key); break; case OP_LT: m = (v < key); break; case OP_GTE: m = (v >= key); break; }
-            if (m) cb(t, r, user);
-        }
+    const Index *live = attached_index(t, idx);
+    if (live && index_select_op(t, live, op, value, cb, user) == IDX_OK) return DS_OK;
+    if (op == OP_EQ) return select_where_eq(t, col_name, value, cb, user);
+    scan_emit(t, c, op, value, cb, user);
+    return DS_OK;
+}
+
+// Unlink a live row from the pk hash, mark it deleted and recycle its slot
+static void release_row(Table *t, size_t row) {
+    size_t slot;
+    if (has_pk(t) && pk_hash_lookup(t, t->columns[0].data.int_data[row], &slot) && t->pk_hash[slot] - 1u == row) pk_hash_remove_slot(t, slot);
+    if (t->index_count) index_on_delete(t, row);
+    set_deleted_bit(t, row, true);
+    mark_dirty(t, row);
+    if (!(~t->deleted_bits[row / 64u] & scan_tail_mask(row & ~(size_t)63u, t->count))) zone_reset(t, row / 64u, 1);
+    t->free_list[t->free_top++] = (uint32_t)row;
+}
+
+DSStatus delete_row(Table *t, size_t row) {
+    if (!t) return DS_ERR_INVALID;
+    if (row >= t->count || is_deleted(t, row)) return DS_ERR_NOT_FOUND;
+    release_row(t, row);
+    return DS_OK;
+}
+
+DSStatus restore_row(Table *t, size_t row, const void *values[]) {
+    if (!t || !values) return DS_ERR_INVALID;
+    for (int i = 0; i < t->column_count; ++i) if (!type_enabled(t->columns[i].type)) return DS_ERR_UNSUPPORTED;
+    if (row >= t->capacity) return DS_ERR_FULL;
+    bool pk = has_pk(t);
+    if (row < t->count && !is_deleted(t, row)) release_row(t, row);
+    if (pk) {
+        size_t other;
+        if (pk_hash_find(t, *(const int *)values[0], &other)) release_row(t, other);
+        if (!pk_hash_reserve(t)) return DS_ERR_FULL;
     }
-#endif
-#ifndef DRIVERSQL_NO_DOUBLE
-    else if (c->type == COL_DOUBLE) {
-        double key = *(const double *)value;
-        for (size_t r = 0; r < t->count; ++r) {
-            if (is_deleted(t, r)) continue; double v = t->columns[idx].data.double_data[r]; bool m = false;
-            switch (op) { case OP_EQ: m = (v == key); break; case OP_GT: m = (v > key); break; case OP_LT: m = (v < key); break; case OP_GTE: m = (v >= key); break; }
-            if (m) cb(t, r, user);
-        }
+    if (row < t->count) {
+        // Take the slot off the free list (recently freed slots sit on top)
+        size_t i = t->free_top;
+        while (i > 0 && t->free_list[i - 1u] != (uint32_t)row) i--;
+        if (i > 0) t->free_list[i - 1u] = t->free_list[--t->free_top];
+    } else {
+        for (size_t r = t->count; r < row; ++r) { set_deleted_bit(t, r, true); t->free_list[t->free_top++] = (uint32_t)r; }
+        t->count = row + 1u;
     }
-#endif
-#ifndef DRIVERSQL_NO_TEXT
-    else { if (op == OP_EQ) select_where_eq(t, col_name, value, cb, user); }
-#else
-    else { if (op == OP_EQ && c->type == COL_BOOL) select_where_eq(t, col_name, value, cb, user); }
-#endif
+    DSStatus st = write_cells(t, row, values); if (st != DS_OK) return st;
+    link_row(t, row, pk);
     return DS_OK;
 }
 
@@ -243,20 +561,20 @@ DSStatus delete_where_eq(Table *t, const char *col_name, const void *eq_value, s
     if (c->type == COL_INT) {
         int key = *(const int *)eq_value;
         if (idx == 0) {
-            int row = pk_hash_find(t, key);
-            if (row >= 0 && !is_deleted(t, (size_t)row)) { set_deleted_bit(t, (size_t)row, true); pk_hash_remove(t, key); t->free_list[t->free_top++] = (uint16_t)row; del = 1; }
+            size_t row;
+            if (pk_hash_find(t, key, &row)) { release_row(t, row); del = 1; }
             *deleted_out = del;
             return DS_OK;
         }
         for (size_t r = 0; r < t->count; ++r) {
-            if (is_deleted(t, r)) continue; if (c->data.int_data[r] == key) { set_deleted_bit(t, r, true); t->free_list[t->free_top++] = (uint16_t)r; del++; }
+            if (is_deleted(t, r)) continue; if (c->data.int_data[r] == key) { release_row(t, r); del++; }
         }
     }
 #ifndef DRIVERSQL_NO_TEXT
     else {
         const char *key = (const char *)eq_value;
         for (size_t r = 0; r < t->count; ++r) {
-            if (is_deleted(t, r)) continue; if (strncmp(c->data.text_data[r], key, MAX_TEXT_LEN) == 0) { set_deleted_bit(t, r, true); t->free_list[t->free_top++] = (uint16_t)r; del++; }
+            if (is_deleted(t, r)) continue; if (strncmp(c->data.text_data[r], key, MAX_TEXT_LEN) == 0) { release_row(t, r); del++; }
         }
     }
 #else
@@ -294,182 +612,477 @@ void print_row(const Table *t, size_t r) {
 
 void free_table(Table *t) { (void)t; }
 
-static void sort_rows_by_int(const Table *t, int col, uint16_t *rows, size_t n) {
-    for (size_t i = 1; i < n; ++i) {
-        uint16_t key = rows[i]; int vkey = t->columns[col].data.int_data[key]; size_t j = i;
-        while (j > 0) {
-            uint16_t rprev = rows[j-1]; int vprev = t->columns[col].data.int_data[rprev];
-            if (vprev <= vkey) break; rows[j] = rows[j-1]; j--;
+void table_clear(Table *t) {
+    if (!t) return;
+    if (t->deleted_bits) memset(t->deleted_bits, 0, ((t->count + 63u) / 64u) * sizeof(t->deleted_bits[0]));
+    zone_reset(t, 0, (t->count + 63u) / 64u);
+    for (size_t r = 0; r < t->count; r += 64u) mark_dirty(t, r);
+    t->count = 0; t->free_top = 0;
+    pk_hash_clear(t);
+    for (int i = 0; i < t->index_count; ++i) t->indexes[i]->size = 0;
+}
+
+bool table_block_dirty(const Table *t, size_t block) {
+    return t && t->dirty_bits && block < (t->capacity + 63u) / 64u && ((t->dirty_bits[block / 64u] >> (block % 64u)) & 1ULL);
+}
+
+void table_clear_dirty(Table *t) {
+    if (t && t->dirty_bits) memset(t->dirty_bits, 0, ((t->capacity + 4095u) / 4096u) * sizeof(t->dirty_bits[0]));
+}
+
+DSStatus table_adopt_rows(Table *t, size_t count) {
+    if (!t) return DS_ERR_INVALID;
+    if (count > t->capacity) return DS_ERR_FULL;
+    size_t words = (count + 63u) / 64u;
+    if (count % 64u) t->deleted_bits[words - 1u] &= scan_tail_mask((words - 1u) * 64u, count);
+    t->count = count;
+    t->free_top = 0;
+    for (size_t r = count; r-- > 0;) if (is_deleted(t, r)) t->free_list[t->free_top++] = (uint32_t)r;
+
+    zone_reset(t, 0, words);
+    for (size_t r = 0; r < count; ++r) if (!is_deleted(t, r)) zone_widen(t, r);
+
+    if (has_pk(t)) {
+        // Size the hash once for every live key instead of growing through the doublings
+        size_t live = count - t->free_top;
+        pk_hash_clear(t);
+        while ((live + 1u) * 2u > t->hash_size && t->hash_size < t->hash_capacity) t->hash_size *= 2u;
+        if (live + 1u > t->hash_size) return DS_ERR_FULL;
+        memset(t->pk_hash, 0, t->hash_size * sizeof(t->pk_hash[0]));
+        for (size_t r = 0; r < count; ++r) {
+            if (is_deleted(t, r)) continue;
+            size_t dup; int key = t->columns[0].data.int_data[r];
+            if (pk_hash_find(t, key, &dup)) return DS_ERR_UNSUPPORTED; // duplicate PK
+            pk_hash_place(t, key, (uint32_t)r); t->pk_count++;
         }
-        rows[j] = key;
     }
+    // An index without room for the live rows deactivates and flags itself full, as on insert
+    for (int i = 0; i < t->index_count; ++i) {
+        Index *idx = t->indexes[i]; if (!idx->active) continue;
+        if (idx->capacity < count - t->free_top) { idx->active = false; idx->full = true; continue; }
+        index_build_arena(t, idx, t->columns[idx->column_id].name, idx->rows, idx->capacity);
+    }
+    for (size_t r = 0; r < count; r += 64u) mark_dirty(t, r);
+    return DS_OK;
 }
+
+// Index construction: in-place MSD radix sort (American flag sort) of row ids on an
+// order-preserving unsigned key, one byte per pass, so no scratch buffer is needed.
+// Entries are ordered by (key, row id): the row id's 4 bytes follow the key bytes, so
+// inserts and deletes can binary-search an exact entry even among many equal keys.
+// Small buckets finish with insertion sort; TEXT buckets still tied after
+// RADIX_TEXT_MAX_DEPTH bytes finish with heapsort to bound recursion depth.
+#define RADIX_CUTOFF 32u
+#define RADIX_TEXT_MAX_DEPTH 16u
+#define RADIX_ROW_BYTES 4u
+
+static unsigned radix_key_bytes(ColumnType ct) {
+    switch (ct) {
+        case COL_INT: return sizeof(uint32_t);
 #ifndef DRIVERSQL_NO_FLOAT
-static void sort_rows_by_float(const Table *t, int col, uint16_t *rows, size_t n) {
-    for (size_t i = 1; i < n; ++i) {
-        uint16_t key = rows[i]; float vkey = t->columns[col].data.float_data[key]; size_t j = i;
-        while (j > 0) {
-            uint16_t rprev = rows[j-1]; float vprev = t->columns[col].data.float_data[rprev];
-            if (vprev <= vkey) break; rows[j] = rows[j-1]; j--;
-        }
-        rows[j] = key;
+        case COL_FLOAT: return sizeof(uint32_t);
+#endif
+#ifndef DRIVERSQL_NO_DOUBLE
+        case COL_DOUBLE: return sizeof(uint64_t);
+#endif
+#ifndef DRIVERSQL_NO_TEXT
+        case COL_TEXT: return MAX_TEXT_LEN;
+#endif
+        default: return 0;
     }
 }
+
+// Signed ints flip the sign bit; IEEE floats flip all bits when negative, else the sign bit.
+// -0.0 maps to +0.0 so both zeros are one key; NaNs order by bit pattern past the infinities.
+static inline uint64_t radix_key(const Column *c, uint32_t row) {
+    switch (c->type) {
+        case COL_INT: return (uint32_t)c->data.int_data[row] ^ 0x80000000u;
+#ifndef DRIVERSQL_NO_FLOAT
+        case COL_FLOAT: {
+            uint32_t u; memcpy(&u, &c->data.float_data[row], sizeof(u));
+            if (u == 0x80000000u) u = 0;
+            return (u & 0x80000000u) ? (uint32_t)~u : (u ^ 0x80000000u);
+        }
 #endif
 #ifndef DRIVERSQL_NO_DOUBLE
-static void sort_rows_by_double(const Table *t, int col, uint16_t *rows, size_t n) {
-    for (size_t i = 1; i < n; ++i) {
-        uint16_t key = rows[i]; double vkey = t->columns[col].data.double_data[key]; size_t j = i;
-        while (j > 0) {
-            uint16_t rprev = rows[j-1]; double vprev = t->columns[col].data.double_data[rprev];
-            if (vprev <= vkey) break; rows[j] = rows[j-1]; j--;
+        case COL_DOUBLE: {
+            uint64_t u; memcpy(&u, &c->data.double_data[row], sizeof(u));
+            if (u == 0x8000000000000000ULL) u = 0;
+            return (u >> 63) ? ~u : (u ^ 0x8000000000000000ULL);
         }
-        rows[j] = key;
+#endif
+        default: return 0;
     }
 }
+
+static inline unsigned radix_digit(const Column *c, uint32_t row, unsigned depth, unsigned width) {
+    if (depth >= width) return (row >> (8u * (width + RADIX_ROW_BYTES - 1u - depth))) & 0xFFu;
+#ifndef DRIVERSQL_NO_TEXT
+    if (c->type == COL_TEXT) return (uint8_t)c->data.text_data[row][depth];
 #endif
+    return (unsigned)(radix_key(c, row) >> (8u * (width - 1u - depth))) & 0xFFu;
+}
+
+// Rows in a bucket share their first `depth` key bytes; equal keys order by row id
+static inline bool radix_less(const Column *c, uint32_t a, uint32_t b, unsigned depth) {
 #ifndef DRIVERSQL_NO_TEXT
-static void sort_rows_by_text(const Table *t, int col, uint16_t *rows, size_t n) {
+    if (c->type == COL_TEXT) {
+        int d = depth < MAX_TEXT_LEN ? strncmp(c->data.text_data[a] + depth, c->data.text_data[b] + depth, MAX_TEXT_LEN - depth) : 0;
+        return d < 0 || (d == 0 && a < b);
+    }
+#endif
+    (void)depth;
+    uint64_t ka = radix_key(c, a), kb = radix_key(c, b);
+    return ka < kb || (ka == kb && a < b);
+}
+
+static void insertion_sort_rows(const Column *c, uint32_t *rows, size_t n, unsigned depth) {
     for (size_t i = 1; i < n; ++i) {
-        uint16_t key = rows[i]; const char *vkey = t->columns[col].data.text_data[key]; size_t j = i;
-        while (j > 0) {
-            uint16_t rprev = rows[j-1]; const char *vprev = t->columns[col].data.text_data[rprev];
-            if (strncmp(vprev, vkey, MAX_TEXT_LEN) <= 0) break; rows[j] = rows[j-1]; j--;
-        }
+        uint32_t key = rows[i]; size_t j = i;
+        while (j > 0 && radix_less(c, key, rows[j-1], depth)) { rows[j] = rows[j-1]; j--; }
         rows[j] = key;
     }
 }
-#endif
 
-bool index_build(Table *t, Index *idx, const char *col_name) {
-    int col = column_index(t, col_name); if (col < 0) { idx->active = false; return false; }
-    idx->column_id = col; idx->size = 0; idx->active = true;
-    for (size_t r = 0; r < t->count; ++r) if (!is_deleted(t, r)) idx->rows[idx->size++] = (uint16_t)r;
-    ColumnType ct = t->columns[col].type;
-    if (idx->size == 0) return true;
-    if (ct == COL_INT) sort_rows_by_int(t, col, idx->rows, idx->size);
-#ifndef DRIVERSQL_NO_FLOAT
-    else if (ct == COL_FLOAT) sort_rows_by_float(t, col, idx->rows, idx->size);
+#ifndef DRIVERSQL_NO_TEXT
+static void heap_sift_rows(const Column *c, uint32_t *rows, size_t root, size_t n, unsigned depth) {
+    for (;;) {
+        size_t child = root * 2u + 1u; if (child >= n) return;
+        if (child + 1u < n && radix_less(c, rows[child], rows[child + 1u], depth)) child++;
+        if (!radix_less(c, rows[root], rows[child], depth)) return;
+        uint32_t tmp = rows[root]; rows[root] = rows[child]; rows[child] = tmp; root = child;
+    }
+}
+
+static void heap_sort_rows(const Column *c, uint32_t *rows, size_t n, unsigned depth) {
+    for (size_t i = n / 2u; i-- > 0;) heap_sift_rows(c, rows, i, n, depth);
+    for (size_t end = n; end-- > 1;) { uint32_t tmp = rows[0]; rows[0] = rows[end]; rows[end] = tmp; heap_sift_rows(c, rows, 0, end, depth); }
+}
 #endif
-#ifndef DRIVERSQL_NO_DOUBLE
-    else if (ct == COL_DOUBLE) sort_rows_by_double(t, col, idx->rows, idx->size);
+
+// Permute rows into 256 contiguous buckets by the digit at `depth`; false if all share one digit
+static bool radix_distribute(const Column *c, uint32_t *rows, size_t n, unsigned depth, unsigned width) {
+    uint32_t next[256], end[256];
+    memset(next, 0, sizeof(next));
+    for (size_t i = 0; i < n; ++i) next[radix_digit(c, rows[i], depth, width)]++;
+    uint32_t sum = 0;
+    for (unsigned b = 0; b < 256u; ++b) { uint32_t cnt = next[b]; if (cnt == n) return false; next[b] = sum; sum += cnt; end[b] = sum; }
+    for (unsigned b = 0; b < 256u; ++b) {
+        while (next[b] < end[b]) {
+            uint32_t r = rows[next[b]]; unsigned d = radix_digit(c, r, depth, width);
+            while (d != b) { uint32_t tmp = rows[next[d]]; rows[next[d]++] = r; r = tmp; d = radix_digit(c, r, depth, width); }
+            rows[next[b]++] = r;
+        }
+    }
+    return true;
+}
+
+// A shared NUL byte means every TEXT key in the bucket has ended: go on with the row id
+static inline unsigned radix_next_depth(const Column *c, unsigned d, unsigned depth, unsigned width) {
+#ifndef DRIVERSQL_NO_TEXT
+    if (c->type == COL_TEXT && depth < width && d == 0) return width;
+#else
+    (void)width;
 #endif
+    (void)c; (void)d; return depth + 1u;
+}
+
+static void radix_sort_rows(const Column *c, uint32_t *rows, size_t n, unsigned depth, unsigned width) {
+    while (depth < width + RADIX_ROW_BYTES) {
+        if (n < RADIX_CUTOFF) { insertion_sort_rows(c, rows, n, depth); return; }
 #ifndef DRIVERSQL_NO_TEXT
-    else if (ct == COL_TEXT) sort_rows_by_text(t, col, idx->rows, idx->size);
+        if (c->type == COL_TEXT && depth >= RADIX_TEXT_MAX_DEPTH && depth < width) { heap_sort_rows(c, rows, n, depth); return; }
+#endif
+        if (!radix_distribute(c, rows, n, depth, width)) { depth = radix_next_depth(c, radix_digit(c, rows[0], depth, width), depth, width); continue; }
+        for (size_t i = 0; i < n;) {
+            unsigned d = radix_digit(c, rows[i], depth, width); size_t j = i + 1u;
+            while (j < n && radix_digit(c, rows[j], depth, width) == d) j++;
+            radix_sort_rows(c, rows + i, j - i, radix_next_depth(c, d, depth, width), width);
+            i = j;
+        }
+        return;
+    }
+}
+
+bool index_build(Table *t, Index *idx, const char *col_name) {
+#ifndef DRIVERSQL_NO_STATIC_ROWS
+    return index_build_arena(t, idx, col_name, idx->rows_store, MAX_ROWS);
+#else
+    (void)t; (void)col_name; idx->active = false; return false;
 #endif
-    else { idx->active = false; return false; }
+}
+
+bool index_build_arena(Table *t, Index *idx, const char *col_name, uint32_t *rows, size_t rows_capacity) {
+    int col = column_index(t, col_name); if (col < 0) { idx->active = false; return false; }
+    if (!rows || rows_capacity < t->count - t->free_top) { idx->active = false; return false; }
+    unsigned width = radix_key_bytes(t->columns[col].type);
+    if (width == 0) { idx->active = false; return false; }
+    idx->rows = rows; idx->capacity = rows_capacity;
+    idx->column_id = col; idx->size = 0; idx->active = true; idx->full = false;
+    for (size_t r = 0; r < t->count; ++r) if (!is_deleted(t, r)) idx->rows[idx->size++] = (uint32_t)r;
+    // Unused slots hold a valid row id too, so a reader racing a shared-table insert never
+    // follows garbage
+    memset(idx->rows + idx->size, 0, (rows_capacity - idx->size) * sizeof(idx->rows[0]));
+    radix_sort_rows(&t->columns[col], idx->rows, idx->size, 0, width);
     return true;
 }
 
-void index_drop(Index *idx) { idx->active = false; idx->size = 0; idx->column_id = -1; }
+void index_drop(Index *idx) { idx->active = false; idx->full = false; idx->size = 0; idx->column_id = -1; }
 
-static ssize_t idx_lower_bound_int(const Table *t, int col, const Index *idx, int key) {
-    size_t lo = 0, hi = idx->size; while (lo < hi) { size_t mid = (lo + hi) >> 1; int v = t->columns[col].data.int_data[idx->rows[mid]]; if (v < key) lo = mid + 1; else hi = mid; } return (ssize_t)lo;
+bool index_attach(Table *t, Index *idx) {
+    if (!t || !idx || !idx->active || idx->column_id < 0 || idx->column_id >= t->column_count) return false;
+    for (int i = 0; i < t->index_count; ++i) if (t->indexes[i] == idx) return true;
+    if (t->index_count >= MAX_INDEXES) return false;
+    t->indexes[t->index_count++] = idx;
+    return true;
 }
-#ifndef DRIVERSQL_NO_FLOAT
-static ssize_t idx_lower_bound_float(const Table *t, int col, const Index *idx, float key) {
-    size_t lo = 0, hi = idx->size; while (lo < hi) { size_t mid=(lo+hi)>>1; float v=t->columns[col].data.float_data[idx->rows[mid]]; if (v<key) lo=mid+1; else hi=mid; } return (ssize_t)lo;
+
+void index_detach(Table *t, Index *idx) {
+    if (!t) return;
+    for (int i = 0; i < t->index_count; ++i) {
+        if (t->indexes[i] != idx) continue;
+        t->indexes[i] = t->indexes[--t->index_count]; t->indexes[t->index_count] = NULL; return;
+    }
 }
-#endif
-#ifndef DRIVERSQL_NO_DOUBLE
-static ssize_t idx_lower_bound_double(const Table *t, int col, const Index *idx, double key) {
-    size_t lo = 0, hi = idx->size; while (lo < hi) { size_t mid=(lo+hi)>>1; double v=t->columns[col].data.double_data[idx->rows[mid]]; if (v<key) lo=mid+1; else hi=mid; } return (ssize_t)lo;
+
+static const Index *attached_index(const Table *t, int col) {
+    for (int i = 0; i < t->index_count; ++i) if (t->indexes[i]->active && t->indexes[i]->column_id == col) return t->indexes[i];
+    return NULL;
 }
-#endif
+
+// Three-way compare of two cells of the same column, in the order index_build sorts them
+static int cell_cmp(const Column *c, size_t a, size_t b) {
 #ifndef DRIVERSQL_NO_TEXT
-static ssize_t idx_lower_bound_text(const Table *t, int col, const Index *idx, const char *key) {
-    size_t lo=0, hi=idx->size; while (lo<hi){ size_t mid=(lo+hi)>>1; const char *v=t->columns[col].data.text_data[idx->rows[mid]]; if (strncmp(v,key,MAX_TEXT_LEN)<0) lo=mid+1; else hi=mid;} return (ssize_t)lo;
-}
+    if (c->type == COL_TEXT) return strncmp(c->data.text_data[a], c->data.text_data[b], MAX_TEXT_LEN);
 #endif
+    uint64_t ka = radix_key(c, (uint32_t)a), kb = radix_key(c, (uint32_t)b);
+    return (ka > kb) - (ka < kb);
+}
 
-IndexStatus index_select_eq(const Table *t, const Index *idx, const void *value, row_callback cb, void *user) {
-    if (!idx || !idx->active) return IDX_EMPTY; int col = idx->column_id; ColumnType ct = t->columns[col].type;
-    if (ct == COL_INT) {
-        int key = *(const int *)value; ssize_t pos = idx_lower_bound_int(t, col, idx, key); if ((size_t)pos >= idx->size) return IDX_OK;
-        for (size_t i = (size_t)pos; i < idx->size; ++i) { int v = t->columns[col].data.int_data[idx->rows[i]]; if (v != key) break; cb(t, idx->rows[i], user); }
-        return IDX_OK;
+// First position whose (value, row id) is >= that of `row`
+static size_t idx_bound_row(const Table *t, const Index *idx, size_t row) {
+    const Column *c = &t->columns[idx->column_id];
+    size_t lo = 0, hi = idx->size;
+    while (lo < hi) {
+        size_t mid = (lo + hi) >> 1; uint32_t r = idx->rows[mid];
+        int d = cell_cmp(c, r, row); if (d == 0) d = (r > row) - (r < row);
+        if (d < 0) lo = mid + 1; else hi = mid;
     }
-#ifndef DRIVERSQL_NO_FLOAT
-    else if (ct == COL_FLOAT) {
-        float key = *(const float *)value; ssize_t pos = idx_lower_bound_float(t, col, idx, key); if ((size_t)pos >= idx->size) return IDX_OK;
-        for (size_t i = (size_t)pos; i < idx->size; ++i) { float v = t->columns[col].data.float_data[idx->rows[i]]; if (v != key) break; cb(t, idx->rows[i], user); }
-        return IDX_OK;
+    return lo;
+}
+
+// O(log n) position search plus a block move; appends in key order move nothing. An index
+// with no room left deactivates and flags itself full (queries fall back to scans).
+static void index_on_insert(Table *t, size_t row) {
+    for (int i = 0; i < t->index_count; ++i) {
+        Index *idx = t->indexes[i]; if (!idx->active) continue;
+        if (idx->size >= idx->capacity) { idx->active = false; idx->full = true; continue; }
+        size_t pos = idx_bound_row(t, idx, row);
+        memmove(&idx->rows[pos + 1], &idx->rows[pos], (idx->size - pos) * sizeof(idx->rows[0]));
+        idx->rows[pos] = (uint32_t)row; idx->size++;
+    }
+}
+
+// Entries are unique (value, row id) pairs, so one binary search finds the exact entry
+static void index_on_delete(Table *t, size_t row) {
+    for (int i = 0; i < t->index_count; ++i) {
+        Index *idx = t->indexes[i]; if (!idx->active) continue;
+        size_t pos = idx_bound_row(t, idx, row);
+        if (pos == idx->size || idx->rows[pos] != (uint32_t)row) continue;
+        memmove(&idx->rows[pos], &idx->rows[pos + 1], (idx->size - pos - 1) * sizeof(idx->rows[0]));
+        idx->size--;
     }
+}
+
+// Three-way compare of a cell against a key of the column's type
+static int cell_key_cmp(const Column *c, size_t r, const void *key) {
+    switch (c->type) {
+        case COL_INT: { int a = c->data.int_data[r], b = *(const int *)key; return (a > b) - (a < b); }
+#ifndef DRIVERSQL_NO_FLOAT
+        case COL_FLOAT: { float a = c->data.float_data[r], b = *(const float *)key; return (a > b) - (a < b); }
 #endif
 #ifndef DRIVERSQL_NO_DOUBLE
-    else if (ct == COL_DOUBLE) {
-        double key = *(const double *)value; ssize_t pos = idx_lower_bound_double(t, col, idx, key); if ((size_t)pos >= idx->size) return IDX_OK;
-        for (size_t i = (size_t)pos; i < idx->size; ++i) { double v = t->columns[col].data.double_data[idx->rows[i]]; if (v != key) break; cb(t, idx->rows[i], user); }
-        return IDX_OK;
-    }
+        case COL_DOUBLE: { double a = c->data.double_data[r], b = *(const double *)key; return (a > b) - (a < b); }
 #endif
 #ifndef DRIVERSQL_NO_TEXT
-    else if (ct == COL_TEXT) {
-        const char *key = (const char *)value; ssize_t pos = idx_lower_bound_text(t, col, idx, key); if ((size_t)pos >= idx->size) return IDX_OK;
-        for (size_t i = (size_t)pos; i < idx->size; ++i) { const char *v = t->columns[col].data.text_data[idx->rows[i]]; if (strncmp(v, key, MAX_TEXT_LEN) != 0) break; cb(t, idx->rows[i], user); }
-        return IDX_OK;
+        case COL_TEXT: return strncmp(c->data.text_data[r], (const char *)key, MAX_TEXT_LEN);
+#endif
+        default: return 0;
     }
+}
+
+// First position whose value is > (upper) or >= (!upper) key
+static size_t idx_bound_key(const Table *t, const Index *idx, const void *key, bool upper) {
+    const Column *c = &t->columns[idx->column_id];
+    size_t lo = 0, hi = idx->size;
+    while (lo < hi) { size_t mid = (lo + hi) >> 1; int d = cell_key_cmp(c, idx->rows[mid], key); if (d < 0 || (upper && d == 0)) lo = mid + 1; else hi = mid; }
+    return lo;
+}
+
+// Positions [lo, hi) of idx->rows matching `op value`; false if the index cannot answer op
+static bool idx_range(const Table *t, const Index *idx, Op op, const void *value, size_t *lo, size_t *hi) {
+    const Column *c = &t->columns[idx->column_id];
+#ifndef DRIVERSQL_NO_TEXT
+    if (c->type == COL_TEXT && op != OP_EQ) return false;
 #endif
-    return IDX_UNSUPPORTED;
+    switch (op) {
+        case OP_EQ:  *lo = idx_bound_key(t, idx, value, false); *hi = idx_bound_key(t, idx, value, true); return true;
+        case OP_GT:  *lo = idx_bound_key(t, idx, value, true); *hi = idx->size; return true;
+        case OP_GTE: *lo = idx_bound_key(t, idx, value, false); *hi = idx->size; return true;
+        case OP_LT:  *lo = 0; *hi = idx_bound_key(t, idx, value, false); return true;
+        case OP_LTE: *lo = 0; *hi = idx_bound_key(t, idx, value, true); return true;
+        case OP_BETWEEN:
+            *lo = idx_bound_key(t, idx, value, false);
+            *hi = idx_bound_key(t, idx, (const char *)value + cell_bytes(c->type), true);
+            if (*hi < *lo) *hi = *lo;
+            return true;
+        default: return false; // OP_NE is two ranges; scanned instead
+    }
+}
+
+IndexStatus index_select_eq(const Table *t, const Index *idx, const void *value, row_callback cb, void *user) {
+    return index_select_op(t, idx, OP_EQ, value, cb, user);
 }
 
 IndexStatus index_select_op(const Table *t, const Index *idx, Op op, const void *value, row_callback cb, void *user) {
-    if (!idx || !idx->active) return IDX_EMPTY; int col = idx->column_id; ColumnType ct = t->columns[col].type;
-    if (ct == COL_INT) {
-        int key = *(const int *)value; size_t start = (size_t)idx_lower_bound_int(t, col, idx, key);
-        if (op == OP_EQ) { for (size_t i = start; i < idx->size; ++i) { int v=t->columns[col].data.int_data[idx->rows[i]]; if (v!=key) break; cb(t, idx->rows[i], user);} return IDX_OK; }
-        if (op == OP_LT) { for (size_t i = 0; i < start; ++i) cb(t, idx->rows[i], user); return IDX_OK; }
-        size_t s = (op == OP_GT) ? (start + (start < idx->size && t->columns[col].data.int_data[idx->rows[start]] == key)) : start;
-        for (size_t i = s; i < idx->size; ++i) cb(t, idx->rows[i], user);
-        return IDX_OK;
-    }
-#ifndef DRIVERSQL_NO_FLOAT
-    else if (ct == COL_FLOAT) {
-        float key = *(const float *)value; size_t start = (size_t)idx_lower_bound_float(t, col, idx, key);
-        if (op == OP_EQ) { for (size_t i = start; i < idx->size; ++i) { float v=t->columns[col].data.float_data[idx->rows[i]]; if (v!=key) break; cb(t, idx->rows[i], user);} return IDX_OK; }
-        if (op == OP_LT) { for (size_t i = 0; i < start; ++i) cb(t, idx->rows[i], user); return IDX_OK; }
-        size_t s = (op == OP_GT) ? (start + (start < idx->size && t->columns[col].data.float_data[idx->rows[start]] == key)) : start;
-        for (size_t i = s; i < idx->size; ++i) cb(t, idx->rows[i], user);
-        return IDX_OK;
+    if (!idx || !idx->active) return idx && idx->full ? IDX_FULL : IDX_EMPTY;
+    size_t lo, hi; if (!idx_range(t, idx, op, value, &lo, &hi)) return IDX_UNSUPPORTED;
+    for (size_t i = lo; i < hi; ++i) cb(t, idx->rows[i], user);
+    return IDX_OK;
+}
+
+// Selection vectors: matches are written as row ids into a caller buffer, a chunk per call.
+// Access path (pk hash, attached index, word scan) mirrors select_where_eq/select_where_op.
+enum { SEL_FRESH = 0, SEL_PK, SEL_INDEX, SEL_SCAN, SEL_DONE };
+
+static DSStatus resolve_predicate(const Table *t, const Predicate *p, int *col_out) {
+    if (!t || !p || !p->col_name || !p->value) return DS_ERR_INVALID;
+    int col = column_index(t, p->col_name); if (col < 0) return DS_ERR_NOT_FOUND;
+    if (!type_enabled(t->columns[col].type)) return DS_ERR_UNSUPPORTED;
+    *col_out = col; return DS_OK;
+}
+
+// Rough selectivity rank: = before BETWEEN before one-sided ranges before <>
+static unsigned op_rank(Op op) { return op == OP_EQ ? 0u : op == OP_BETWEEN ? 1u : op == OP_NE ? 3u : 2u; }
+
+// Resolve columns and order predicates for evaluation, most selective first, so the
+// running bitmap empties as early as possible
+static DSStatus plan_predicates(const Table *t, const Predicate *preds, size_t npreds, int *cols, uint8_t *order) {
+    if (!t || !preds || npreds == 0 || npreds > MAX_PREDICATES) return DS_ERR_INVALID;
+    size_t k = 0;
+    for (size_t i = 0; i < npreds; ++i) { DSStatus st = resolve_predicate(t, &preds[i], &cols[i]); if (st != DS_OK) return st; }
+    for (unsigned rank = 0; rank < 4u; ++rank)
+        for (size_t i = 0; i < npreds; ++i) if (op_rank(preds[i].op) == rank) order[k++] = (uint8_t)i;
+    return DS_OK;
+}
+
+// Pick the driving access path: a pk equality (1 row), else the attached index whose range,
+// intersected over every predicate on its column, is narrowest. `covered` marks predicates
+// the driver already guarantees; the rest are checked per candidate row.
+static void plan_driver(const Table *t, const Predicate *preds, size_t npreds, const int *cols, SelectCursor *cur) {
+    size_t best = (size_t)-1;
+    cur->state = SEL_SCAN; cur->pos = 0; cur->covered = 0;
+    for (size_t i = 0; i < npreds; ++i) {
+        if (preds[i].op == OP_EQ && cols[i] == 0 && t->columns[0].type == COL_INT && has_pk(t)) { cur->state = SEL_PK; cur->driver = (uint8_t)i; cur->covered = 1u << i; return; }
     }
-#endif
-#ifndef DRIVERSQL_NO_DOUBLE
-    else if (ct == COL_DOUBLE) {
-        double key = *(const double *)value; size_t start = (size_t)idx_lower_bound_double(t, col, idx, key);
-        if (op == OP_EQ) { for (size_t i = start; i < idx->size; ++i) { double v=t->columns[col].data.double_data[idx->rows[i]]; if (v!=key) break; cb(t, idx->rows[i], user);} return IDX_OK; }
-        if (op == OP_LT) { for (size_t i = 0; i < start; ++i) cb(t, idx->rows[i], user); return IDX_OK; }
-        size_t s = (op == OP_GT) ? (start + (start < idx->size && t->columns[col].data.double_data[idx->rows[start]] == key)) : start;
-        for (size_t i = s; i < idx->size; ++i) cb(t, idx->rows[i], user);
-        return IDX_OK;
+    for (size_t i = 0; i < npreds; ++i) {
+        const Index *live = attached_index(t, cols[i]); size_t lo, hi;
+        if (!live || !idx_range(t, live, preds[i].op, preds[i].value, &lo, &hi)) continue;
+        uint32_t covered = 1u << i;
+        for (size_t j = i + 1; j < npreds; ++j) {
+            size_t l2, h2;
+            if (cols[j] != cols[i] || !idx_range(t, live, preds[j].op, preds[j].value, &l2, &h2)) continue;
+            if (l2 > lo) lo = l2;
+            if (h2 < hi) hi = h2;
+            covered |= 1u << j;
+        }
+        if (hi < lo) hi = lo;
+        if (hi - lo >= best) continue;
+        best = hi - lo; cur->state = SEL_INDEX; cur->index = live; cur->pos = lo; cur->end = hi; cur->covered = covered;
     }
-#endif
-#ifndef DRIVERSQL_NO_TEXT
-    else if (ct == COL_TEXT) {
-        if (op != OP_EQ) return IDX_UNSUPPORTED; return index_select_eq(t, idx, value, cb, user);
+}
+
+static bool row_matches_rest(const Table *t, const Predicate *preds, size_t npreds, const int *cols, const uint8_t *order, uint32_t covered, size_t r) {
+    for (size_t k = 0; k < npreds; ++k) {
+        size_t i = order[k]; if (covered & (1u << i)) continue;
+        if (!scan_cell_matches(&t->columns[cols[i]], r, preds[i].op, preds[i].value)) return false;
     }
-#endif
-    return IDX_UNSUPPORTED;
+    return true;
 }
 
-bool agg_min_int(const Table *t, const char *col_name, int *out) {
-    if (!t || !col_name || !out) return false; int idx = column_index(t, col_name); if (idx < 0) return false;
-    const Column *c = &t->columns[idx]; if (c->type != COL_INT) return false; bool any=false; int minv=0;
-    for (size_t r=0; r<t->count; ++r) { if (is_deleted(t,r)) continue; int v=c->data.int_data[r]; if (!any || v<minv) { minv=v; any=true; } }
-    if (!any) return false; *out=minv; return true;
+void select_cursor_init(SelectCursor *cur) { if (cur) memset(cur, 0, sizeof(*cur)); }
+
+DSStatus select_into_all(const Table *t, const Predicate *preds, size_t npreds, uint32_t *row_ids, size_t cap, SelectCursor *cur, size_t *count_out) {
+    if (!row_ids || !cur || !count_out) return DS_ERR_INVALID;
+    *count_out = 0;
+    int cols[MAX_PREDICATES]; uint8_t order[MAX_PREDICATES];
+    DSStatus st = plan_predicates(t, preds, npreds, cols, order); if (st != DS_OK) return st;
+    if (cur->state == SEL_FRESH) plan_driver(t, preds, npreds, cols, cur);
+    size_t n = 0;
+    switch (cur->state) {
+        case SEL_PK: {
+            if (cap == 0) return DS_OK;
+            size_t row;
+            if (pk_hash_find(t, *(const int *)preds[cur->driver].value, &row) && row_matches_rest(t, preds, npreds, cols, order, cur->covered, row)) row_ids[n++] = (uint32_t)row;
+            cur->state = SEL_DONE; break;
+        }
+        case SEL_INDEX: {
+            const Index *idx = cur->index;
+            if (cur->covered == (uint32_t)((1ULL << npreds) - 1u)) {
+                n = cur->end - cur->pos < cap ? cur->end - cur->pos : cap;
+                memcpy(row_ids, &idx->rows[cur->pos], n * sizeof(row_ids[0])); cur->pos += n;
+            } else {
+                for (; cur->pos < cur->end && n < cap; ++cur->pos) {
+                    uint32_t r = idx->rows[cur->pos];
+                    if (row_matches_rest(t, preds, npreds, cols, order, cur->covered, r)) row_ids[n++] = r;
+                }
+            }
+            if (cur->pos >= cur->end) cur->state = SEL_DONE;
+            break;
+        }
+        case SEL_SCAN: {
+            size_t r = cur->pos, count = t->count;
+            while (r < count && n < cap) {
+                size_t base = r & ~(size_t)(DODA_SCAN_WORD - 1u), len = count - base < DODA_SCAN_WORD ? count - base : DODA_SCAN_WORD;
+                uint64_t m = ~t->deleted_bits[base / 64u] & scan_tail_mask(base, count) & (~0ULL << (r - base));
+                for (size_t k = 0; k < npreds && m; ++k) m &= scan_column_word(&t->columns[cols[order[k]]], base, len, preds[order[k]].op, preds[order[k]].value);
+                while (m && n < cap) { row_ids[n++] = (uint32_t)(base + scan_ctz64(m)); m &= m - 1u; }
+                r = m ? base + scan_ctz64(m) : base + DODA_SCAN_WORD;
+            }
+            cur->pos = r;
+            if (r >= count) cur->state = SEL_DONE;
+            break;
+        }
+        default: break;
+    }
+    *count_out = n;
+    return DS_OK;
 }
 
-bool agg_max_int(const Table *t, const char *col_name, int *out) {
-    if (!t || !col_name || !out) return false; int idx = column_index(t, col_name); if (idx < 0) return false;
-    const Column *c = &t->columns[idx]; if (c->type != COL_INT) return false; bool any=false; int maxv=0;
-    for (size_t r=0; r<t->count; ++r) { if (is_deleted(t,r)) continue; int v=c->data.int_data[r]; if (!any || v>maxv) { maxv=v; any=true; } }
-    if (!any) return false; *out=maxv; return true;
+DSStatus select_into(const Table *t, const Predicate *p, uint32_t *row_ids, size_t cap, SelectCursor *cur, size_t *count_out) {
+    return select_into_all(t, p, 1, row_ids, cap, cur, count_out);
 }
 
-bool agg_avg_int(const Table *t, const char *col_name, double *out) {
-    if (!t || !col_name || !out) return false; int idx = column_index(t, col_name); if (idx < 0) return false;
-    const Column *c = &t->columns[idx]; if (c->type != COL_INT) return false; size_t n=0; long long sum=0;
-    for (size_t r=0; r<t->count; ++r) { if (is_deleted(t,r)) continue; sum += (long long)c->data.int_data[r]; n++; }
-    if (n==0) return false; *out = (double)sum / (double)n; return true;
+#define SELECT_CHUNK 64u
+
+DSStatus select_where_all(const Table *t, const Predicate *preds, size_t npreds, row_callback cb, void *user) {
+    if (!cb) return DS_ERR_INVALID;
+    uint32_t rows[SELECT_CHUNK]; SelectCursor cur; select_cursor_init(&cur);
+    size_t n; DSStatus st;
+    while ((st = select_into_all(t, preds, npreds, rows, SELECT_CHUNK, &cur, &n)) == DS_OK && n > 0)
+        for (size_t i = 0; i < n; ++i) cb(t, rows[i], user);
+    return st;
 }
 
-size_t agg_count(const Table *t) { if (!t) return 0; size_t n=0; for (size_t r=0; r<t->count; ++r) if (!is_deleted(t,r)) n++; return n; }
\ No newline at end of file
+DSStatus select_filter(const Table *t, const Predicate *p, uint32_t *row_ids, size_t *count) {
+    if (!row_ids || !count) return DS_ERR_INVALID;
+    int col; DSStatus st = resolve_predicate(t, p, &col); if (st != DS_OK) return st;
+    const Column *c = &t->columns[col];
+    size_t k = 0;
+    for (size_t i = 0; i < *count; ++i) {
+        uint32_t r = row_ids[i];
+        if (r < t->count && !is_deleted(t, r) && scan_cell_matches(c, r, p->op, p->value)) row_ids[k++] = r;
+    }
+    *count = k;
+    return DS_OK;
+}
@@ -27,15 +27,25 @@
 #ifndef DRIVERSQL_HASH_SIZE
 #define DRIVERSQL_HASH_SIZE 512
 #endif
+#ifndef DRIVERSQL_MAX_INDEXES
+#define DRIVERSQL_MAX_INDEXES 4
+#endif
+#ifndef DRIVERSQL_MAX_PREDICATES
+#define DRIVERSQL_MAX_PREDICATES 8 // <= 32
+#endif
 
 #define MAX_COLUMNS DRIVERSQL_MAX_COLUMNS
 #define MAX_NAME_LEN DRIVERSQL_MAX_NAME_LEN
 #define MAX_TEXT_LEN DRIVERSQL_MAX_TEXT_LEN
 #define MAX_ROWS DRIVERSQL_MAX_ROWS
 #define HASH_SIZE DRIVERSQL_HASH_SIZE
+#define MAX_INDEXES DRIVERSQL_MAX_INDEXES
+#define MAX_PREDICATES DRIVERSQL_MAX_PREDICATES
 
 // Feature gates
 // DRIVERSQL_NO_TEXT, DRIVERSQL_NO_FLOAT, DRIVERSQL_NO_DOUBLE, DRIVERSQL_NO_POINTER_COLUMN, DRIVERSQL_NO_STDIO
+// DRIVERSQL_NO_STATIC_ROWS: drop the MAX_ROWS storage embedded in Table/Index (arena tables only)
+// DRIVERSQL_NO_ZONE_MAPS: no per-block min/max summaries (scans visit every live block)
 
 typedef enum {
     COL_INT = 0,
@@ -54,49 +64,102 @@ typedef enum {
 #endif
 } ColumnType;
 
+// Backing arrays for one column of a fixed-capacity table (init_table).
+// Arena tables (init_table_arena) never use this; their columns are laid out
+// densely at the width of their actual type.
+typedef union {
+    int int_data[MAX_ROWS];
+#ifndef DRIVERSQL_NO_TEXT
+    char text_data[MAX_ROWS][MAX_TEXT_LEN];
+#endif
+    uint8_t bool_data[MAX_ROWS];
+#ifndef DRIVERSQL_NO_FLOAT
+    float float_data[MAX_ROWS];
+#endif
+#ifndef DRIVERSQL_NO_DOUBLE
+    double double_data[MAX_ROWS];
+#endif
+#ifndef DRIVERSQL_NO_POINTER_COLUMN
+    void *ptr_data[MAX_ROWS];
+#endif
+} ColumnStorage;
+
 typedef struct Column {
     char name[MAX_NAME_LEN];
     ColumnType type;
+    // Dense array of `capacity` cells of this column's type
     union {
-        int int_data[MAX_ROWS];
+        int *int_data;
 #ifndef DRIVERSQL_NO_TEXT
-        char text_data[MAX_ROWS][MAX_TEXT_LEN];
+        char (*text_data)[MAX_TEXT_LEN];
 #endif
-        uint8_t bool_data[MAX_ROWS];
+        uint8_t *bool_data;
 #ifndef DRIVERSQL_NO_FLOAT
-        float float_data[MAX_ROWS];
+        float *float_data;
 #endif
 #ifndef DRIVERSQL_NO_DOUBLE
-        double double_data[MAX_ROWS];
+        double *double_data;
 #endif
 #ifndef DRIVERSQL_NO_POINTER_COLUMN
-        void *ptr_data[MAX_ROWS];
+        void **ptr_data;
 #endif
     } data;
+    // Zone map of INT/FLOAT/DOUBLE columns: {min, max} per 64-row block (one deleted_bits
+    // word), widened on insert and reset when a block empties; NULL when not kept
+    double *zone;
 } Column;
 
+struct Index;
+
+// Row ids are 32-bit; pk_hash slots hold row + 1 (0 = empty).
+// Column/bookkeeping pointers refer either to `store` (init_table) or to the
+// caller's arena (init_table_arena), so a Table must not be copied by value.
 typedef struct Table {
     char name[MAX_NAME_LEN];
     int column_count;
     Column columns[MAX_COLUMNS];
     size_t capacity;
     size_t count;
-    uint64_t deleted_bits[(MAX_ROWS + 63) / 64];
-    uint16_t free_list[MAX_ROWS];
+    uint64_t *deleted_bits;
+    uint64_t *dirty_bits;   // one bit per 64-row block changed since table_clear_dirty()
+    uint32_t *free_list;
     size_t free_top;
-    uint16_t pk_hash[HASH_SIZE];
+    uint32_t *pk_hash;
+    size_t hash_size;       // active slots (power of two), grows with pk_count
+    size_t hash_capacity;   // slots available in pk_hash
+    size_t pk_count;        // keys currently in pk_hash
+    struct Index *indexes[MAX_INDEXES]; // attached indexes, kept sorted on insert/delete
+    int index_count;
+#ifndef DRIVERSQL_NO_STATIC_ROWS
+    struct {
+        ColumnStorage columns[MAX_COLUMNS];
+        uint64_t deleted_bits[(MAX_ROWS + 63) / 64];
+        uint64_t dirty_bits[((MAX_ROWS + 63) / 64 + 63) / 64];
+        uint32_t free_list[MAX_ROWS];
+        uint32_t pk_hash[HASH_SIZE];
+#ifndef DRIVERSQL_NO_ZONE_MAPS
+        double zones[MAX_COLUMNS][((MAX_ROWS + 63) / 64) * 2];
+#endif
+    } store;
+#endif
 } Table;
 
-typedef struct {
+typedef struct Index {
     int column_id;
-    uint16_t rows[MAX_ROWS];
+    uint32_t *rows;
     size_t size;
+    size_t capacity;
     bool active;
+    bool full;              // deactivated because an insert found no room left; rebuild to reuse
+#ifndef DRIVERSQL_NO_STATIC_ROWS
+    uint32_t rows_store[MAX_ROWS];
+#endif
 } Index;
 
 typedef void (*row_callback)(const struct Table *t, size_t row, void *user);
 
-typedef enum { OP_EQ = 0, OP_GT, OP_LT, OP_GTE } Op;
+// OP_BETWEEN is inclusive on both ends; its value points at two consecutive keys {lo, hi}
+typedef enum { OP_EQ = 0, OP_GT, OP_LT, OP_GTE, OP_LTE, OP_NE, OP_BETWEEN } Op;
 
 typedef enum {
     DS_OK = 0,
@@ -108,33 +171,91 @@ typedef enum {
 
 // Core API
 void init_table(Table *t, const char *name, int column_count, const char **col_names, const ColumnType *col_types);
+// Runtime-sized table: columns, free list, deleted bits and pk hash are carved out of the
+// caller's arena (at least table_arena_bytes() bytes) for row_capacity rows.
+// table_arena_bytes() returns 0 for a bad schema or a capacity whose size would overflow size_t.
+// An arena table only touches the first table_header_bytes() of its Table (not the static
+// `store`), so its header may live in caller memory of that size, 8-byte aligned.
+size_t table_header_bytes(void);
+size_t table_arena_bytes(int column_count, const ColumnType *col_types, size_t row_capacity);
+DSStatus init_table_arena(Table *t, const char *name, int column_count, const char **col_names, const ColumnType *col_types, void *arena, size_t arena_bytes, size_t row_capacity);
 DSStatus insert_row_int_text_int(Table *t, int v0, const char *v1, int v2);
 DSStatus insert_row(Table *t, const void *values[]);
+// Bulk append of n rows given column by column: columns[i] points at n cells of column i
+// (INT int, FLOAT float, DOUBLE double, BOOL uint8_t, TEXT const char *, POINTER void *).
+// The schema is checked once and fixed-width columns are copied with one memcpy each.
+// Rows whose primary key is already present (in the table or earlier in the batch) are
+// skipped and flagged in failed[(n + 63) / 64] (optional); so are rows left over when the
+// table fills, which also makes the result DS_ERR_FULL. *inserted_out counts the new rows.
+DSStatus insert_columns(Table *t, size_t n, const void *columns[], uint64_t *failed, size_t *inserted_out);
 DSStatus select_where_eq(const Table *t, const char *col_name, const void *eq_value, row_callback cb, void *user);
 DSStatus select_where_op(const Table *t, const char *col_name, Op op, const void *value, row_callback cb, void *user);
 DSStatus delete_where_eq(Table *t, const char *col_name, const void *eq_value, size_t *deleted_out);
+DSStatus delete_row(Table *t, size_t row);
 void free_table(Table *t);
+// Drop every row, keeping schema, storage and attached indexes (emptied); O(rows / 64), not per row
+void table_clear(Table *t);
+// Dirty tracking for incremental snapshots: inserts, deletes, restores and table_clear mark
+// the 64-row blocks they touch (writes straight into column arrays are not seen)
+bool table_block_dirty(const Table *t, size_t block);
+void table_clear_dirty(Table *t);
+// Restore path of persistence: write a live row at a fixed row id. Rows skipped past the old
+// count become free slots; a live row at `row`, or one elsewhere with the same primary key
+// (it moved in the saved table), is deleted first.
+DSStatus restore_row(Table *t, size_t row, const void *values[]);
+// Bulk load: the caller filled the column arrays and deleted_bits for rows [0, count) of an
+// empty table. Rebuilds the free list, primary-key hash (sized once), zone maps and attached
+// indexes in one pass each. DS_ERR_UNSUPPORTED on a duplicate primary key. An attached index
+// too small for the live rows deactivates and sets `full`, as it would on insert.
+DSStatus table_adopt_rows(Table *t, size_t count);
 
 int column_index(const Table *t, const char *col_name);
 bool is_deleted(const Table *t, size_t row);
+
+// Primary-key hash diagnostics (probe length 1 = key sits in its home slot)
+typedef struct { size_t keys; size_t slots; size_t max_probe; size_t total_probe; } PkHashStats;
+void pk_hash_stats(const Table *t, PkHashStats *out);
 #ifndef DRIVERSQL_NO_STDIO
 void print_row(const Table *t, size_t r);
 #endif
 
 bool index_build(Table *t, Index *idx, const char *col_name);
+// Same as index_build, but row ids go to a caller buffer (required for tables larger than MAX_ROWS)
+bool index_build_arena(Table *t, Index *idx, const char *col_name, uint32_t *rows, size_t rows_capacity);
 void index_drop(Index *idx);
-typedef enum { IDX_OK = 0, IDX_UNSUPPORTED, IDX_EMPTY } IndexStatus;
+// Attach a built index so insert_row/delete paths keep it sorted and select_where_* use it.
+// The Index must outlive the attachment. Entries are kept in (key, row id) order. An index
+// that runs out of row capacity deactivates and sets `full`; its selects return IDX_FULL.
+bool index_attach(Table *t, Index *idx);
+void index_detach(Table *t, Index *idx);
+typedef enum { IDX_OK = 0, IDX_UNSUPPORTED, IDX_EMPTY, IDX_FULL } IndexStatus;
 IndexStatus index_select_eq(const Table *t, const Index *idx, const void *value, row_callback cb, void *user);
 IndexStatus index_select_op(const Table *t, const Index *idx, Op op, const void *value, row_callback cb, void *user);
 
+// Selection vectors: fill a caller-owned row-id buffer in chunks instead of one callback per row.
+// Call select_into until it reports 0 rows; the cursor is only valid while the table is not modified.
+// Row order follows the access path: key order via an attached index, row order for scans.
+typedef struct { const char *col_name; Op op; const void *value; } Predicate;
+typedef struct { size_t pos; size_t end; const Index *index; uint32_t covered; uint8_t state; uint8_t driver; } SelectCursor;
+void select_cursor_init(SelectCursor *cur);
+DSStatus select_into(const Table *t, const Predicate *p, uint32_t *row_ids, size_t cap, SelectCursor *cur, size_t *count_out);
+// Conjunction of 1..MAX_PREDICATES predicates (AND). The pk hash or the attached index with the
+// narrowest range drives when available; otherwise one scan ANDs per-predicate 64-row bitmaps.
+DSStatus select_into_all(const Table *t, const Predicate *preds, size_t npreds, uint32_t *row_ids, size_t cap, SelectCursor *cur, size_t *count_out);
+DSStatus select_where_all(const Table *t, const Predicate *preds, size_t npreds, row_callback cb, void *user);
+// Keep only the live rows of row_ids[0..*count) that satisfy p (in place, order preserved)
+DSStatus select_filter(const Table *t, const Predicate *p, uint32_t *row_ids, size_t *count);
+
 // DODA renamed types (backward-compatible typedefs)
 typedef ColumnType DodaColumnType;
 typedef Table DodaTable;
 typedef Index DodaIndex;
+typedef Predicate DodaPredicate;
+typedef SelectCursor DodaSelectCursor;
 
 typedef void (*doda_row_callback)(const DodaTable *t, size_t row, void *user);
 
-typedef enum { DodaOp_EQ = OP_EQ, DodaOp_GT = OP_GT, DodaOp_LT = OP_LT, DodaOp_GTE = OP_GTE } DodaOp;
+typedef enum { DodaOp_EQ = OP_EQ, DodaOp_GT = OP_GT, DodaOp_LT = OP_LT, DodaOp_GTE = OP_GTE, DodaOp_LTE = OP_LTE, DodaOp_NE = OP_NE, DodaOp_BETWEEN = OP_BETWEEN } DodaOp;
 
 typedef enum {
     DodaStatus_OK = DS_OK,
@@ -146,12 +267,22 @@ typedef enum {
 
 // DODA API aliases
 static inline void doda_init_table(DodaTable *t, const char *name, int column_count, const char **col_names, const DodaColumnType *col_types) { init_table((Table*)t, name, column_count, col_names, (const ColumnType*)col_types); }
+static inline size_t doda_table_arena_bytes(int column_count, const DodaColumnType *col_types, size_t row_capacity) { return table_arena_bytes(column_count, (const ColumnType*)col_types, row_capacity); }
+static inline size_t doda_table_header_bytes(void) { return table_header_bytes(); }
+static inline DodaStatus doda_table_init_arena(DodaTable *t, const char *name, int column_count, const char **col_names, const DodaColumnType *col_types, void *arena, size_t arena_bytes, size_t row_capacity) { return (DodaStatus)init_table_arena((Table*)t, name, column_count, col_names, (const ColumnType*)col_types, arena, arena_bytes, row_capacity); }
 static inline DodaStatus doda_insert_row_int_text_int(DodaTable *t, int v0, const char *v1, int v2) { return (DodaStatus)insert_row_int_text_int((Table*)t, v0, v1, v2); }
 static inline DodaStatus doda_insert_row(DodaTable *t, const void *values[]) { return (DodaStatus)insert_row((Table*)t, values); }
+static inline DodaStatus doda_insert_columns(DodaTable *t, size_t n, const void *column_arrays[], uint64_t *failed_bits, size_t *inserted_out) { return (DodaStatus)insert_columns((Table*)t, n, column_arrays, failed_bits, inserted_out); }
 static inline DodaStatus doda_select_where_eq(const DodaTable *t, const char *col_name, const void *eq_value, doda_row_callback cb, void *user) { return (DodaStatus)select_where_eq((const Table*)t, col_name, eq_value, (row_callback)cb, user); }
 static inline DodaStatus doda_select_where_op(const DodaTable *t, const char *col_name, DodaOp op, const void *value, doda_row_callback cb, void *user) { return (DodaStatus)select_where_op((const Table*)t, col_name, (Op)op, value, (row_callback)cb, user); }
 static inline DodaStatus doda_delete_where_eq(DodaTable *t, const char *col_name, const void *eq_value, size_t *deleted_out) { return (DodaStatus)delete_where_eq((Table*)t, col_name, eq_value, deleted_out); }
+static inline DodaStatus doda_delete_row(DodaTable *t, size_t row) { return (DodaStatus)delete_row((Table*)t, row); }
 static inline void doda_free_table(DodaTable *t) { free_table((Table*)t); }
+static inline void doda_table_clear(DodaTable *t) { table_clear((Table*)t); }
+static inline bool doda_table_block_dirty(const DodaTable *t, size_t block) { return table_block_dirty((const Table*)t, block); }
+static inline void doda_table_clear_dirty(DodaTable *t) { table_clear_dirty((Table*)t); }
+static inline DodaStatus doda_restore_row(DodaTable *t, size_t row, const void *values[]) { return (DodaStatus)restore_row((Table*)t, row, values); }
+static inline DodaStatus doda_table_adopt_rows(DodaTable *t, size_t count) { return (DodaStatus)table_adopt_rows((Table*)t, count); }
 
 static inline int doda_column_index(const DodaTable *t, const char *col_name) { return column_index((const Table*)t, col_name); }
 static inline bool doda_is_deleted(const DodaTable *t, size_t row) { return is_deleted((const Table*)t, row); }
@@ -160,7 +291,15 @@ static inline void doda_print_row(const DodaTable *t, size_t r) { print_row((con
 #endif
 
 static inline bool doda_index_build(DodaTable *t, DodaIndex *idx, const char *col_name) { return index_build((Table*)t, (Index*)idx, col_name); }
+static inline bool doda_index_build_arena(DodaTable *t, DodaIndex *idx, const char *col_name, uint32_t *rows, size_t rows_capacity) { return index_build_arena((Table*)t, (Index*)idx, col_name, rows, rows_capacity); }
 static inline void doda_index_drop(DodaIndex *idx) { index_drop((Index*)idx); }
-typedef enum { DodaIndexStatus_OK = IDX_OK, DodaIndexStatus_UNSUPPORTED = IDX_UNSUPPORTED, DodaIndexStatus_EMPTY = IDX_EMPTY } DodaIndexStatus;
+static inline bool doda_index_attach(DodaTable *t, DodaIndex *idx) { return index_attach((Table*)t, (Index*)idx); }
+static inline void doda_index_detach(DodaTable *t, DodaIndex *idx) { index_detach((Table*)t, (Index*)idx); }
+typedef enum { DodaIndexStatus_OK = IDX_OK, DodaIndexStatus_UNSUPPORTED = IDX_UNSUPPORTED, DodaIndexStatus_EMPTY = IDX_EMPTY, DodaIndexStatus_FULL = IDX_FULL } DodaIndexStatus;
 static inline DodaIndexStatus doda_index_select_eq(const DodaTable *t, const DodaIndex *idx, const void *value, doda_row_callback cb, void *user) { return (DodaIndexStatus)index_select_eq((const Table*)t, (const Index*)idx, value, (row_callback)cb, user); }
+static inline void doda_select_cursor_init(DodaSelectCursor *cur) { select_cursor_init((SelectCursor*)cur); }
+static inline DodaStatus doda_select_into(const DodaTable *t, const DodaPredicate *p, uint32_t *row_ids, size_t cap, DodaSelectCursor *cur, size_t *count_out) { return (DodaStatus)select_into((const Table*)t, (const Predicate*)p, row_ids, cap, (SelectCursor*)cur, count_out); }
+static inline DodaStatus doda_select_into_all(const DodaTable *t, const DodaPredicate *preds, size_t npreds, uint32_t *row_ids, size_t cap, DodaSelectCursor *cur, size_t *count_out) { return (DodaStatus)select_into_all((const Table*)t, (const Predicate*)preds, npreds, row_ids, cap, (SelectCursor*)cur, count_out); }
+static inline DodaStatus doda_select_where_all(const DodaTable *t, const DodaPredicate *preds, size_t npreds, doda_row_callback cb, void *user) { return (DodaStatus)select_where_all((const Table*)t, (const Predicate*)preds, npreds, (row_callback)cb, user); }
+static inline DodaStatus doda_select_filter(const DodaTable *t, const DodaPredicate *p, uint32_t *row_ids, size_t *count) { return (DodaStatus)select_filter((const Table*)t, (const Predicate*)p, row_ids, count); }
 static inline DodaIndexStatus doda_index_select_op(const DodaTable *t, const DodaIndex *idx, DodaOp op, const void *value, doda_row_callback cb, void *user) { return (DodaIndexStatus)index_select_op((const Table*)t, (const Index*)idx, (Op)op, value, (row_callback)cb, user); }
@@ -0,0 +1,369 @@
+#include "doda_flash_log.h"
+#include <string.h>
+
+#define BLOCK_MAGIC 0x42444F44u /* 'DODB' */
+#define BLOCK_HEADER_BYTES 12u
+#define PAGE_COMMIT 0x01u
+#define HDR DODA_FLASH_LOG_PAGE_HEADER_BYTES
+
+enum { PAGE_ERASED = 0, PAGE_HEADER, PAGE_LIVE, PAGE_STALE };
+
+static void wr_u32(uint8_t *p, uint32_t v) { p[0]=(uint8_t)v; p[1]=(uint8_t)(v>>8); p[2]=(uint8_t)(v>>16); p[3]=(uint8_t)(v>>24); }
+static void wr_u16(uint8_t *p, uint16_t v) { p[0]=(uint8_t)v; p[1]=(uint8_t)(v>>8); }
+static uint32_t rd_u32(const uint8_t *p) { return (uint32_t)p[0] | ((uint32_t)p[1]<<8) | ((uint32_t)p[2]<<16) | ((uint32_t)p[3]<<24); }
+static uint16_t rd_u16(const uint8_t *p) { return (uint16_t)p[0] | ((uint16_t)p[1]<<8); }
+
+static size_t page_count(const DodaFlashLog *log) { return log->cfg.block_count * log->pages_per_block; }
+static uintptr_t page_addr(const DodaFlashLog *log, size_t p) { return log->cfg.base_addr + (uintptr_t)(p * log->cfg.page_size); }
+static size_t payload_cap(const DodaFlashLog *log) { return log->cfg.page_size - HDR; }
+static uint8_t *wbuf(DodaFlashLog *log) { return log->cfg.work; }
+static uint8_t *cbuf(DodaFlashLog *log) { return log->cfg.work + log->cfg.page_size; }
+
+static bool block_free(const DodaFlashLog *log, size_t b) {
+    const DodaFlashLogPage *pg = &log->cfg.pages[b * log->pages_per_block];
+    if (pg[0].state != PAGE_HEADER) return false;
+    for (size_t i = 1; i < log->pages_per_block; ++i) if (pg[i].state != PAGE_ERASED) return false;
+    return true;
+}
+
+static size_t free_blocks(const DodaFlashLog *log) {
+    size_t n = 0;
+    for (size_t b = 0; b < log->cfg.block_count; ++b) n += block_free(log, b);
+    return n;
+}
+
+// Block the head is appending to, or SIZE_MAX when it needs a fresh block
+static size_t head_block(const DodaFlashLog *log) {
+    if (!log->has_head || log->head % log->pages_per_block == 0) return SIZE_MAX;
+    return log->head / log->pages_per_block;
+}
+
+// Erase block b and program its header with the new erase count
+static bool format_block(DodaFlashLog *log, size_t b) {
+    size_t first = b * log->pages_per_block;
+    for (size_t i = 0; i < log->pages_per_block; ++i) memset(&log->cfg.pages[first + i], 0, sizeof(DodaFlashLogPage));
+    log->cfg.pages[first].state = PAGE_STALE;
+    if (!log->cfg.erase_block(log->cfg.user, page_addr(log, first), log->cfg.erase_size)) return false;
+    log->cfg.erase_counts[b]++;
+    log->stats.erases++;
+    uint8_t *buf = cbuf(log);
+    log->cached_page = SIZE_MAX;
+    memset(buf, 0xFF, log->cfg.page_size);
+    wr_u32(&buf[0], BLOCK_MAGIC);
+    wr_u32(&buf[4], log->cfg.erase_counts[b]);
+    wr_u32(&buf[8], doda_persist_crc32(0u, buf, 8u));
+    if (!log->cfg.program(log->cfg.user, page_addr(log, first), buf, log->cfg.page_size)) return false;
+    log->cfg.pages[first].state = PAGE_HEADER;
+    return true;
+}
+
+static bool collect_one(DodaFlashLog *log);
+
+// Next page to program. Moving to a new block keeps one erased block in reserve for the
+// collector (collecting first if needed); relocations may use the reserve.
+static bool next_page(DodaFlashLog *log, bool for_gc, size_t *out) {
+    if (head_block(log) != SIZE_MAX && log->cfg.pages[log->head].state == PAGE_ERASED) { *out = log->head; return true; }
+    for (size_t attempt = 0; free_blocks(log) < (for_gc ? 1u : 2u); ++attempt) {
+        if (for_gc || attempt >= log->cfg.block_count || !collect_one(log)) return false;
+        if (head_block(log) != SIZE_MAX) { *out = log->head; return true; } // relocation opened a block
+    }
+    size_t start = log->has_head ? (log->head - 1u) / log->pages_per_block : log->cfg.block_count - 1u;
+    for (size_t i = 1; i <= log->cfg.block_count; ++i) {
+        size_t b = (start + i) % log->cfg.block_count;
+        if (!block_free(log, b)) continue;
+        log->head = b * log->pages_per_block + 1u;
+        log->has_head = true;
+        *out = log->head;
+        return true;
+    }
+    return false;
+}
+
+// Program buf (payload at buf + HDR) as the next page of the log
+static bool program_page(DodaFlashLog *log, uint8_t *buf, uint8_t stream, uint8_t flags, uint32_t version, uint32_t seq, size_t used, bool for_gc) {
+    size_t p;
+    if (!next_page(log, for_gc, &p)) return false;
+    uint32_t serial = log->next_serial++;
+    buf[0] = stream; buf[1] = flags;
+    wr_u16(&buf[2], (uint16_t)used);
+    wr_u32(&buf[4], version);
+    wr_u32(&buf[8], seq);
+    wr_u32(&buf[12], serial);
+    wr_u32(&buf[16], doda_persist_crc32(0u, buf + HDR, used));
+    wr_u32(&buf[20], doda_persist_crc32(0u, buf, 20u));
+    memset(buf + HDR + used, 0xFF, payload_cap(log) - used);
+    DodaFlashLogPage *pg = &log->cfg.pages[p];
+    log->head = p + 1u;
+    pg->state = PAGE_STALE; // until it is known to be programmed
+    if (!log->cfg.program(log->cfg.user, page_addr(log, p), buf, log->cfg.page_size)) return false;
+    pg->version = version; pg->seq = seq; pg->serial = serial;
+    pg->stream = stream; pg->flags = flags; pg->state = PAGE_LIVE;
+    log->stats.pages_programmed++;
+    return true;
+}
+
+// Read page p into the copy buffer and check both CRCs
+static bool load_page(DodaFlashLog *log, size_t p) {
+    if (log->cached_page == p) return true;
+    uint8_t *buf = cbuf(log);
+    log->cached_page = SIZE_MAX;
+    if (!log->cfg.read(log->cfg.user, page_addr(log, p), buf, log->cfg.page_size)) return false;
+    size_t used = rd_u16(&buf[2]);
+    if (rd_u32(&buf[20]) != doda_persist_crc32(0u, buf, 20u) || used > payload_cap(log)) return false;
+    if (rd_u32(&buf[16]) != doda_persist_crc32(0u, buf + HDR, used)) return false;
+    log->cached_page = p;
+    return true;
+}
+
+static void mark_stale(DodaFlashLog *log, uint8_t stream, uint32_t version, uint32_t from_seq) {
+    for (size_t p = 0; p < page_count(log); ++p) {
+        DodaFlashLogPage *pg = &log->cfg.pages[p];
+        if (pg->state == PAGE_LIVE && pg->stream == stream && pg->version == version && pg->seq >= from_seq) pg->state = PAGE_STALE;
+    }
+}
+
+// Move the live pages out of the oldest block (never-formatted blocks first) and erase it
+static bool collect_one(DodaFlashLog *log) {
+    size_t ppb = log->pages_per_block, victim = SIZE_MAX, hb = head_block(log);
+    uint32_t best_age = 0;
+    for (size_t b = 0; b < log->cfg.block_count; ++b) {
+        if (b == hb || block_free(log, b)) continue;
+        const DodaFlashLogPage *pg = &log->cfg.pages[b * ppb];
+        uint32_t age = 0;
+        if (pg[0].state != PAGE_HEADER) age = UINT32_MAX;
+        else for (size_t i = 1; i < ppb; ++i) {
+            if (pg[i].state == PAGE_ERASED) continue;
+            uint32_t a = log->next_serial - pg[i].serial;
+            if (a > age) age = a;
+        }
+        if (victim == SIZE_MAX || age > best_age) { victim = b; best_age = age; }
+    }
+    if (victim == SIZE_MAX) return false;
+
+    size_t live = 0, room = hb != SIZE_MAX ? (hb + 1u) * ppb - log->head : 0;
+    for (size_t i = 1; i < ppb; ++i) live += log->cfg.pages[victim * ppb + i].state == PAGE_LIVE;
+    room += free_blocks(log) * (ppb - 1u);
+    if (live > room) return false;
+
+    for (size_t i = 1; i < ppb && live; ++i) {
+        size_t p = victim * ppb + i;
+        DodaFlashLogPage old = log->cfg.pages[p];
+        if (old.state != PAGE_LIVE) continue;
+        log->cfg.pages[p].state = PAGE_STALE;
+        if (!load_page(log, p)) continue; // damaged: dropping it changes nothing a read could see
+        log->cached_page = SIZE_MAX;
+        if (!program_page(log, cbuf(log), old.stream, old.flags, old.version, old.seq, rd_u16(&cbuf(log)[2]), true)) return false;
+        log->stats.pages_relocated++;
+    }
+    return format_block(log, victim);
+}
+
+// ---- streams ----
+
+static void begin_version(DodaFlashLog *log, uint8_t s) {
+    DodaFlashLogStream *st = &log->streams[s];
+    // Drop whatever was written but never committed
+    if (st->wr_version && st->wr_version != st->version) mark_stale(log, s, st->wr_version, 0);
+    else if (st->wr_version) mark_stale(log, s, st->version, st->pages);
+    if (log->buf_stream == (int)s) { log->buf_stream = -1; log->buf_used = 0; }
+    st->wr_version = log->next_version++;
+    st->wr_pages = 0;
+    st->rd_seq = 0; st->rd_off = 0;
+    st->torn = false;
+}
+
+// Program the coalescing buffer (or an empty page) as the next page of stream s
+static bool emit(DodaFlashLog *log, uint8_t s, bool commit) {
+    DodaFlashLogStream *st = &log->streams[s];
+    size_t used = log->buf_stream == (int)s ? log->buf_used : 0;
+    log->buf_stream = -1; log->buf_used = 0;
+    if (!program_page(log, wbuf(log), s, commit ? PAGE_COMMIT : 0u, st->wr_version, st->wr_pages, used, false)) return false;
+    st->wr_pages++;
+    if (commit) {
+        if (st->version && st->version != st->wr_version) mark_stale(log, s, st->version, 0);
+        st->version = st->wr_version;
+        st->pages = st->wr_pages;
+    }
+    return true;
+}
+
+static size_t find_page(const DodaFlashLog *log, uint8_t s, uint32_t version, uint32_t seq);
+
+// Copy the committed pages of stream s into a new version that receives the writes. Used
+// when uncommitted pages past the last commit survive on flash and would shadow new ones.
+static bool restart_version(DodaFlashLog *log, uint8_t s) {
+    DodaFlashLogStream *st = &log->streams[s];
+    uint32_t w = log->next_version++;
+    for (uint32_t seq = 0; seq < st->pages; ++seq) {
+        size_t p = SIZE_MAX;
+        if (next_page(log, false, &p)) p = find_page(log, s, st->version, seq); // next_page may collect, which reuses the copy buffer
+        bool ok = p != SIZE_MAX && load_page(log, p);
+        log->cached_page = SIZE_MAX;
+        if (!ok || !program_page(log, cbuf(log), s, 0u, w, seq, rd_u16(&cbuf(log)[2]), false)) {
+            mark_stale(log, s, w, 0);
+            return false;
+        }
+    }
+    st->wr_version = w;
+    st->wr_pages = st->pages;
+    st->torn = false;
+    return true;
+}
+
+static bool stream_write(DodaFlashLog *log, uint8_t s, const void *data, size_t size) {
+    DodaFlashLogStream *st = &log->streams[s];
+    if (st->wr_version == 0) {
+        if (st->version && st->torn) { if (!restart_version(log, s)) return false; }
+        else if (st->version) { st->wr_version = st->version; st->wr_pages = st->pages; }
+        else begin_version(log, s);
+    }
+    if (log->buf_stream >= 0 && log->buf_stream != (int)s && !emit(log, (uint8_t)log->buf_stream, false)) return false;
+    const uint8_t *p = (const uint8_t *)data;
+    log->stats.bytes_written += size;
+    log->buf_stream = s;
+    while (size) {
+        size_t k = payload_cap(log) - log->buf_used;
+        if (k > size) k = size;
+        memcpy(wbuf(log) + HDR + log->buf_used, p, k);
+        log->buf_used += k; p += k; size -= k;
+        if (log->buf_used == payload_cap(log)) {
+            if (!emit(log, s, false)) return false;
+            log->buf_stream = s;
+        }
+    }
+    return true;
+}
+
+static bool stream_sync(DodaFlashLog *log, uint8_t s) {
+    DodaFlashLogStream *st = &log->streams[s];
+    bool buffered = log->buf_stream == (int)s && log->buf_used;
+    if (st->wr_version == 0 || (st->wr_version == st->version && st->wr_pages == st->pages && !buffered)) return true;
+    if (log->buf_stream >= 0 && log->buf_stream != (int)s && !emit(log, (uint8_t)log->buf_stream, false)) return false;
+    return emit(log, s, true);
+}
+
+static size_t find_page(const DodaFlashLog *log, uint8_t s, uint32_t version, uint32_t seq) {
+    for (size_t p = 0; p < page_count(log); ++p) {
+        const DodaFlashLogPage *pg = &log->cfg.pages[p];
+        if (pg->state == PAGE_LIVE && pg->stream == s && pg->version == version && pg->seq == seq) return p;
+    }
+    return SIZE_MAX;
+}
+
+static bool stream_read(DodaFlashLog *log, uint8_t s, void *data, size_t size) {
+    DodaFlashLogStream *st = &log->streams[s];
+    uint8_t *out = (uint8_t *)data;
+    while (size) {
+        if (st->version == 0 || st->rd_seq >= st->pages) return false;
+        size_t p = find_page(log, s, st->version, st->rd_seq);
+        if (p == SIZE_MAX || !load_page(log, p)) return false;
+        size_t used = rd_u16(&cbuf(log)[2]), k = used - st->rd_off;
+        if (k > size) k = size;
+        memcpy(out, cbuf(log) + HDR + st->rd_off, k);
+        out += k; size -= k; st->rd_off += k;
+        if (st->rd_off == used) { st->rd_seq++; st->rd_off = 0; }
+    }
+    return true;
+}
+
+static bool log_write_all(void *ctx, const void *data, size_t size) { DodaFlashLogHandle *h = (DodaFlashLogHandle *)ctx; return stream_write(h->log, h->stream, data, size); }
+static bool log_read_all(void *ctx, void *data, size_t size) { DodaFlashLogHandle *h = (DodaFlashLogHandle *)ctx; return stream_read(h->log, h->stream, data, size); }
+static bool log_erase(void *ctx) { DodaFlashLogHandle *h = (DodaFlashLogHandle *)ctx; begin_version(h->log, h->stream); return true; }
+static bool log_sync(void *ctx) { DodaFlashLogHandle *h = (DodaFlashLogHandle *)ctx; return stream_sync(h->log, h->stream); }
+
+void doda_flash_log_storage(DodaFlashLog *log, int stream, DodaStorage *out) {
+    if (!log || !out || stream < 0 || stream >= DODA_FLASH_LOG_STREAMS) return;
+    memset(out, 0, sizeof(*out));
+    out->ctx = &log->handles[stream];
+    out->write_all = log_write_all;
+    out->read_all = log_read_all;
+    out->erase = log_erase;
+    out->sync = log_sync;
+}
+
+void doda_flash_log_rewind(DodaFlashLog *log, int stream) {
+    if (!log || stream < 0 || stream >= DODA_FLASH_LOG_STREAMS) return;
+    log->streams[stream].rd_seq = 0;
+    log->streams[stream].rd_off = 0;
+}
+
+size_t doda_flash_log_gc(DodaFlashLog *log, size_t max_blocks) {
+    if (!log) return 0;
+    size_t target = log->cfg.gc_free_blocks ? log->cfg.gc_free_blocks : 2u, n = 0;
+    while (n < max_blocks && free_blocks(log) < target && collect_one(log)) n++;
+    return n;
+}
+
+void doda_flash_log_stats(const DodaFlashLog *log, DodaFlashLogStats *out) {
+    if (!log || !out) return;
+    *out = log->stats;
+    out->erase_min = UINT32_MAX; out->erase_max = 0;
+    for (size_t b = 0; b < log->cfg.block_count; ++b) {
+        uint32_t c = log->cfg.erase_counts[b];
+        if (c < out->erase_min) out->erase_min = c;
+        if (c > out->erase_max) out->erase_max = c;
+    }
+}
+
+DodaPersistStatus doda_flash_log_mount(DodaFlashLog *log, const DodaFlashLogConfig *cfg) {
+    if (!log || !cfg || !cfg->erase_block || !cfg->program || !cfg->read || !cfg->pages || !cfg->erase_counts || !cfg->work) return DODA_PERSIST_ERR_INVALID;
+    if (cfg->page_size <= HDR || cfg->page_size - HDR > 0xFFFFu || cfg->erase_size % cfg->page_size || cfg->erase_size / cfg->page_size < 2u || cfg->block_count < 3u) return DODA_PERSIST_ERR_INVALID;
+    memset(log, 0, sizeof(*log));
+    log->cfg = *cfg;
+    log->pages_per_block = cfg->erase_size / cfg->page_size;
+    log->buf_stream = -1;
+    log->cached_page = SIZE_MAX;
+    for (int s = 0; s < DODA_FLASH_LOG_STREAMS; ++s) { log->handles[s].log = log; log->handles[s].stream = (uint8_t)s; }
+
+    size_t ppb = log->pages_per_block, newest = SIZE_MAX;
+    uint32_t max_version = 0, max_serial = 0;
+    uint8_t h[HDR];
+    for (size_t b = 0; b < cfg->block_count; ++b) {
+        DodaFlashLogPage *pg = &cfg->pages[b * ppb];
+        memset(pg, 0, ppb * sizeof(*pg));
+        cfg->erase_counts[b] = 0;
+        if (!cfg->read(cfg->user, page_addr(log, b * ppb), h, BLOCK_HEADER_BYTES)) return DODA_PERSIST_ERR_IO;
+        if (rd_u32(&h[0]) != BLOCK_MAGIC || rd_u32(&h[8]) != doda_persist_crc32(0u, h, 8u)) {
+            for (size_t i = 0; i < ppb; ++i) pg[i].state = PAGE_STALE; // erased on first collection
+            continue;
+        }
+        cfg->erase_counts[b] = rd_u32(&h[4]);
+        pg[0].state = PAGE_HEADER;
+        for (size_t i = 1; i < ppb; ++i) {
+            if (!cfg->read(cfg->user, page_addr(log, b * ppb + i), h, HDR)) return DODA_PERSIST_ERR_IO;
+            bool erased = true;
+            for (size_t k = 0; k < HDR; ++k) erased = erased && h[k] == 0xFFu;
+            if (erased) { pg[i].state = PAGE_ERASED; continue; }
+            pg[i].state = PAGE_STALE;
+            if (rd_u32(&h[20]) != doda_persist_crc32(0u, h, 20u)) continue;
+            pg[i].stream = h[0]; pg[i].flags = h[1];
+            pg[i].version = rd_u32(&h[4]); pg[i].seq = rd_u32(&h[8]); pg[i].serial = rd_u32(&h[12]);
+            if (newest == SIZE_MAX || (int32_t)(pg[i].serial - max_serial) > 0) { max_serial = pg[i].serial; newest = b * ppb + i; }
+            if (pg[i].stream >= DODA_FLASH_LOG_STREAMS) continue;
+            if (pg[i].version > max_version) max_version = pg[i].version;
+            pg[i].state = PAGE_LIVE;
+            DodaFlashLogStream *st = &log->streams[pg[i].stream];
+            if (!(pg[i].flags & PAGE_COMMIT)) continue;
+            if (pg[i].version > st->version) { st->version = pg[i].version; st->pages = pg[i].seq + 1u; }
+            else if (pg[i].version == st->version && pg[i].seq + 1u > st->pages) st->pages = pg[i].seq + 1u;
+        }
+    }
+    // Only the newest committed version of each stream, up to its last commit, stays live
+    for (size_t p = 0; p < page_count(log); ++p) {
+        DodaFlashLogPage *pg = &cfg->pages[p];
+        if (pg->state != PAGE_LIVE) continue;
+        DodaFlashLogStream *st = &log->streams[pg->stream];
+        if (pg->version == st->version && pg->seq >= st->pages) st->torn = true;
+        if (pg->version != st->version || pg->seq >= st->pages) pg->state = PAGE_STALE;
+    }
+    log->next_version = max_version + 1u;
+    log->next_serial = max_serial + 1u;
+    if (newest != SIZE_MAX) {
+        // Append after the last programmed page of the newest block
+        size_t b = newest / ppb, last = newest;
+        for (size_t i = newest % ppb + 1u; i < ppb; ++i) if (cfg->pages[b * ppb + i].state != PAGE_ERASED) last = b * ppb + i;
+        log->head = last + 1u;
+        log->has_head = true;
+    }
+    return DODA_PERSIST_OK;
+}
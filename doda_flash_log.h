@@ -0,0 +1,114 @@
+#pragma once
+#include "doda_persist.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Wear-leveled, log-structured store on raw NOR/NAND-style flash, exposed as DodaStorage
+// streams (e.g. stream 0 for snapshots, stream 1 for the WAL).
+//
+// The region is block_count erase blocks of erase_size bytes, programmed page_size bytes at a
+// time. Page 0 of every block holds its erase count; the other pages are appended to in one
+// round-robin sequence across all blocks, so every block takes its turn being erased:
+//   block header: 'DODB' | u32 erase count | u32 CRC32
+//   page header:  u8 stream | u8 flags | u16 payload bytes | u32 version | u32 seq |
+//                 u32 serial | u32 payload CRC32 | u32 header CRC32, then the payload
+// Writes are coalesced into whole pages. erase() on a stream starts a new version of it
+// without touching flash; sync() (called by doda_persist_* and doda_wal_commit) flushes the
+// partial page flagged as a commit point, and only then does the new version replace the old
+// one. Reads see the newest version up to its last commit, so a power cut mid-save leaves the
+// previous snapshot readable. Appends continue the committed version, except after a mount
+// that found uncommitted pages past its last commit: those sequence numbers are taken, so the
+// next append copies the committed pages into a new version first. Pages of superseded
+// versions are stale; garbage collection
+// moves the live pages out of the oldest block and erases it, in the background via
+// doda_flash_log_gc() or when a write runs out of erased blocks.
+//
+// Mount reads only the block and page headers (24 bytes per page).
+
+#define DODA_FLASH_LOG_STREAMS 4
+#define DODA_FLASH_LOG_PAGE_HEADER_BYTES 24u
+
+// Per page bookkeeping (caller memory, one entry per page of the region)
+typedef struct {
+    uint32_t version;
+    uint32_t seq;
+    uint32_t serial;     // global program order
+    uint8_t stream;
+    uint8_t state;       // erased, block header, live or stale
+    uint8_t flags;
+    uint8_t reserved;
+} DodaFlashLogPage;
+
+typedef struct {
+    void *user;
+    uintptr_t base_addr;
+    size_t page_size;    // program unit; > DODA_FLASH_LOG_PAGE_HEADER_BYTES
+    size_t erase_size;   // erase unit; a multiple of page_size holding at least 2 pages
+    size_t block_count;  // >= 3 (one erased block is kept in reserve for garbage collection)
+    size_t gc_free_blocks; // doda_flash_log_gc() collects until this many blocks are erased (0: 2)
+    bool (*erase_block)(void *user, uintptr_t addr, size_t size);
+    bool (*program)(void *user, uintptr_t addr, const void *data, size_t size);
+    bool (*read)(void *user, uintptr_t addr, void *data, size_t size);
+    DodaFlashLogPage *pages;  // block_count * erase_size / page_size entries
+    uint32_t *erase_counts;   // block_count entries
+    uint8_t *work;            // 2 * page_size bytes (write coalescing + page copies)
+} DodaFlashLogConfig;
+
+typedef struct {
+    uint64_t bytes_written;   // payload bytes handed to write_all
+    uint64_t pages_programmed;
+    uint64_t pages_relocated; // live pages copied by garbage collection
+    uint64_t erases;
+    uint32_t erase_min, erase_max; // over all blocks
+} DodaFlashLogStats;
+
+struct DodaFlashLog;
+typedef struct {
+    struct DodaFlashLog *log;
+    uint8_t stream;
+} DodaFlashLogHandle;
+
+typedef struct {
+    uint32_t version;     // readable (committed) version, 0 if none
+    uint32_t pages;       // its pages up to the last commit
+    uint32_t wr_version;  // version receiving writes, 0 if none
+    uint32_t wr_pages;    // pages of wr_version programmed so far
+    uint32_t rd_seq;      // read cursor
+    size_t rd_off;
+    bool torn;            // mount found uncommitted pages of version past pages
+} DodaFlashLogStream;
+
+typedef struct DodaFlashLog {
+    DodaFlashLogConfig cfg;
+    size_t pages_per_block;
+    DodaFlashLogStream streams[DODA_FLASH_LOG_STREAMS];
+    DodaFlashLogHandle handles[DODA_FLASH_LOG_STREAMS];
+    uint32_t next_version, next_serial;
+    size_t head;          // next page to program (absolute page index), valid if has_head
+    bool has_head;
+    int buf_stream;       // stream whose bytes are coalescing in work[0..page_size), -1 if none
+    size_t buf_used;
+    size_t cached_page;   // page held in work[page_size..) for reads, SIZE_MAX if none
+    DodaFlashLogStats stats;
+} DodaFlashLog;
+
+// Scan the headers and rebuild the page map, stream versions and write position. Blocks
+// without a valid header (fresh or torn erase) are erased by the first collection.
+DodaPersistStatus doda_flash_log_mount(DodaFlashLog *log, const DodaFlashLogConfig *cfg);
+
+// DodaStorage for one stream (cursor interface: write_all, read_all, erase, sync).
+// read_all starts at the beginning of the committed version; doda_flash_log_rewind() restarts it.
+void doda_flash_log_storage(DodaFlashLog *log, int stream, DodaStorage *out);
+void doda_flash_log_rewind(DodaFlashLog *log, int stream);
+
+// Background collection: erase up to max_blocks of the oldest blocks while fewer than
+// cfg.gc_free_blocks are erased. Returns the number of blocks erased.
+size_t doda_flash_log_gc(DodaFlashLog *log, size_t max_blocks);
+
+void doda_flash_log_stats(const DodaFlashLog *log, DodaFlashLogStats *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,306 @@
+#include "doda_map.h"
+#include "doda_scan.h"
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define DODA_MAP_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define DODA_MAP_HAS_MMAP 0
+#endif
+
+#define IMAGE_MAGIC 0x4D444F44u /* 'DODM' */
+#define IMAGE_VERSION 1u
+#define IMAGE_BYTE_ORDER 0x0102030405060708ULL
+
+// Header: IMAGE_FIXED_WORDS u64 words, then per column its name (padded to 8 bytes) and
+// {type, data offset, data bytes, zone offset, zone bytes}, then per index {column, offset,
+// bytes}, then the u64 header CRC. All words are host-endian.
+enum {
+    H_MAGIC, H_VERSION, H_BYTE_ORDER, H_INT_BYTES, H_TEXT_LEN, H_NAME_LEN, H_PAGE,
+    H_COLUMNS, H_INDEXES, H_COUNT, H_DELETED, H_HASH_SIZE, H_PK_COUNT, H_FILE_BYTES,
+    H_DEL_OFF, H_DEL_BYTES, H_PK_OFF, H_PK_BYTES, IMAGE_FIXED_WORDS
+};
+#define NAME_WORDS ((MAX_NAME_LEN + 7u) / 8u)
+#define COLUMN_WORDS (NAME_WORDS + 5u)
+#define INDEX_WORDS 3u
+#define TRAILER_BYTES 8u
+
+static size_t page_round(size_t n) { return (n + DODA_IMAGE_PAGE - 1u) / DODA_IMAGE_PAGE * DODA_IMAGE_PAGE; }
+
+static size_t header_words(size_t ncols, size_t nidx) { return IMAGE_FIXED_WORDS + ncols * COLUMN_WORDS + nidx * INDEX_WORDS + 1u; }
+
+static size_t cell_bytes(ColumnType ct) {
+    switch (ct) {
+        case COL_INT: return sizeof(int);
+        case COL_BOOL: return sizeof(uint8_t);
+#ifndef DRIVERSQL_NO_FLOAT
+        case COL_FLOAT: return sizeof(float);
+#endif
+#ifndef DRIVERSQL_NO_DOUBLE
+        case COL_DOUBLE: return sizeof(double);
+#endif
+#ifndef DRIVERSQL_NO_TEXT
+        case COL_TEXT: return MAX_TEXT_LEN;
+#endif
+        default: return 0;
+    }
+}
+
+static const void *column_cells(const Column *c) {
+    switch (c->type) {
+        case COL_INT: return c->data.int_data;
+        case COL_BOOL: return c->data.bool_data;
+#ifndef DRIVERSQL_NO_FLOAT
+        case COL_FLOAT: return c->data.float_data;
+#endif
+#ifndef DRIVERSQL_NO_DOUBLE
+        case COL_DOUBLE: return c->data.double_data;
+#endif
+#ifndef DRIVERSQL_NO_TEXT
+        case COL_TEXT: return c->data.text_data;
+#endif
+        default: return NULL;
+    }
+}
+
+static void set_column_cells(Column *c, void *p) {
+    switch (c->type) {
+        case COL_INT: c->data.int_data = (int *)p; break;
+        case COL_BOOL: c->data.bool_data = (uint8_t *)p; break;
+#ifndef DRIVERSQL_NO_FLOAT
+        case COL_FLOAT: c->data.float_data = (float *)p; break;
+#endif
+#ifndef DRIVERSQL_NO_DOUBLE
+        case COL_DOUBLE: c->data.double_data = (double *)p; break;
+#endif
+#ifndef DRIVERSQL_NO_TEXT
+        case COL_TEXT: c->data.text_data = (char (*)[MAX_TEXT_LEN])p; break;
+#endif
+        default: break;
+    }
+}
+
+// Segment sizes of t, in directory order; false if t cannot be imaged
+typedef struct {
+    size_t del, pk;
+    size_t data[MAX_COLUMNS], zone[MAX_COLUMNS];
+    size_t idx[MAX_INDEXES];
+    size_t header, total;
+} ImageLayout;
+
+static bool image_layout(const DodaTable *t, const DodaIndex *const *indexes, size_t nindexes, ImageLayout *l) {
+    if (!t || nindexes > MAX_INDEXES || (nindexes && !indexes)) return false;
+    memset(l, 0, sizeof(*l));
+    size_t words = (t->count + 63u) / 64u;
+    l->header = page_round(header_words((size_t)t->column_count, nindexes) * 8u);
+    l->total = l->header;
+    l->del = words * sizeof(uint64_t); l->total += page_round(l->del);
+    l->pk = t->pk_count ? t->hash_size * sizeof(uint32_t) : 0; l->total += page_round(l->pk);
+    for (int c = 0; c < t->column_count; ++c) {
+        const Column *col = &t->columns[c];
+        if (cell_bytes(col->type) == 0) return false;
+        l->data[c] = t->count * cell_bytes(col->type); l->total += page_round(l->data[c]);
+        l->zone[c] = col->zone ? words * 2u * sizeof(double) : 0; l->total += page_round(l->zone[c]);
+    }
+    for (size_t i = 0; i < nindexes; ++i) {
+        const DodaIndex *idx = indexes[i];
+        if (!idx || !idx->active || idx->column_id < 0 || idx->column_id >= t->column_count) return false;
+        l->idx[i] = idx->size * sizeof(uint32_t); l->total += page_round(l->idx[i]);
+    }
+    l->total += TRAILER_BYTES;
+    return true;
+}
+
+size_t doda_image_bytes(const DodaTable *t, const DodaIndex *const *indexes, size_t nindexes) {
+    ImageLayout l;
+    return image_layout(t, indexes, nindexes, &l) ? l.total : 0;
+}
+
+typedef struct {
+    const DodaStorage *st;
+    size_t pos;
+    uint32_t crc;
+    bool ok;
+} ImageWriter;
+
+static void iw_put(ImageWriter *w, const void *p, size_t n, bool crc) {
+    if (!w->ok || n == 0) return;
+    if (crc) w->crc = doda_persist_crc32(w->crc, p, n);
+    uint64_t off = w->pos;
+    w->ok = doda_storage_write(w->st, &off, p, n);
+    w->pos += n;
+}
+
+static void iw_pad(ImageWriter *w, bool crc) {
+    static const uint8_t zeros[256];
+    size_t n = page_round(w->pos) - w->pos;
+    while (n && w->ok) { size_t k = n < sizeof(zeros) ? n : sizeof(zeros); iw_put(w, zeros, k, crc); n -= k; }
+}
+
+static void iw_segment(ImageWriter *w, const void *p, size_t n) { iw_put(w, p, n, true); iw_pad(w, true); }
+
+DodaPersistStatus doda_persist_save_image(const DodaTable *t, const DodaIndex *const *indexes, size_t nindexes, const DodaStorage *st) {
+    if (!st || !(st->write_all || st->writev || st->borrow || st->write_at)) return DODA_PERSIST_ERR_INVALID;
+    ImageLayout l;
+    if (!image_layout(t, indexes, nindexes, &l)) return t ? DODA_PERSIST_ERR_UNSUPPORTED : DODA_PERSIST_ERR_INVALID;
+    if (st->erase && !st->erase(st->ctx)) return DODA_PERSIST_ERR_IO;
+
+    // Directory: segments follow the header in order, each on a page boundary
+    uint64_t h[IMAGE_FIXED_WORDS + MAX_COLUMNS * COLUMN_WORDS + MAX_INDEXES * INDEX_WORDS + 1u];
+    memset(h, 0, sizeof(h));
+    size_t off = l.header;
+    #define IMAGE_SEG(o, b, n) do { h[(o)] = (n) ? off : 0u; h[(b)] = (n); off += page_round(n); } while (0)
+    h[H_MAGIC] = IMAGE_MAGIC; h[H_VERSION] = IMAGE_VERSION; h[H_BYTE_ORDER] = IMAGE_BYTE_ORDER;
+    h[H_INT_BYTES] = sizeof(int); h[H_TEXT_LEN] = MAX_TEXT_LEN; h[H_NAME_LEN] = MAX_NAME_LEN; h[H_PAGE] = DODA_IMAGE_PAGE;
+    h[H_COLUMNS] = (uint64_t)t->column_count; h[H_INDEXES] = nindexes;
+    h[H_COUNT] = t->count; h[H_DELETED] = t->free_top; h[H_HASH_SIZE] = t->pk_count ? t->hash_size : 0; h[H_PK_COUNT] = t->pk_count;
+    h[H_FILE_BYTES] = l.total;
+    IMAGE_SEG(H_DEL_OFF, H_DEL_BYTES, l.del);
+    IMAGE_SEG(H_PK_OFF, H_PK_BYTES, l.pk);
+    for (int c = 0; c < t->column_count; ++c) {
+        size_t w = IMAGE_FIXED_WORDS + (size_t)c * COLUMN_WORDS;
+        const char *name = t->columns[c].name;
+        size_t len = 0;
+        while (len < MAX_NAME_LEN - 1u && name[len]) ++len;
+        memcpy(&h[w], name, len);
+        h[w + NAME_WORDS] = (uint64_t)t->columns[c].type;
+        IMAGE_SEG(w + NAME_WORDS + 1u, w + NAME_WORDS + 2u, l.data[c]);
+        IMAGE_SEG(w + NAME_WORDS + 3u, w + NAME_WORDS + 4u, l.zone[c]);
+    }
+    for (size_t i = 0; i < nindexes; ++i) {
+        size_t w = IMAGE_FIXED_WORDS + (size_t)t->column_count * COLUMN_WORDS + i * INDEX_WORDS;
+        h[w] = (uint64_t)indexes[i]->column_id;
+        IMAGE_SEG(w + 1u, w + 2u, l.idx[i]);
+    }
+    #undef IMAGE_SEG
+    size_t hw = header_words((size_t)t->column_count, nindexes);
+    h[hw - 1u] = doda_persist_crc32(0u, h, (hw - 1u) * 8u);
+
+    ImageWriter w = { st, 0, 0u, true };
+    iw_put(&w, h, hw * 8u, false);
+    iw_pad(&w, false);
+    iw_segment(&w, t->deleted_bits, l.del);
+    iw_segment(&w, t->pk_hash, l.pk);
+    for (int c = 0; c < t->column_count; ++c) {
+        iw_segment(&w, column_cells(&t->columns[c]), l.data[c]);
+        iw_segment(&w, t->columns[c].zone, l.zone[c]);
+    }
+    for (size_t i = 0; i < nindexes; ++i) iw_segment(&w, indexes[i]->rows, l.idx[i]);
+    uint64_t trailer = w.crc;
+    iw_put(&w, &trailer, sizeof(trailer), false);
+    return w.ok && doda_storage_sync(st) ? DODA_PERSIST_OK : DODA_PERSIST_ERR_IO;
+}
+
+// Pointer to a directory segment of exactly `bytes` bytes (NULL when both are 0)
+static bool image_seg(const uint8_t *base, const uint64_t *h, size_t w, size_t bytes, const void **out) {
+    uint64_t off = h[w], n = h[w + 1u];
+    *out = NULL;
+    if (n != bytes) return false;
+    if (n == 0) return true;
+    if (off % DODA_IMAGE_PAGE || off + n > h[H_FILE_BYTES] - TRAILER_BYTES || off + n < off) return false;
+    *out = base + off;
+    return true;
+}
+
+DodaPersistStatus doda_table_map_memory(DodaTableMap *m, const void *image, size_t bytes, bool verify) {
+    if (!m || !image || ((uintptr_t)image % sizeof(uint64_t)) != 0) return DODA_PERSIST_ERR_INVALID;
+    const uint8_t *base = (const uint8_t *)image;
+    const uint64_t *h = (const uint64_t *)image;
+    if (bytes < IMAGE_FIXED_WORDS * 8u || h[H_MAGIC] != IMAGE_MAGIC) return DODA_PERSIST_ERR_CORRUPT;
+    if (h[H_VERSION] != IMAGE_VERSION || h[H_BYTE_ORDER] != IMAGE_BYTE_ORDER || h[H_INT_BYTES] != sizeof(int) ||
+        h[H_TEXT_LEN] != MAX_TEXT_LEN || h[H_NAME_LEN] != MAX_NAME_LEN || h[H_PAGE] != DODA_IMAGE_PAGE) return DODA_PERSIST_ERR_UNSUPPORTED;
+    if (h[H_COLUMNS] == 0 || h[H_COLUMNS] > MAX_COLUMNS || h[H_INDEXES] > MAX_INDEXES) return DODA_PERSIST_ERR_CORRUPT;
+    size_t ncols = (size_t)h[H_COLUMNS], nidx = (size_t)h[H_INDEXES], hw = header_words(ncols, nidx);
+    if (bytes < page_round(hw * 8u) || h[H_FILE_BYTES] > bytes || h[H_FILE_BYTES] < page_round(hw * 8u) + TRAILER_BYTES) return DODA_PERSIST_ERR_CORRUPT;
+    if (h[hw - 1u] != doda_persist_crc32(0u, h, (hw - 1u) * 8u)) return DODA_PERSIST_ERR_CORRUPT;
+    size_t count = (size_t)h[H_COUNT], words = (count + 63u) / 64u;
+    if (h[H_DELETED] > count || h[H_PK_COUNT] > count || (h[H_HASH_SIZE] & (h[H_HASH_SIZE] - 1u)) != 0 || h[H_PK_COUNT] > h[H_HASH_SIZE]) return DODA_PERSIST_ERR_CORRUPT;
+
+    memset(m, 0, sizeof(*m));
+    Table *t = &m->table;
+    strncpy(t->name, "mapped", MAX_NAME_LEN - 1);
+    t->column_count = (int)ncols;
+    t->capacity = count; t->count = count; t->free_top = (size_t)h[H_DELETED];
+    t->hash_size = t->hash_capacity = (size_t)h[H_HASH_SIZE]; t->pk_count = (size_t)h[H_PK_COUNT];
+    const void *p;
+    if (!image_seg(base, h, H_DEL_OFF, words * sizeof(uint64_t), &p)) return DODA_PERSIST_ERR_CORRUPT;
+    t->deleted_bits = (uint64_t *)(uintptr_t)p;
+    if (!image_seg(base, h, H_PK_OFF, t->pk_count ? t->hash_size * sizeof(uint32_t) : 0, &p)) return DODA_PERSIST_ERR_CORRUPT;
+    t->pk_hash = (uint32_t *)(uintptr_t)p;
+    if (!t->pk_hash) t->hash_size = t->hash_capacity = 0;
+    for (size_t c = 0; c < ncols; ++c) {
+        const uint64_t *cw = &h[IMAGE_FIXED_WORDS + c * COLUMN_WORDS];
+        Column *col = &t->columns[c];
+        memcpy(col->name, cw, MAX_NAME_LEN);
+        col->name[MAX_NAME_LEN - 1] = '\0';
+        col->type = (ColumnType)cw[NAME_WORDS];
+        if (cell_bytes(col->type) == 0) return DODA_PERSIST_ERR_UNSUPPORTED;
+        size_t w = IMAGE_FIXED_WORDS + c * COLUMN_WORDS + NAME_WORDS;
+        if (!image_seg(base, h, w + 1u, count * cell_bytes(col->type), &p)) return DODA_PERSIST_ERR_CORRUPT;
+        set_column_cells(col, (void *)(uintptr_t)p);
+        bool zoned = cw[NAME_WORDS + 4u] != 0;
+        if (zoned && !scan_type_supported(col->type)) return DODA_PERSIST_ERR_CORRUPT;
+        if (!image_seg(base, h, w + 3u, zoned ? words * 2u * sizeof(double) : 0, &p)) return DODA_PERSIST_ERR_CORRUPT;
+        col->zone = (double *)(uintptr_t)p;
+    }
+    for (size_t i = 0; i < nidx; ++i) {
+        const uint64_t *iw = &h[IMAGE_FIXED_WORDS + ncols * COLUMN_WORDS + i * INDEX_WORDS];
+        Index *idx = &m->indexes[i];
+        if (iw[0] >= ncols || iw[2] % sizeof(uint32_t) || iw[2] / sizeof(uint32_t) > count) return DODA_PERSIST_ERR_CORRUPT;
+        if (!image_seg(base, h, IMAGE_FIXED_WORDS + ncols * COLUMN_WORDS + i * INDEX_WORDS + 1u, (size_t)iw[2], &p)) return DODA_PERSIST_ERR_CORRUPT;
+        idx->column_id = (int)iw[0];
+        idx->rows = (uint32_t *)(uintptr_t)p;
+        idx->size = idx->capacity = (size_t)iw[2] / sizeof(uint32_t);
+        idx->active = true;
+        t->indexes[i] = idx;
+    }
+    t->index_count = (int)nidx;
+    m->index_count = (int)nidx;
+
+    if (verify) {
+        size_t start = page_round(hw * 8u), end = (size_t)h[H_FILE_BYTES] - TRAILER_BYTES;
+        uint64_t trailer;
+        memcpy(&trailer, base + end, sizeof(trailer));
+        if (doda_persist_crc32(0u, base + start, end - start) != (uint32_t)trailer) return DODA_PERSIST_ERR_CORRUPT;
+        for (size_t s = 0; s < t->hash_size; ++s) if (t->pk_hash[s] > count) return DODA_PERSIST_ERR_CORRUPT;
+        for (int i = 0; i < m->index_count; ++i)
+            for (size_t k = 0; k < m->indexes[i].size; ++k) if (m->indexes[i].rows[k] >= count) return DODA_PERSIST_ERR_CORRUPT;
+    }
+    m->image = base;
+    m->bytes = bytes;
+    return DODA_PERSIST_OK;
+}
+
+DodaPersistStatus doda_table_map(DodaTableMap *m, const char *path, bool verify) {
+    if (!m || !path) return DODA_PERSIST_ERR_INVALID;
+#if DODA_MAP_HAS_MMAP
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return DODA_PERSIST_ERR_IO;
+    struct stat sb;
+    if (fstat(fd, &sb) != 0 || sb.st_size <= 0) { close(fd); return DODA_PERSIST_ERR_IO; }
+    size_t bytes = (size_t)sb.st_size;
+    void *p = mmap(NULL, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return DODA_PERSIST_ERR_IO;
+    DodaPersistStatus s = doda_table_map_memory(m, p, bytes, verify);
+    if (s != DODA_PERSIST_OK) { munmap(p, bytes); return s; }
+    m->mapped = true;
+    return DODA_PERSIST_OK;
+#else
+    (void)verify;
+    return DODA_PERSIST_ERR_UNSUPPORTED;
+#endif
+}
+
+void doda_table_unmap(DodaTableMap *m) {
+    if (!m) return;
+#if DODA_MAP_HAS_MMAP
+    if (m->mapped && m->image) munmap((void *)(uintptr_t)m->image, m->bytes);
+#endif
+    m->image = NULL; m->bytes = 0; m->mapped = false;
+    m->table.count = 0; m->table.index_count = 0; m->index_count = 0;
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include "doda_persist.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Read-only table images for instant startup on hosts (and memory-mapped flash).
+//
+// An image holds the table's own in-memory arrays, each in a page-aligned segment: deleted
+// bitmap, primary-key hash, one segment per column (plus its zone map) and the sorted row ids
+// of each index passed to the writer. Opening one points a Table straight at those segments,
+// so select_*, index_select_*, agg_* and the planner query it with no copy and no per-row
+// parsing. The view is read-only: never insert, delete, restore or clear it (a PROT_READ
+// mapping faults on a write).
+//
+// Images use the host representation (byte order, int size, MAX_TEXT_LEN) and are rejected by
+// builds that differ; use doda_persist_save_table for portable snapshots.
+//
+//   page-aligned header: layout, schema, segment directory, header CRC
+//   segments, each starting on a DODA_IMAGE_PAGE boundary
+//   trailer: CRC32 of every byte between the header and the trailer (checked when verify)
+
+#ifndef DODA_IMAGE_PAGE
+#define DODA_IMAGE_PAGE 4096u
+#endif
+
+typedef struct {
+    DodaTable table;                  // the view; its pointers refer into the image
+    DodaIndex indexes[MAX_INDEXES];   // attached to table; usable with doda_index_select_*
+    int index_count;
+    const uint8_t *image;
+    size_t bytes;
+    bool mapped;                      // image came from doda_table_map (unmap releases it)
+} DodaTableMap;
+
+// Exact image size for t and its indexes (0 if the table cannot be imaged)
+size_t doda_image_bytes(const DodaTable *t, const DodaIndex *const *indexes, size_t nindexes);
+
+// Write the image sequentially (erases first when the backend can). Indexes must be built on t
+// and current; their sorted row ids are stored so nothing is rebuilt when the image opens.
+DodaPersistStatus doda_persist_save_image(const DodaTable *t, const DodaIndex *const *indexes, size_t nindexes, const DodaStorage *st);
+
+// Open an image already in memory (8-byte aligned; it must outlive the view). verify also
+// checks the data CRC and every stored row id, which costs one pass over the image.
+DodaPersistStatus doda_table_map_memory(DodaTableMap *m, const void *image, size_t bytes, bool verify);
+
+// mmap a file read-only and open it; DODA_PERSIST_ERR_UNSUPPORTED where mmap is unavailable
+DodaPersistStatus doda_table_map(DodaTableMap *m, const char *path, bool verify);
+void doda_table_unmap(DodaTableMap *m);
+
+#ifdef __cplusplus
+}
+#endif
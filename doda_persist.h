@@ -1,5 +1,6 @@
 #pragma once
 #include "doda_engine.h"
+#include "doda_compress.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -19,7 +20,25 @@ extern "C" {
 #define DODA_PERSIST_HAS_CRC 0
 #endif
 
+// CRC32 (IEEE 802.3) used by the persisted formats; pass 0 to start, the previous result to
+// continue. Always built: the WAL checks every record with it even under DODA_PERSIST_NO_CRC.
+// Slice-by-8 tables by default, ARMv8 CRC32 or PCLMULQDQ when the target flags enable them
+// (e.g. DODA_SIMD_NATIVE); define DODA_PERSIST_CRC_NO_HW to keep the tables, or
+// DODA_PERSIST_CRC_SMALL for the table-free bitwise loop. All give the same values.
+uint32_t doda_persist_crc32(uint32_t crc, const void *data, size_t len);
+// Name of the CRC32 implementation built in ("pclmul", "armv8-crc", "slice-by-8", "bitwise")
+const char *doda_persist_crc32_impl(void);
+
+// One piece of a gather write
+typedef struct DodaIoVec {
+    const void *data;
+    size_t size;
+} DodaIoVec;
+
 // Storage interface (implemented by the application/platform)
+// A backend offers a cursor (write_all/read_all, optionally writev/borrow) or positional I/O
+// (write_at/read_at) or both; members it does not implement are NULL. Brace initializers
+// listing only the first four members leave the extensions NULL.
 typedef struct DodaStorage {
     void *ctx;
 
@@ -31,10 +50,48 @@ typedef struct DodaStorage {
 
     // Optional: erase/clear medium before write (may be NULL)
     bool (*erase)(void *ctx);
+
+    // Optional: write the pieces in order at the cursor in one call (like POSIX writev)
+    bool (*writev)(void *ctx, const DodaIoVec *iov, size_t count);
+
+    // Optional: positional I/O at a byte offset from the start of the medium. Used when the
+    // backend has no cursor; the serializer then keeps the offset itself, starting at 0.
+    bool (*write_at)(void *ctx, uint64_t offset, const void *data, size_t size);
+    bool (*read_at)(void *ctx, uint64_t offset, void *data, size_t size);
+
+    // Optional: return the next `size` bytes of the medium at the cursor as memory and advance
+    // the cursor past them, or NULL (e.g. not enough room). Save writes the whole table into
+    // one borrowed span and load reads cells straight out of it, with no staging copy.
+    void *(*borrow)(void *ctx, size_t size);
+
+    // Optional: make everything written since the last sync (or erase) durable. Called after
+    // each complete table, delta, block or image and after each WAL group; a backend that
+    // commits atomically here (doda_flash_log.h) never exposes a half-written snapshot.
+    bool (*sync)(void *ctx);
 } DodaStorage;
 
-// Persisted format version
-#define DODA_PERSIST_VERSION 1u
+// Initializer for a cursor backend that implements only the first four members
+#define DODA_STORAGE_INIT(ctx, write_all, read_all, erase) { (ctx), (write_all), (read_all), (erase), NULL, NULL, NULL, NULL, NULL }
+
+// Stream I/O through whichever interface st offers: the cursor when write_all/read_all is set,
+// else write_at/read_at at *offset. *offset advances by the bytes moved either way.
+bool doda_storage_write(const DodaStorage *st, uint64_t *offset, const void *data, size_t size);
+bool doda_storage_writev(const DodaStorage *st, uint64_t *offset, const DodaIoVec *iov, size_t count);
+bool doda_storage_read(const DodaStorage *st, uint64_t *offset, void *data, size_t size);
+// st->sync when the backend has one, else true
+bool doda_storage_sync(const DodaStorage *st);
+
+// Persisted table format version. v2 moved the CRC32 from the header to a trailer so a table
+// is written in one pass; v3 stores whole columns so loading is one bulk copy per column.
+// v1 and v2 files still load.
+#define DODA_PERSIST_VERSION 3u
+#define DODA_PERSIST_HEADER_BYTES 26u
+
+// Staging buffer on the stack of doda_persist_save_table/load_table/save_delta; the _staged
+// variants take a caller buffer instead (larger means fewer, larger write_all/read_all calls)
+#ifndef DODA_PERSIST_STAGE_BYTES
+#define DODA_PERSIST_STAGE_BYTES 256u
+#endif
 
 // Error codes for persistence
 typedef enum {
@@ -47,17 +104,47 @@ typedef enum {
 
 // Save/load a Table in a portable binary format.
 // Notes:
-//  - Only non-deleted rows are stored.
+//  - Every row slot up to the table count is stored column by column, with the deleted bitmap;
+//    load reads each column straight into its array and rebuilds the pk hash once.
 //  - Pointer columns are never persisted.
 //  - TEXT/FLOAT/DOUBLE are persisted only if enabled in the build.
 //  - Table schema (column names/types) is stored in the header and validated on load.
+//  - Rows are loaded back at their saved row ids (deleted slots become free slots).
+//  - Save streams the table once through the staging buffer, computing the CRC as it goes;
+//    load reads through it in buffer-sized chunks without reading past the table's bytes.
+//  - With writev, staged bytes and the column segment that follows leave in one call; with
+//    borrow, save encodes into the medium's memory and load copies columns out of it.
+//  - Load rebuilds into a MAX_ROWS table, so save refuses tables with more rows
+//    (DODA_PERSIST_ERR_UNSUPPORTED); map larger arena tables with doda_persist_save_image().
 DodaPersistStatus doda_persist_save_table(const DodaTable *t, const DodaStorage *st);
 DodaPersistStatus doda_persist_load_table(DodaTable *out, const DodaStorage *st);
+DodaPersistStatus doda_persist_save_table_staged(const DodaTable *t, const DodaStorage *st, uint8_t *buf, size_t cap);
+DodaPersistStatus doda_persist_load_table_staged(DodaTable *out, const DodaStorage *st, uint8_t *buf, size_t cap);
+
+// Incremental snapshots: after a base doda_persist_save_table() (then doda_table_clear_dirty),
+// doda_persist_save_delta() appends only the 64-row blocks changed since the last save:
+//   16-byte header ('DODD', version, header bytes, columns, block count) | column types |
+//   manifest (u32 block ids) | per block: u64 live-row mask + cells of the live rows | CRC32
+// It writes nothing when no block is dirty and clears the dirty bits on success.
+// doda_persist_load_table() applies the deltas that follow the base in order, stopping at a
+// short read or an unwritten (non-'DODD') header; a torn delta fails with
+// DODA_PERSIST_ERR_CORRUPT and leaves the table partly updated.
+// Deltas append at the cursor (write_all, writev or borrow); a backend with only write_at
+// gets DODA_PERSIST_ERR_INVALID. After a load start a new base before appending deltas.
+DodaPersistStatus doda_persist_save_delta(DodaTable *t, const DodaStorage *st);
 
 // Size estimation for persistence payload (worst-case, includes header)
 // Useful for preallocating flash pages/buffers.
 size_t doda_persist_estimate_max_bytes(const DodaTable *t);
 
+// Sealed compressed blocks (doda_compress.h) are written as encoded, behind a 16-byte header
+// (magic, version, block bytes, CRC32 of the block). Loading reads the block into buf
+// (cap bytes) and opens it in place, so out->data points into buf; a backend with borrow lends
+// the block instead and out->data points into the medium (buf is then unused).
+#define DODA_PERSIST_BLOCK_HEADER_BYTES 16u
+DodaPersistStatus doda_persist_save_block(const DodaSealedBlock *b, const DodaStorage *st);
+DodaPersistStatus doda_persist_load_block(DodaSealedBlock *out, uint8_t *buf, size_t cap, const DodaStorage *st);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2025 Rohit Ballurgi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software... [rest of standard MIT short-text]
+ * ...
+ * MIT License (see LICENSE file for full text)
+ */
+
+#include "doda_ring.h"
+
+#include <string.h>
+
+#ifdef DRIVERSQL_TIMESERIES
+
+#if !defined(__GNUC__) && !defined(__clang__)
+#error "doda_ring needs the GCC/Clang __atomic builtins"
+#endif
+
+DodaStatus doda_ts_ring_init(DodaTSRing *r, DodaTSSample *slots, uint32_t *seqs, size_t capacity) {
+    if (!r || !slots || capacity < 2u || (capacity & (capacity - 1u)) || capacity > 0x80000000u) return DodaStatus_ERR_INVALID;
+    memset(r, 0, sizeof(*r));
+    r->slots = slots; r->seqs = seqs; r->mask = (uint32_t)(capacity - 1u);
+    // MPSC: slot i is free for the producer that claims position i
+    if (seqs) for (size_t i = 0; i < capacity; ++i) seqs[i] = (uint32_t)i;
+    return DodaStatus_OK;
+}
+
+bool doda_ts_ring_push(DodaTSRing *r, int id, int time, int value) {
+    uint32_t pos = __atomic_load_n(&r->head, __ATOMIC_RELAXED);
+    if (!r->seqs) {
+        if (pos - __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE) > r->mask) { __atomic_fetch_add(&r->dropped, 1u, __ATOMIC_RELAXED); return false; }
+        DodaTSSample *s = &r->slots[pos & r->mask];
+        s->id = id; s->time = time; s->value = value;
+        __atomic_store_n(&r->head, pos + 1u, __ATOMIC_RELEASE);
+        return true;
+    }
+    // Slot sequence == pos: free for this lap; < pos: the consumer has not drained it yet (full)
+    for (;;) {
+        int32_t diff = (int32_t)(__atomic_load_n(&r->seqs[pos & r->mask], __ATOMIC_ACQUIRE) - pos);
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&r->head, &pos, pos + 1u, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+        } else if (diff < 0) {
+            __atomic_fetch_add(&r->dropped, 1u, __ATOMIC_RELAXED); return false;
+        } else {
+            pos = __atomic_load_n(&r->head, __ATOMIC_RELAXED);
+        }
+    }
+    DodaTSSample *s = &r->slots[pos & r->mask];
+    s->id = id; s->time = time; s->value = value;
+    __atomic_store_n(&r->seqs[pos & r->mask], pos + 1u, __ATOMIC_RELEASE);
+    return true;
+}
+
+// Batch in column order, ready for doda_insert_columns
+typedef struct { int id[DODA_TS_RING_BATCH], time[DODA_TS_RING_BATCH], value[DODA_TS_RING_BATCH]; } RingBatch;
+
+static inline void batch_put(RingBatch *b, uint32_t k, const DodaTSSample *s) { b->id[k] = s->id; b->time[k] = s->time; b->value[k] = s->value; }
+
+// Copy up to lim ready samples starting at tail and give their slots back to producers
+static uint32_t take_batch(DodaTSRing *r, RingBatch *batch, uint32_t lim) {
+    uint32_t tail = r->tail, n = 0, waiting;
+    if (!r->seqs) {
+        waiting = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE) - tail;
+        n = waiting < lim ? waiting : lim;
+        for (uint32_t k = 0; k < n; ++k) batch_put(batch, k, &r->slots[(tail + k) & r->mask]);
+    } else {
+        waiting = __atomic_load_n(&r->head, __ATOMIC_RELAXED) - tail;
+        for (; n < lim; ++n) {
+            uint32_t i = (tail + n) & r->mask;
+            if (__atomic_load_n(&r->seqs[i], __ATOMIC_ACQUIRE) != tail + n + 1u) break;
+            batch_put(batch, n, &r->slots[i]);
+        }
+        for (uint32_t k = 0; k < n; ++k) __atomic_store_n(&r->seqs[(tail + k) & r->mask], tail + k + r->mask + 1u, __ATOMIC_RELEASE);
+    }
+    if (waiting > r->high_water) r->high_water = waiting;
+    __atomic_store_n(&r->tail, tail + n, __ATOMIC_RELEASE);
+    return n;
+}
+
+size_t doda_ts_ring_drain(DodaTSRing *r, DodaTSDB *ts, size_t max) {
+    if (!r || !ts) return 0;
+    RingBatch batch;
+    size_t total = 0;
+    // Plain mode appends a batch with one columnar insert; chunks take it row by row
+    bool columnar = !ts->chunks && ts->table && ts->table->column_count == 3;
+    for (;;) {
+        size_t left = max ? max - total : DODA_TS_RING_BATCH;
+        uint32_t n = take_batch(r, &batch, left < DODA_TS_RING_BATCH ? (uint32_t)left : DODA_TS_RING_BATCH);
+        if (n == 0) break;
+        if (columnar) {
+            const void *cols[3] = {batch.id, batch.time, batch.value}; size_t inserted = 0;
+            doda_insert_columns(ts->table, n, cols, NULL, &inserted);
+            r->rejected += n - inserted;
+        } else {
+            for (uint32_t k = 0; k < n; ++k)
+                if (doda_tsdb_append_int3(ts, batch.id[k], batch.time[k], batch.value[k]) != DodaStatus_OK) r->rejected++;
+        }
+        r->drained += n; total += n;
+        if (max && total >= max) break;
+    }
+    return total;
+}
+
+size_t doda_ts_ring_pending(const DodaTSRing *r) {
+    return r ? (size_t)(__atomic_load_n(&r->head, __ATOMIC_ACQUIRE) - __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE)) : 0;
+}
+
+void doda_ts_ring_stats(const DodaTSRing *r, DodaTSRingStats *out) {
+    if (!out) return;
+    memset(out, 0, sizeof(*out));
+    if (!r) return;
+    out->pushed = __atomic_load_n(&r->head, __ATOMIC_RELAXED);
+    out->dropped = __atomic_load_n(&r->dropped, __ATOMIC_RELAXED);
+    out->pending = (uint32_t)doda_ts_ring_pending(r);
+    out->high_water = r->high_water;
+    out->drained = r->drained; out->rejected = r->rejected;
+}
+
+#endif // DRIVERSQL_TIMESERIES
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2025 Rohit Ballurgi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software... [rest of standard MIT short-text]
+ * ...
+ * MIT License (see LICENSE file for full text)
+ */
+
+#pragma once
+#include "doda_api.h"
+
+#ifdef DRIVERSQL_TIMESERIES
+
+// Ingestion ring in front of a DodaTSDB: producers (ISRs, driver threads) push fixed-size
+// samples without touching the table, and the owner of the table drains them in batches.
+//
+// Slots live in caller memory; capacity is a power of two and indices run freely modulo
+// 2^32. Two modes:
+// - SPSC (seqs == NULL): one producer, one consumer. A push is a few plain stores and one
+//   release store of head; it never waits, so it is safe from an ISR.
+// - MPSC (seqs given): any number of producers claim slots with one CAS on head; each slot's
+//   sequence word tells the consumer when its sample is complete (bounded Vyukov queue).
+// A push into a full ring fails (backpressure) and counts a drop. The drain copies up to
+// DODA_TS_RING_BATCH samples out in column order, hands the slots back to producers with one
+// store, and appends the batch with one doda_insert_columns (plain mode) or row by row
+// (chunked mode). Needs the GCC/Clang __atomic builtins.
+
+#ifndef DODA_TS_RING_BATCH
+#define DODA_TS_RING_BATCH 64u
+#endif
+#define DODA_TS_RING_LINE 64u   // producer and consumer fields sit on separate cache lines
+
+typedef struct { int id; int time; int value; } DodaTSSample;  // one doda_tsdb_append_int3 row
+
+typedef struct {
+    DodaTSSample *slots;
+    uint32_t *seqs;          // MPSC slot sequence words (capacity entries); NULL for SPSC
+    uint32_t mask;           // capacity - 1
+    uint8_t pad0[DODA_TS_RING_LINE];
+    uint32_t head;           // next slot to claim (producers)
+    uint32_t dropped;        // pushes refused because the ring was full
+    uint8_t pad1[DODA_TS_RING_LINE];
+    uint32_t tail;           // next slot to drain (consumer)
+    uint32_t high_water;     // most samples seen waiting by a drain
+    uint64_t drained;        // samples taken out of the ring
+    uint64_t rejected;       // drained samples the table refused (full, duplicate id)
+} DodaTSRing;
+
+typedef struct {
+    uint32_t pushed;         // accepted pushes (wraps at 2^32)
+    uint32_t dropped;
+    uint32_t pending;        // waiting now
+    uint32_t high_water;
+    uint64_t drained, rejected;
+} DodaTSRingStats;
+
+// capacity: power of two >= 2; seqs: NULL (SPSC) or capacity words (MPSC)
+DodaStatus doda_ts_ring_init(DodaTSRing *r, DodaTSSample *slots, uint32_t *seqs, size_t capacity);
+// Producer side: false (and a drop counted) when the ring is full
+bool doda_ts_ring_push(DodaTSRing *r, int id, int time, int value);
+// Consumer side: append up to max waiting samples (0 = all) to ts; returns the samples taken
+size_t doda_ts_ring_drain(DodaTSRing *r, DodaTSDB *ts, size_t max);
+size_t doda_ts_ring_pending(const DodaTSRing *r);
+void doda_ts_ring_stats(const DodaTSRing *r, DodaTSRingStats *out);
+
+#endif // DRIVERSQL_TIMESERIES
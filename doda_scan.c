@@ -0,0 +1,272 @@
+/*
+ * Copyright (c) 2025 Rohit Ballurgi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software... [rest of standard MIT short-text]
+ * ...
+ * MIT License (see LICENSE file for full text)
+ */
+
+#include "doda_scan.h"
+
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SCAN_KERNEL "avx2"
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define SCAN_KERNEL "sse2"
+#else
+#define SCAN_KERNEL "scalar"
+#endif
+
+const char *scan_kernel_name(void) { return SCAN_KERNEL; }
+
+// Scalar kernels (also the tail of the vector paths). The op switch sits outside
+// the loop so each loop body is a branch-free compare-and-shift.
+#define SCAN_LOOP(expr) for (size_t i = start; i < n; ++i) m |= (uint64_t)(expr) << i
+
+#define DEFINE_SCAN_SCALAR(name, T) \
+static uint64_t name(const T *v, size_t start, size_t n, Op op, T key) { \
+    uint64_t m = 0; \
+    switch (op) { \
+        case OP_EQ:  SCAN_LOOP(v[i] == key); break; \
+        case OP_GT:  SCAN_LOOP(v[i] > key); break; \
+        case OP_LT:  SCAN_LOOP(v[i] < key); break; \
+        case OP_GTE: SCAN_LOOP(v[i] >= key); break; \
+        case OP_LTE: SCAN_LOOP(v[i] <= key); break; \
+        case OP_NE:  SCAN_LOOP(v[i] != key); break; \
+        default: break; \
+    } \
+    return m; \
+}
+
+DEFINE_SCAN_SCALAR(scan_scalar_int, int)
+#ifndef DRIVERSQL_NO_FLOAT
+DEFINE_SCAN_SCALAR(scan_scalar_float, float)
+#endif
+#ifndef DRIVERSQL_NO_DOUBLE
+DEFINE_SCAN_SCALAR(scan_scalar_double, double)
+#endif
+
+uint64_t scan_mask_int(const int *v, size_t n, Op op, int key) {
+    size_t i = 0; uint64_t m = 0;
+#if defined(__AVX2__)
+    const __m256i k = _mm256_set1_epi32(key), ones = _mm256_set1_epi32(-1);
+    for (; i + 8u <= n; i += 8u) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(const void *)(v + i)), c;
+        switch (op) {
+            case OP_EQ:  c = _mm256_cmpeq_epi32(x, k); break;
+            case OP_GT:  c = _mm256_cmpgt_epi32(x, k); break;
+            case OP_LT:  c = _mm256_cmpgt_epi32(k, x); break;
+            case OP_GTE: c = _mm256_xor_si256(_mm256_cmpgt_epi32(k, x), ones); break;
+            case OP_LTE: c = _mm256_xor_si256(_mm256_cmpgt_epi32(x, k), ones); break;
+            case OP_NE:  c = _mm256_xor_si256(_mm256_cmpeq_epi32(x, k), ones); break;
+            default: return 0;
+        }
+        m |= (uint64_t)(uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(c)) << i;
+    }
+#elif defined(__SSE2__)
+    const __m128i k = _mm_set1_epi32(key), ones = _mm_set1_epi32(-1);
+    for (; i + 4u <= n; i += 4u) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(const void *)(v + i)), c;
+        switch (op) {
+            case OP_EQ:  c = _mm_cmpeq_epi32(x, k); break;
+            case OP_GT:  c = _mm_cmpgt_epi32(x, k); break;
+            case OP_LT:  c = _mm_cmplt_epi32(x, k); break;
+            case OP_GTE: c = _mm_xor_si128(_mm_cmplt_epi32(x, k), ones); break;
+            case OP_LTE: c = _mm_xor_si128(_mm_cmpgt_epi32(x, k), ones); break;
+            case OP_NE:  c = _mm_xor_si128(_mm_cmpeq_epi32(x, k), ones); break;
+            default: return 0;
+        }
+        m |= (uint64_t)(uint32_t)_mm_movemask_ps(_mm_castsi128_ps(c)) << i;
+    }
+#endif
+    return m | scan_scalar_int(v, i, n, op, key);
+}
+
+#ifndef DRIVERSQL_NO_FLOAT
+uint64_t scan_mask_float(const float *v, size_t n, Op op, float key) {
+    size_t i = 0; uint64_t m = 0;
+#if defined(__AVX2__)
+    const __m256 k = _mm256_set1_ps(key);
+    for (; i + 8u <= n; i += 8u) {
+        __m256 x = _mm256_loadu_ps(v + i), c;
+        switch (op) {
+            case OP_EQ:  c = _mm256_cmp_ps(x, k, _CMP_EQ_OQ); break;
+            case OP_GT:  c = _mm256_cmp_ps(x, k, _CMP_GT_OQ); break;
+            case OP_LT:  c = _mm256_cmp_ps(x, k, _CMP_LT_OQ); break;
+            case OP_GTE: c = _mm256_cmp_ps(x, k, _CMP_GE_OQ); break;
+            case OP_LTE: c = _mm256_cmp_ps(x, k, _CMP_LE_OQ); break;
+            case OP_NE:  c = _mm256_cmp_ps(x, k, _CMP_NEQ_UQ); break;
+            default: return 0;
+        }
+        m |= (uint64_t)(uint32_t)_mm256_movemask_ps(c) << i;
+    }
+#elif defined(__SSE2__)
+    const __m128 k = _mm_set1_ps(key);
+    for (; i + 4u <= n; i += 4u) {
+        __m128 x = _mm_loadu_ps(v + i), c;
+        switch (op) {
+            case OP_EQ:  c = _mm_cmpeq_ps(x, k); break;
+            case OP_GT:  c = _mm_cmpgt_ps(x, k); break;
+            case OP_LT:  c = _mm_cmplt_ps(x, k); break;
+            case OP_GTE: c = _mm_cmpge_ps(x, k); break;
+            case OP_LTE: c = _mm_cmple_ps(x, k); break;
+            case OP_NE:  c = _mm_cmpneq_ps(x, k); break;
+            default: return 0;
+        }
+        m |= (uint64_t)(uint32_t)_mm_movemask_ps(c) << i;
+    }
+#endif
+    return m | scan_scalar_float(v, i, n, op, key);
+}
+#endif
+
+#ifndef DRIVERSQL_NO_DOUBLE
+uint64_t scan_mask_double(const double *v, size_t n, Op op, double key) {
+    size_t i = 0; uint64_t m = 0;
+#if defined(__AVX2__)
+    const __m256d k = _mm256_set1_pd(key);
+    for (; i + 4u <= n; i += 4u) {
+        __m256d x = _mm256_loadu_pd(v + i), c;
+        switch (op) {
+            case OP_EQ:  c = _mm256_cmp_pd(x, k, _CMP_EQ_OQ); break;
+            case OP_GT:  c = _mm256_cmp_pd(x, k, _CMP_GT_OQ); break;
+            case OP_LT:  c = _mm256_cmp_pd(x, k, _CMP_LT_OQ); break;
+            case OP_GTE: c = _mm256_cmp_pd(x, k, _CMP_GE_OQ); break;
+            case OP_LTE: c = _mm256_cmp_pd(x, k, _CMP_LE_OQ); break;
+            case OP_NE:  c = _mm256_cmp_pd(x, k, _CMP_NEQ_UQ); break;
+            default: return 0;
+        }
+        m |= (uint64_t)(uint32_t)_mm256_movemask_pd(c) << i;
+    }
+#elif defined(__SSE2__)
+    const __m128d k = _mm_set1_pd(key);
+    for (; i + 2u <= n; i += 2u) {
+        __m128d x = _mm_loadu_pd(v + i), c;
+        switch (op) {
+            case OP_EQ:  c = _mm_cmpeq_pd(x, k); break;
+            case OP_GT:  c = _mm_cmpgt_pd(x, k); break;
+            case OP_LT:  c = _mm_cmplt_pd(x, k); break;
+            case OP_GTE: c = _mm_cmpge_pd(x, k); break;
+            case OP_LTE: c = _mm_cmple_pd(x, k); break;
+            case OP_NE:  c = _mm_cmpneq_pd(x, k); break;
+            default: return 0;
+        }
+        m |= (uint64_t)(uint32_t)_mm_movemask_pd(c) << i;
+    }
+#endif
+    return m | scan_scalar_double(v, i, n, op, key);
+}
+#endif
+
+bool scan_type_supported(ColumnType ct) {
+    switch (ct) {
+        case COL_INT: return true;
+#ifndef DRIVERSQL_NO_FLOAT
+        case COL_FLOAT: return true;
+#endif
+#ifndef DRIVERSQL_NO_DOUBLE
+        case COL_DOUBLE: return true;
+#endif
+        default: return false;
+    }
+}
+
+// Size of one key in a predicate value (OP_BETWEEN reads hi right after lo)
+static size_t scan_key_bytes(ColumnType ct) {
+    switch (ct) {
+#ifndef DRIVERSQL_NO_TEXT
+        case COL_TEXT: return MAX_TEXT_LEN;
+#endif
+#ifndef DRIVERSQL_NO_FLOAT
+        case COL_FLOAT: return sizeof(float);
+#endif
+#ifndef DRIVERSQL_NO_DOUBLE
+        case COL_DOUBLE: return sizeof(double);
+#endif
+#ifndef DRIVERSQL_NO_POINTER_COLUMN
+        case COL_POINTER: return sizeof(void *);
+#endif
+        default: return sizeof(int);
+    }
+}
+
+#define OP_HOLDS(a, op, b) ((op) == OP_EQ ? (a) == (b) : (op) == OP_GT ? (a) > (b) : (op) == OP_LT ? (a) < (b) : \
+                            (op) == OP_GTE ? (a) >= (b) : (op) == OP_LTE ? (a) <= (b) : (op) == OP_NE ? (a) != (b) : false)
+#define EQ_HOLDS(eq, op) ((op) == OP_EQ ? (eq) : (op) == OP_NE ? !(eq) : false)
+
+bool scan_cell_matches(const Column *c, size_t r, Op op, const void *value) {
+    if (op == OP_BETWEEN) return scan_cell_matches(c, r, OP_GTE, value) && scan_cell_matches(c, r, OP_LTE, (const char *)value + scan_key_bytes(c->type));
+    switch (c->type) {
+        case COL_INT: return OP_HOLDS(c->data.int_data[r], op, *(const int *)value);
+#ifndef DRIVERSQL_NO_FLOAT
+        case COL_FLOAT: return OP_HOLDS(c->data.float_data[r], op, *(const float *)value);
+#endif
+#ifndef DRIVERSQL_NO_DOUBLE
+        case COL_DOUBLE: return OP_HOLDS(c->data.double_data[r], op, *(const double *)value);
+#endif
+#ifndef DRIVERSQL_NO_TEXT
+        case COL_TEXT: return EQ_HOLDS(strncmp(c->data.text_data[r], (const char *)value, MAX_TEXT_LEN) == 0, op);
+#endif
+        case COL_BOOL: return EQ_HOLDS(c->data.bool_data[r] == (uint8_t)(*(const int *)value != 0), op);
+#ifndef DRIVERSQL_NO_POINTER_COLUMN
+        case COL_POINTER: return EQ_HOLDS(c->data.ptr_data[r] == value, op);
+#endif
+        default: return false;
+    }
+}
+
+static double scan_key_double(ColumnType ct, const void *key) {
+    switch (ct) {
+#ifndef DRIVERSQL_NO_FLOAT
+        case COL_FLOAT: return (double)*(const float *)key;
+#endif
+#ifndef DRIVERSQL_NO_DOUBLE
+        case COL_DOUBLE: return *(const double *)key;
+#endif
+        default: return (double)*(const int *)key;
+    }
+}
+
+// False when no cell in the zone-map block of `base` can satisfy `op value`. INT and FLOAT
+// widen exactly to double; a NaN key fails every test but <>, like the cells would.
+static bool scan_zone_may_match(const Column *c, size_t base, Op op, const void *value) {
+    const double *z = c->zone + 2u * (base / DODA_SCAN_WORD);
+    double lo = z[0], hi = z[1], k = scan_key_double(c->type, value);
+    switch (op) {
+        case OP_EQ:  return lo <= k && k <= hi;
+        case OP_GT:  return hi > k;
+        case OP_LT:  return lo < k;
+        case OP_GTE: return hi >= k;
+        case OP_LTE: return lo <= k;
+        case OP_NE:  return !(lo == k && hi == k);
+        case OP_BETWEEN: return hi >= k && lo <= scan_key_double(c->type, (const char *)value + scan_key_bytes(c->type));
+        default: return true;
+    }
+}
+
+uint64_t scan_column_word(const Column *c, size_t base, size_t n, Op op, const void *value) {
+    if (!scan_type_supported(c->type)) {
+        uint64_t m = 0;
+        for (size_t i = 0; i < n; ++i) m |= (uint64_t)scan_cell_matches(c, base + i, op, value) << i;
+        return m;
+    }
+    if (c->zone && !scan_zone_may_match(c, base, op, value)) return 0;
+    if (op == OP_BETWEEN) {
+        const char *hi = (const char *)value + scan_key_bytes(c->type);
+        return scan_column_word(c, base, n, OP_GTE, value) & scan_column_word(c, base, n, OP_LTE, hi);
+    }
+    switch (c->type) {
+        case COL_INT: return scan_mask_int(c->data.int_data + base, n, op, *(const int *)value);
+#ifndef DRIVERSQL_NO_FLOAT
+        case COL_FLOAT: return scan_mask_float(c->data.float_data + base, n, op, *(const float *)value);
+#endif
+#ifndef DRIVERSQL_NO_DOUBLE
+        case COL_DOUBLE: return scan_mask_double(c->data.double_data + base, n, op, *(const double *)value);
+#endif
+        default: return 0;
+    }
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2025 Rohit Ballurgi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software... [rest of standard MIT short-text]
+ * ...
+ * MIT License (see LICENSE file for full text)
+ */
+
+#pragma once
+#include "doda_engine.h"
+
+// Predicate scan kernels used by the query paths.
+//
+// Each kernel compares up to 64 consecutive cells against a key and returns a
+// selection bitmap (bit i set = v[i] matches), aligned with one deleted_bits word.
+// Callers AND it with ~deleted_bits[w] and walk the set bits.
+//
+// Implementation is picked at build time: AVX2 when compiled with -mavx2
+// (or CMake DODA_SIMD_NATIVE=ON), SSE2 on other x86-64, portable scalar elsewhere
+// (ARM/NEON builds use the scalar loops, which compilers auto-vectorize).
+
+#define DODA_SCAN_WORD 64u
+
+uint64_t scan_mask_int(const int *v, size_t n, Op op, int key);
+#ifndef DRIVERSQL_NO_FLOAT
+uint64_t scan_mask_float(const float *v, size_t n, Op op, float key);
+#endif
+#ifndef DRIVERSQL_NO_DOUBLE
+uint64_t scan_mask_double(const double *v, size_t n, Op op, double key);
+#endif
+
+// Column-level dispatch: bitmap for cells [base, base + n) of any column (value points at a key
+// of the column's type, or two for OP_BETWEEN). scan_type_supported() tells whether a vector
+// kernel exists; other types (TEXT/BOOL/POINTER: EQ/NE only) are tested cell by cell.
+// Columns with a zone map return 0 without reading cells when their block's min/max rules the
+// predicate out; base must then be a multiple of DODA_SCAN_WORD.
+bool scan_type_supported(ColumnType ct);
+uint64_t scan_column_word(const Column *c, size_t base, size_t n, Op op, const void *value);
+bool scan_cell_matches(const Column *c, size_t r, Op op, const void *value);
+
+// Name of the compiled-in kernel set ("avx2", "sse2", "scalar")
+const char *scan_kernel_name(void);
+
+// Bits valid in the word starting at row `base` of a table with `count` rows
+static inline uint64_t scan_tail_mask(size_t base, size_t count) {
+    size_t n = count - base; return n >= DODA_SCAN_WORD ? ~0ULL : ((1ULL << n) - 1ULL);
+}
+
+static inline unsigned scan_popcount64(uint64_t m) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_popcountll(m);
+#else
+    unsigned n = 0; while (m) { m &= m - 1u; n++; } return n;
+#endif
+}
+
+static inline unsigned scan_ctz64(uint64_t m) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_ctzll(m);
+#else
+    unsigned n = 0; while (!(m & 1ULL)) { m >>= 1; n++; } return n;
+#endif
+}
@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2025 Rohit Ballurgi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software... [rest of standard MIT short-text]
+ * ...
+ * MIT License (see LICENSE file for full text)
+ */
+
+#include "doda_shared.h"
+
+#include <string.h>
+
+#ifdef DRIVERSQL_THREADS
+
+#if !defined(__GNUC__) && !defined(__clang__)
+#error "DRIVERSQL_THREADS needs the GCC/Clang __atomic builtins"
+#endif
+
+static inline void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || (defined(__arm__) && defined(__ARM_ARCH) && __ARM_ARCH >= 7)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+void doda_shared_init(DodaSharedTable *s, Table *t) {
+    memset(s, 0, sizeof(*s));
+    s->table = t;
+}
+
+static void lock_acquire(DodaSharedTable *s) {
+    while (__atomic_exchange_n(&s->lock, 1u, __ATOMIC_ACQUIRE)) {
+        while (__atomic_load_n(&s->lock, __ATOMIC_RELAXED)) cpu_relax();
+    }
+}
+
+static void lock_release(DodaSharedTable *s) { __atomic_store_n(&s->lock, 0u, __ATOMIC_RELEASE); }
+
+// Seqlock protocol (release/acquire fences around plain table accesses):
+//   writer: lock, seq -> odd, fence(release), mutate, store(seq + 1, release), unlock
+//   reader: s0 = load(acquire) (even), read, fence(acquire), retry unless seq == s0
+void doda_shared_write_begin(DodaSharedTable *s) {
+    lock_acquire(s);
+    __atomic_store_n(&s->seq, __atomic_load_n(&s->seq, __ATOMIC_RELAXED) + 1u, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+void doda_shared_write_end(DodaSharedTable *s) {
+    __atomic_store_n(&s->seq, __atomic_load_n(&s->seq, __ATOMIC_RELAXED) + 1u, __ATOMIC_RELEASE);
+    lock_release(s);
+}
+
+DSStatus doda_shared_insert_row(DodaSharedTable *s, const void *values[]) {
+    doda_shared_write_begin(s);
+    DSStatus st = insert_row(s->table, values);
+    doda_shared_write_end(s);
+    return st;
+}
+
+DSStatus doda_shared_delete_row(DodaSharedTable *s, size_t row) {
+    doda_shared_write_begin(s);
+    DSStatus st = delete_row(s->table, row);
+    doda_shared_write_end(s);
+    return st;
+}
+
+DSStatus doda_shared_delete_where_eq(DodaSharedTable *s, const char *col_name, const void *eq_value, size_t *deleted_out) {
+    doda_shared_write_begin(s);
+    DSStatus st = delete_where_eq(s->table, col_name, eq_value, deleted_out);
+    doda_shared_write_end(s);
+    return st;
+}
+
+uint32_t doda_shared_read_begin(const DodaSharedTable *s) {
+    for (;;) {
+        uint32_t seq = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE);
+        if (!(seq & 1u)) return seq;
+        cpu_relax();
+    }
+}
+
+bool doda_shared_read_validate(const DodaSharedTable *s, uint32_t seq) {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&s->seq, __ATOMIC_RELAXED) == seq;
+}
+
+DSStatus doda_shared_read(DodaSharedTable *s, doda_shared_read_fn fn, void *user) {
+    if (!s || !fn) return DS_ERR_INVALID;
+    for (unsigned tries = 0; tries < DODA_SHARED_READ_TRIES; ++tries) {
+        uint32_t seq = doda_shared_read_begin(s);
+        DSStatus st = fn(s->table, user);
+        if (doda_shared_read_validate(s, seq)) return st;
+        __atomic_fetch_add(&s->read_retries, 1u, __ATOMIC_RELAXED);
+    }
+    // Writers are held off without moving seq, so optimistic readers carry on meanwhile
+    lock_acquire(s);
+    DSStatus st = fn(s->table, user);
+    lock_release(s);
+    __atomic_fetch_add(&s->read_locked, 1u, __ATOMIC_RELAXED);
+    return st;
+}
+
+typedef struct {
+    const Predicate *preds; size_t npreds;
+    const Index *idx; Op op; const void *value;
+    uint32_t *row_ids; size_t cap, count;
+    IndexStatus ist;
+} SharedSelect;
+
+#define SHARED_SPILL 64u
+
+static DSStatus read_select(const Table *t, void *user) {
+    SharedSelect *q = (SharedSelect *)user;
+    SelectCursor cur; select_cursor_init(&cur);
+    uint32_t spill[SHARED_SPILL]; // matches past cap are counted, not kept
+    size_t n; DSStatus st;
+    q->count = 0;
+    for (;;) {
+        bool room = q->count < q->cap;
+        st = select_into_all(t, q->preds, q->npreds, room ? q->row_ids + q->count : spill, room ? q->cap - q->count : SHARED_SPILL, &cur, &n);
+        if (st != DS_OK || n == 0) return st;
+        q->count += n;
+    }
+}
+
+DSStatus doda_shared_select_all(DodaSharedTable *s, const Predicate *preds, size_t npreds, uint32_t *row_ids, size_t cap, size_t *count_out) {
+    if (!row_ids || !count_out) return DS_ERR_INVALID;
+    SharedSelect q; memset(&q, 0, sizeof(q));
+    q.preds = preds; q.npreds = npreds; q.row_ids = row_ids; q.cap = cap;
+    DSStatus st = doda_shared_read(s, read_select, &q);
+    *count_out = q.count;
+    return st;
+}
+
+static void collect_row(const Table *t, size_t row, void *user) {
+    (void)t;
+    SharedSelect *q = (SharedSelect *)user;
+    if (q->count < q->cap) q->row_ids[q->count] = (uint32_t)row;
+    q->count++;
+}
+
+static DSStatus read_index_select(const Table *t, void *user) {
+    SharedSelect *q = (SharedSelect *)user;
+    q->count = 0;
+    q->ist = index_select_op(t, q->idx, q->op, q->value, collect_row, q);
+    return DS_OK;
+}
+
+IndexStatus doda_shared_index_select_op(DodaSharedTable *s, const Index *idx, Op op, const void *value, uint32_t *row_ids, size_t cap, size_t *count_out) {
+    if (!s || !row_ids || !count_out) return IDX_UNSUPPORTED;
+    SharedSelect q; memset(&q, 0, sizeof(q));
+    q.idx = idx; q.op = op; q.value = value; q.row_ids = row_ids; q.cap = cap;
+    doda_shared_read(s, read_index_select, &q);
+    *count_out = q.count;
+    return q.ist;
+}
+
+typedef struct {
+    const char **col_names; size_t ncols;
+    const Predicate *filters; size_t nfilters;
+    AggResult *out;
+} SharedAgg;
+
+static DSStatus read_agg(const Table *t, void *user) {
+    SharedAgg *q = (SharedAgg *)user;
+    return agg_columns(t, q->col_names, q->ncols, q->filters, q->nfilters, q->out);
+}
+
+DSStatus doda_shared_agg_columns(DodaSharedTable *s, const char **col_names, size_t ncols, const Predicate *filters, size_t nfilters, AggResult *out) {
+    SharedAgg q = { col_names, ncols, filters, nfilters, out };
+    return doda_shared_read(s, read_agg, &q);
+}
+
+#endif // DRIVERSQL_THREADS
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2025 Rohit Ballurgi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software... [rest of standard MIT short-text]
+ * ...
+ * MIT License (see LICENSE file for full text)
+ */
+
+#pragma once
+#include "doda_engine.h"
+#include "doda_agg.h"
+
+// Enable this module with -DDRIVERSQL_THREADS (GCC/Clang __atomic builtins)
+#ifdef DRIVERSQL_THREADS
+
+// Shared table: one writer at a time, any number of lock-free readers.
+//
+// A sequence counter guards the table (a seqlock). Writers take a spin lock, make the counter
+// odd for the length of a mutation and even again afterwards. Readers never write shared
+// state: they note an even counter, run the query, and rerun it if the counter moved. A
+// reader therefore sees exactly the table as it was between two write sections. A reader
+// that failed DODA_SHARED_READ_TRIES times in a row (a long scan against a busy writer)
+// takes the writer lock for one pass instead, so it cannot starve.
+//
+// While a write section is open, a reader can look at a half-updated table. The read paths
+// stay in bounds on such a table (counts never exceed capacity, index entries are always row
+// ids), so a torn pass only costs a retry; its results are never handed out. Read
+// functions must stay side-effect free for the same reason: they may run more than once.
+// Memory is never freed while the table lives, so no reclamation epochs are needed.
+//
+// Build or attach indexes, change the schema and free the table only while no reader runs.
+
+#ifndef DODA_SHARED_READ_TRIES
+#define DODA_SHARED_READ_TRIES 8
+#endif
+
+typedef struct {
+    Table *table;
+    uint32_t seq;           // even: stable; odd: a writer is inside
+    uint32_t lock;          // writer lock (also taken by starving readers)
+    uint64_t read_retries;  // optimistic reads that had to rerun (relaxed counter)
+    uint64_t read_locked;   // reads that fell back to the writer lock (relaxed counter)
+} DodaSharedTable;
+
+void doda_shared_init(DodaSharedTable *s, Table *t);
+
+// Writer side. Anything that mutates the table goes between begin and end; the wrappers
+// below open one section per call.
+void doda_shared_write_begin(DodaSharedTable *s);
+void doda_shared_write_end(DodaSharedTable *s);
+DSStatus doda_shared_insert_row(DodaSharedTable *s, const void *values[]);
+DSStatus doda_shared_delete_row(DodaSharedTable *s, size_t row);
+DSStatus doda_shared_delete_where_eq(DodaSharedTable *s, const char *col_name, const void *eq_value, size_t *deleted_out);
+
+// Reader side. fn runs against a consistent table and reruns until no writer interfered;
+// it must only fill `user` (reset it on entry). Returns fn's last status.
+typedef DSStatus (*doda_shared_read_fn)(const Table *t, void *user);
+DSStatus doda_shared_read(DodaSharedTable *s, doda_shared_read_fn fn, void *user);
+// Open-coded form: seq = read_begin(); ...reads...; retry while !read_validate(seq)
+uint32_t doda_shared_read_begin(const DodaSharedTable *s);
+bool doda_shared_read_validate(const DodaSharedTable *s, uint32_t seq);
+
+// Consistent-snapshot queries. Row ids go to row_ids[0..cap); *count_out receives the
+// number of matches, which exceeds cap when the buffer was too small.
+DSStatus doda_shared_select_all(DodaSharedTable *s, const Predicate *preds, size_t npreds, uint32_t *row_ids, size_t cap, size_t *count_out);
+IndexStatus doda_shared_index_select_op(DodaSharedTable *s, const Index *idx, Op op, const void *value, uint32_t *row_ids, size_t cap, size_t *count_out);
+DSStatus doda_shared_agg_columns(DodaSharedTable *s, const char **col_names, size_t ncols, const Predicate *filters, size_t nfilters, AggResult *out);
+
+#endif // DRIVERSQL_THREADS
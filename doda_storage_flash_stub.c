@@ -32,6 +32,27 @@ static bool flash_read_all(void *vctx, void *data, size_t size) {
     return true;
 }
 
+// Gather write: programs the pieces back to back from the cursor
+static bool flash_writev(void *vctx, const DodaIoVec *iov, size_t count) {
+    for (size_t i = 0; i < count; ++i) if (!flash_write_all(vctx, iov[i].data, iov[i].size)) return false;
+    return true;
+}
+
+// Positional access (does not move the cursor)
+static bool flash_write_at(void *vctx, uint64_t offset, const void *data, size_t size) {
+    DodaFlashStorageCtx *ctx = (DodaFlashStorageCtx *)vctx;
+    if (!ctx->flash_program) return false;
+    if (offset > ctx->region_size || size > ctx->region_size - (size_t)offset) return false;
+    return ctx->flash_program(ctx->base_addr + (uintptr_t)offset, data, size);
+}
+
+static bool flash_read_at(void *vctx, uint64_t offset, void *data, size_t size) {
+    DodaFlashStorageCtx *ctx = (DodaFlashStorageCtx *)vctx;
+    if (!ctx->flash_read) return false;
+    if (offset > ctx->region_size || size > ctx->region_size - (size_t)offset) return false;
+    return ctx->flash_read(ctx->base_addr + (uintptr_t)offset, data, size);
+}
+
 void doda_flash_storage_init(DodaStorage *out, DodaFlashStorageCtx *ctx) {
     if (!out || !ctx) return;
     // Reset cursor so first operation starts at offset 0
@@ -40,4 +61,121 @@ void doda_flash_storage_init(DodaStorage *out, DodaFlashStorageCtx *ctx) {
     out->write_all = flash_write_all;
     out->read_all = flash_read_all;
     out->erase = flash_erase;
+    out->writev = flash_writev;
+    out->write_at = flash_write_at;
+    out->read_at = flash_read_at;
+    out->borrow = NULL; // flash is not writable through memory
+    out->sync = NULL;
+}
+
+// ---- A/B snapshot slots ----
+
+#define AB_MAGIC 0x43444F44u /* 'DODC' */
+#define AB_VERSION 1u
+#define AB_RECORD_USED 20u
+
+static void ab_wr_u32(uint8_t *p, uint32_t v) { p[0]=(uint8_t)v; p[1]=(uint8_t)(v>>8); p[2]=(uint8_t)(v>>16); p[3]=(uint8_t)(v>>24); }
+static uint32_t ab_rd_u32(const uint8_t *p) { return (uint32_t)p[0] | ((uint32_t)p[1]<<8) | ((uint32_t)p[2]<<16) | ((uint32_t)p[3]<<24); }
+
+static uintptr_t ab_slot_addr(const DodaFlashAB *ab, int slot) { return ab->flash->base_addr + (uintptr_t)((size_t)slot * ab->slot_size); }
+
+// Storage over the snapshot area of one slot; erase stays with the A/B logic (whole sectors)
+static void ab_slot_storage(const DodaFlashAB *ab, int slot, DodaFlashStorageCtx *sub, DodaStorage *st) {
+    *sub = *ab->flash;
+    sub->base_addr = ab_slot_addr(ab, slot) + DODA_FLASH_AB_RECORD_BYTES;
+    sub->region_size = ab->slot_size - DODA_FLASH_AB_RECORD_BYTES;
+    doda_flash_storage_init(st, sub);
+    st->erase = NULL;
+}
+
+// Generation of a valid commit record, 0 otherwise
+static uint32_t ab_read_record(DodaFlashAB *ab, int slot, uint32_t *bytes) {
+    uint8_t rec[AB_RECORD_USED];
+    if (!ab->flash->flash_read(ab_slot_addr(ab, slot), rec, sizeof(rec))) return 0;
+    if (ab_rd_u32(&rec[0]) != AB_MAGIC || rec[4] != (uint8_t)AB_VERSION || rec[5] != 0) return 0;
+    if (rec[6] != (uint8_t)DODA_FLASH_AB_RECORD_BYTES || rec[7] != 0) return 0;
+    if (ab_rd_u32(&rec[16]) != doda_persist_crc32(0u, rec, 16u)) return 0;
+    *bytes = ab_rd_u32(&rec[12]);
+    if (*bytes > ab->slot_size - DODA_FLASH_AB_RECORD_BYTES) return 0;
+    return ab_rd_u32(&rec[8]);
+}
+
+static bool ab_newer(uint32_t a, uint32_t b) { return (int32_t)(a - b) > 0; }
+
+static int ab_newest(const DodaFlashAB *ab) {
+    if (ab->generation[0] == 0 && ab->generation[1] == 0) return -1;
+    if (ab->generation[1] == 0) return 0;
+    if (ab->generation[0] == 0) return 1;
+    return ab_newer(ab->generation[1], ab->generation[0]) ? 1 : 0;
+}
+
+DodaPersistStatus doda_flash_ab_open(DodaFlashAB *ab, DodaFlashStorageCtx *flash) {
+    if (!ab || !flash || !flash->flash_read || !flash->flash_program || !flash->flash_erase_region) return DODA_PERSIST_ERR_INVALID;
+    memset(ab, 0, sizeof(*ab));
+    ab->flash = flash;
+    ab->slot_size = flash->region_size / 2u;
+    if (ab->slot_size <= DODA_FLASH_AB_RECORD_BYTES) return DODA_PERSIST_ERR_INVALID;
+    for (int s = 0; s < 2; ++s) ab->generation[s] = ab_read_record(ab, s, &ab->bytes[s]);
+    ab->active = ab_newest(ab);
+    ab->erased_slot = -1;
+    return DODA_PERSIST_OK;
+}
+
+DodaPersistStatus doda_flash_ab_prepare(DodaFlashAB *ab) {
+    if (!ab || !ab->flash) return DODA_PERSIST_ERR_INVALID;
+    int target = ab->active == 0 ? 1 : 0;
+    if (ab->erased_slot == target) return DODA_PERSIST_OK;
+    ab->generation[target] = 0;
+    if (!ab->flash->flash_erase_region(ab_slot_addr(ab, target), ab->slot_size)) return DODA_PERSIST_ERR_IO;
+    ab->erased_slot = target;
+    return DODA_PERSIST_OK;
+}
+
+DodaPersistStatus doda_flash_ab_save_table(DodaFlashAB *ab, const DodaTable *t) {
+    if (!ab || !ab->flash || !t) return DODA_PERSIST_ERR_INVALID;
+    int target = ab->active == 0 ? 1 : 0;
+    DodaPersistStatus ps = doda_flash_ab_prepare(ab);
+    if (ps != DODA_PERSIST_OK) return ps;
+    ab->erased_slot = -1; // about to be written, whatever the outcome
+
+    DodaFlashStorageCtx sub;
+    DodaStorage st;
+    ab_slot_storage(ab, target, &sub, &st);
+    ps = doda_persist_save_table(t, &st);
+    if (ps != DODA_PERSIST_OK) return ps;
+
+    // Commit: the record is the last thing programmed; until it lands the old slot wins
+    uint32_t gen = ab->active < 0 ? 1u : ab->generation[ab->active] + 1u;
+    if (gen == 0) gen = 1u; // 0 means "no record"
+    uint8_t rec[AB_RECORD_USED];
+    ab_wr_u32(&rec[0], AB_MAGIC);
+    rec[4] = (uint8_t)AB_VERSION; rec[5] = 0;
+    rec[6] = (uint8_t)DODA_FLASH_AB_RECORD_BYTES; rec[7] = 0;
+    ab_wr_u32(&rec[8], gen);
+    ab_wr_u32(&rec[12], (uint32_t)sub.cursor);
+    ab_wr_u32(&rec[16], doda_persist_crc32(0u, rec, 16u));
+    if (!ab->flash->flash_program(ab_slot_addr(ab, target), rec, sizeof(rec))) return DODA_PERSIST_ERR_IO;
+
+    ab->generation[target] = gen;
+    ab->bytes[target] = (uint32_t)sub.cursor;
+    ab->active = target;
+    return DODA_PERSIST_OK;
+}
+
+DodaPersistStatus doda_flash_ab_load_table(DodaFlashAB *ab, DodaTable *out) {
+    if (!ab || !ab->flash || !out) return DODA_PERSIST_ERR_INVALID;
+    int newest = ab_newest(ab);
+    if (newest < 0) return DODA_PERSIST_ERR_IO;
+    DodaPersistStatus ps = DODA_PERSIST_ERR_IO;
+    for (int k = 0; k < 2; ++k) {
+        int slot = k == 0 ? newest : 1 - newest;
+        if (ab->generation[slot] == 0) continue;
+        DodaFlashStorageCtx sub;
+        DodaStorage st;
+        ab_slot_storage(ab, slot, &sub, &st);
+        sub.region_size = ab->bytes[slot]; // never read past the committed snapshot
+        ps = doda_persist_load_table(out, &st);
+        if (ps == DODA_PERSIST_OK) { ab->active = slot; return ps; }
+    }
+    return ps;
 }
@@ -12,6 +12,7 @@
 //  - Implement erase() for sector/page erase.
 //  - Implement write_all() as sequential writes at an internal cursor.
 //  - Implement read_all() as sequential reads at an internal cursor.
+//  - write_at()/read_at() address the region directly (e.g. a fixed commit record).
 //  - Consider wear-leveling and power-fail safety (double-buffer + CRC).
 
 #ifdef __cplusplus
@@ -45,6 +46,35 @@ typedef struct {
 // You provide flash_erase_region/flash_program/flash_read hooks.
 void doda_flash_storage_init(DodaStorage *out, DodaFlashStorageCtx *ctx);
 
+// A/B snapshot slots (power-fail safe). The region is split into two equal slots, each a whole
+// number of erase sectors. A save erases and writes the slot not holding the newest snapshot
+// and programs that slot's commit record last, so a power cut at any point leaves the previous
+// snapshot loadable. Opening reads only the two commit records.
+//
+//   slot:   commit record (DODA_FLASH_AB_RECORD_BYTES, programmed last) | table snapshot
+//   record: 'DODC' | u16 version | u16 record bytes | u32 generation | u32 snapshot bytes |
+//           u32 CRC32 of the preceding 16 bytes (all little-endian)
+#define DODA_FLASH_AB_RECORD_BYTES 32u
+
+typedef struct {
+    DodaFlashStorageCtx *flash;
+    size_t slot_size;        // region_size / 2
+    int active;              // slot holding the newest committed snapshot, -1 if none
+    uint32_t generation[2];  // per slot; 0 when its record is missing or invalid
+    uint32_t bytes[2];       // snapshot bytes per committed slot
+    int erased_slot;         // slot erased ahead of the next save (doda_flash_ab_prepare), -1 if none
+} DodaFlashAB;
+
+// Read both commit records and pick the newest valid slot (generations compare modulo 2^32)
+DodaPersistStatus doda_flash_ab_open(DodaFlashAB *ab, DodaFlashStorageCtx *flash);
+// Optional: erase the slot the next save will use ahead of time (e.g. while idle)
+DodaPersistStatus doda_flash_ab_prepare(DodaFlashAB *ab);
+// Write t to the other slot and commit it with the next generation
+DodaPersistStatus doda_flash_ab_save_table(DodaFlashAB *ab, const DodaTable *t);
+// Load the newest committed snapshot, falling back to the older slot if it fails to load;
+// DODA_PERSIST_ERR_IO when no slot has been committed
+DodaPersistStatus doda_flash_ab_load_table(DodaFlashAB *ab, DodaTable *out);
+
 #ifdef __cplusplus
 }
 #endif
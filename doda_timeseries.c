@@ -8,41 +8,313 @@
  */
 
 #include "doda_api.h"
+#include "doda_scan.h"
+
+#include <limits.h>
+#include <stdint.h>
+#include <string.h>
 
 #ifdef DRIVERSQL_TIMESERIES
 
 void doda_tsdb_init(DodaTSDB *ts, DodaTable *t, const char *time_col) {
-    ts->table = t; ts->time_col = time_col;
+    memset(ts, 0, sizeof(*ts));
+    ts->table = t; ts->time_col = time_col; ts->time_idx = -1;
+}
+
+// ---- Chunk ring ----
+
+static DodaTSChunk *chunk_at(const DodaTSDB *ts, size_t k) { return &ts->chunks[(ts->oldest + k) % ts->chunk_count]; }
+
+// Arena layout: chunk_count table headers (8-byte aligned), then one table arena per chunk
+#define CHUNK_ALIGN 8u
+
+size_t doda_tsdb_chunked_arena_bytes(size_t chunk_count, size_t chunk_rows, int column_count, const DodaColumnType *col_types) {
+    size_t per = doda_table_arena_bytes(column_count, col_types, chunk_rows);
+    if (per == 0 || chunk_count == 0 || per > SIZE_MAX - doda_table_header_bytes()) return 0;
+    per += doda_table_header_bytes();
+    return chunk_count <= (SIZE_MAX - CHUNK_ALIGN) / per ? per * chunk_count + (CHUNK_ALIGN - 1u) : 0;
+}
+
+DodaStatus doda_tsdb_init_chunked(DodaTSDB *ts, DodaTSChunk *chunks, size_t chunk_count, size_t chunk_rows, int column_count, const char **col_names, const DodaColumnType *col_types, const char *time_col, void *arena, size_t arena_bytes) {
+    if (!ts || !chunks || chunk_count == 0 || !time_col || !arena) return DodaStatus_ERR_INVALID;
+    size_t need = doda_tsdb_chunked_arena_bytes(chunk_count, chunk_rows, column_count, col_types);
+    if (need == 0 || arena_bytes < need) return DodaStatus_ERR_INVALID;
+    size_t head = doda_table_header_bytes(), per = doda_table_arena_bytes(column_count, col_types, chunk_rows);
+    uint8_t *base = (uint8_t *)arena;
+    base += (CHUNK_ALIGN - ((uintptr_t)base & (CHUNK_ALIGN - 1u))) & (CHUNK_ALIGN - 1u);
+    uint8_t *data = base + chunk_count * head;
+    doda_tsdb_init(ts, NULL, time_col);
+    for (size_t i = 0; i < chunk_count; ++i) {
+        chunks[i].table = (DodaTable *)(void *)(base + i * head);
+        DodaStatus st = doda_table_init_arena(chunks[i].table, "chunk", column_count, col_names, col_types, data + i * per, per, chunk_rows);
+        if (st != DodaStatus_OK) return st;
+        chunks[i].min_time = INT_MAX; chunks[i].max_time = INT_MIN;
+    }
+    ts->time_idx = doda_column_index(chunks[0].table, time_col);
+    if (ts->time_idx < 0) return DodaStatus_ERR_NOT_FOUND;
+    if (chunks[0].table->columns[ts->time_idx].type != COL_INT) return DodaStatus_ERR_UNSUPPORTED;
+    ts->chunks = chunks; ts->chunk_count = chunk_count;
+    return DodaStatus_OK;
+}
+
+// Head chunk with room for one more row, rotating to a freshly cleared chunk when needed
+static DodaTSChunk *chunk_for_append(DodaTSDB *ts) {
+    if (ts->live) {
+        DodaTSChunk *head = chunk_at(ts, ts->live - 1u);
+        if (head->table->count < head->table->capacity || head->table->free_top) return head;
+    }
+    if (ts->live == ts->chunk_count) return NULL;
+    DodaTSChunk *next = chunk_at(ts, ts->live);
+    doda_table_clear(next->table);
+    next->min_time = INT_MAX; next->max_time = INT_MIN;
+    ts->live++; ts->table = next->table;
+    return next;
+}
+
+DodaStatus doda_tsdb_append(DodaTSDB *ts, const void *values[]) {
+    if (!ts || !values) return DodaStatus_ERR_INVALID;
+    if (!ts->chunks) return doda_insert_row(ts->table, values);
+    DodaTSChunk *c = chunk_for_append(ts);
+    if (!c) return DodaStatus_ERR_FULL;
+    DodaStatus st = doda_insert_row(c->table, values);
+    if (st != DodaStatus_OK) return st;
+    int tm = *(const int *)values[ts->time_idx];
+    if (tm < c->min_time) c->min_time = tm;
+    if (tm > c->max_time) c->max_time = tm;
+    return DodaStatus_OK;
 }
 
 DodaStatus doda_tsdb_append_int3(DodaTSDB *ts, int id, int time, int value) {
-    const void *vals[3]; vals[0] = &id; vals[1] = &time; vals[2] = &value; return doda_insert_row(ts->table, vals);
+    const void *vals[3]; vals[0] = &id; vals[1] = &time; vals[2] = &value; return doda_tsdb_append(ts, vals);
+}
+
+DodaStatus doda_tsdb_drop_oldest_chunk(DodaTSDB *ts, size_t *dropped_rows_out) {
+    if (dropped_rows_out) *dropped_rows_out = 0;
+    if (!ts || !ts->chunks) return DodaStatus_ERR_INVALID;
+    if (ts->live == 0) return DodaStatus_ERR_NOT_FOUND;
+    DodaTSChunk *c = chunk_at(ts, 0);
+    if (dropped_rows_out) *dropped_rows_out = c->table->count - c->table->free_top;
+    ts->oldest = (ts->oldest + 1u) % ts->chunk_count; ts->live--;
+    if (ts->live == 0) ts->table = NULL;
+    return DodaStatus_OK;
+}
+
+// Visit the live rows of chunk tables whose span meets [lo, hi]; a chunk inside the span needs no
+// predicate, others run op/value through select_where_op
+static DodaStatus chunks_select(const DodaTSDB *ts, int lo, int hi, DodaOp op, const void *value, doda_row_callback cb, void *user) {
+    for (size_t k = 0; k < ts->live; ++k) {
+        const DodaTSChunk *c = chunk_at(ts, k); const DodaTable *t = c->table;
+        if (c->max_time < lo || c->min_time > hi) continue;
+        if (c->min_time < lo || c->max_time > hi) { DodaStatus st = doda_select_where_op(t, ts->time_col, op, value, cb, user); if (st != DodaStatus_OK) return st; continue; }
+        for (size_t base = 0; base < t->count; base += 64u)
+            for (uint64_t m = ~t->deleted_bits[base / 64u] & scan_tail_mask(base, t->count); m; m &= m - 1u) cb(t, base + scan_ctz64(m), user);
+    }
+    return DodaStatus_OK;
 }
 
 DodaStatus doda_tsdb_select_time_ge(const DodaTSDB *ts, int t0, doda_row_callback cb, void *user) {
+    if (ts->chunks) return chunks_select(ts, t0, INT_MAX, DodaOp_GTE, &t0, cb, user);
     return doda_select_where_op(ts->table, ts->time_col, DodaOp_GTE, &t0, cb, user);
 }
 DodaStatus doda_tsdb_select_time_gt(const DodaTSDB *ts, int t0, doda_row_callback cb, void *user) {
+    if (ts->chunks) return t0 == INT_MAX ? DodaStatus_OK : chunks_select(ts, t0 + 1, INT_MAX, DodaOp_GT, &t0, cb, user);
     return doda_select_where_op(ts->table, ts->time_col, DodaOp_GT, &t0, cb, user);
 }
 DodaStatus doda_tsdb_select_time_lt(const DodaTSDB *ts, int t1, doda_row_callback cb, void *user) {
+    if (ts->chunks) return t1 == INT_MIN ? DodaStatus_OK : chunks_select(ts, INT_MIN, t1 - 1, DodaOp_LT, &t1, cb, user);
     return doda_select_where_op(ts->table, ts->time_col, DodaOp_LT, &t1, cb, user);
 }
 
-bool doda_tsdb_build_time_index(DodaTSDB *ts, DodaIndex *idx) { return doda_index_build(ts->table, idx, ts->time_col); }
+DodaStatus doda_tsdb_select_time_range(const DodaTSDB *ts, int t0, int t1, doda_row_callback cb, void *user) {
+    if (t1 <= t0) return DodaStatus_OK;
+    int range[2] = {t0, t1 - 1};
+    if (ts->chunks) return chunks_select(ts, range[0], range[1], DodaOp_BETWEEN, range, cb, user);
+    return doda_select_where_op(ts->table, ts->time_col, DodaOp_BETWEEN, range, cb, user);
+}
+
+bool doda_tsdb_build_time_index(DodaTSDB *ts, DodaIndex *idx) { return !ts->chunks && doda_index_build(ts->table, idx, ts->time_col) && doda_index_attach(ts->table, idx); }
+
+static size_t delete_rows_older_than(DodaTable *t, int col, int cutoff_time) {
+    size_t del = 0;
+    for (size_t r = 0; r < t->count; ++r) {
+        if (doda_is_deleted(t, r)) continue;
+        int v = t->columns[col].data.int_data[r];
+        if (v < cutoff_time) { doda_delete_row(t, r); del++; }
+    }
+    return del;
+}
 
 DodaStatus doda_tsdb_delete_older_than(DodaTSDB *ts, int cutoff_time, size_t *deleted_out) {
-    size_t del = 0; int col = doda_column_index(ts->table, ts->time_col); if (col < 0) { if (deleted_out) *deleted_out = 0; return DodaStatus_ERR_NOT_FOUND; }
-    for (size_t r = 0; r < ts->table->count; ++r) {
-        if (doda_is_deleted(ts->table, r)) continue;
-        int v = ts->table->columns[col].data.int_data[r];
-        if (v < cutoff_time) {
-            ts->table->free_list[ts->table->free_top++] = (uint16_t)r;
-            ts->table->deleted_bits[r/64] |= (1ULL << (r%64));
-            del++;
+    size_t del = 0;
+    if (ts->chunks) {
+        while (ts->live && chunk_at(ts, 0)->max_time < cutoff_time) { size_t n; doda_tsdb_drop_oldest_chunk(ts, &n); del += n; }
+        for (size_t k = 0; k < ts->live; ++k) {
+            DodaTSChunk *c = chunk_at(ts, k);
+            if (c->min_time >= cutoff_time) continue;
+            del += delete_rows_older_than(c->table, ts->time_idx, cutoff_time);
+            c->min_time = cutoff_time;
         }
+        if (deleted_out) *deleted_out = del;
+        return DodaStatus_OK;
     }
+    int col = doda_column_index(ts->table, ts->time_col); if (col < 0) { if (deleted_out) *deleted_out = 0; return DodaStatus_ERR_NOT_FOUND; }
+    del = delete_rows_older_than(ts->table, col, cutoff_time);
     if (deleted_out) *deleted_out = del; return DodaStatus_OK;
 }
 
+DodaStatus doda_tsdb_seal_older_than(DodaTSDB *ts, int cutoff_time, uint8_t *buf, size_t cap, DodaSealedBlock *out, size_t *sealed_out) {
+    if (sealed_out) *sealed_out = 0;
+    if (ts->chunks) return DodaStatus_ERR_UNSUPPORTED;
+    DodaPredicate older = { ts->time_col, OP_LT, &cutoff_time };
+    DodaStatus st = doda_seal_where(ts->table, &older, 1, ts->time_col, buf, cap, out);
+    if (st != DodaStatus_OK) return st;
+    if (sealed_out) *sealed_out = out->rows;
+    return doda_tsdb_delete_older_than(ts, cutoff_time, NULL);
+}
+
+DodaStatus doda_tsdb_seal_oldest_chunk(DodaTSDB *ts, uint8_t *buf, size_t cap, DodaSealedBlock *out, size_t *sealed_out) {
+    if (sealed_out) *sealed_out = 0;
+    if (!ts || !ts->chunks) return DodaStatus_ERR_INVALID;
+    if (ts->live == 0) return DodaStatus_ERR_NOT_FOUND;
+    DodaStatus st = doda_seal_where(chunk_at(ts, 0)->table, NULL, 0, ts->time_col, buf, cap, out);
+    if (st != DodaStatus_OK) return st;
+    if (sealed_out) *sealed_out = out->rows;
+    return doda_tsdb_drop_oldest_chunk(ts, NULL);
+}
+
+#define ROLLUP_AGGS 6u
+#define ROLLUP_CHUNK 64u
+
+static double rollup_value(const Column *c, size_t r) {
+    switch (c->type) {
+#ifndef DRIVERSQL_NO_FLOAT
+        case COL_FLOAT: return (double)c->data.float_data[r];
+#endif
+#ifndef DRIVERSQL_NO_DOUBLE
+        case COL_DOUBLE: return c->data.double_data[r];
+#endif
+        default: return (double)c->data.int_data[r];
+    }
+}
+
+static bool rollup_numeric(ColumnType ct) {
+    if (ct == COL_INT) return true;
+#ifndef DRIVERSQL_NO_FLOAT
+    if (ct == COL_FLOAT) return true;
+#endif
+#ifndef DRIVERSQL_NO_DOUBLE
+    if (ct == COL_DOUBLE) return true;
+#endif
+    return false;
+}
+
+// Floor to a multiple of width, also for negative times (64-bit to stay clear of overflow)
+static int rollup_bucket(int t, int width) {
+    int64_t q = (int64_t)t / width; if ((int64_t)t % width < 0) q--; return (int)(q * width);
+}
+
+static DodaStatus rollup_emit(DodaRollupBucket *b, unsigned agg_set, DodaTable *dest, doda_rollup_callback cb, void *user) {
+    b->avg /= (double)b->count; // running sum until the bucket closes
+    if (cb) cb(b, user);
+    if (!dest) return DodaStatus_OK;
+    const double vals[ROLLUP_AGGS] = {(double)b->count, b->min, b->max, b->avg, b->first, b->last};
+    int ints[1 + ROLLUP_AGGS]; float floats[1 + ROLLUP_AGGS]; double doubles[1 + ROLLUP_AGGS];
+    const void *row[1 + ROLLUP_AGGS];
+    ints[0] = b->bucket; row[0] = &ints[0];
+    int col = 1;
+    for (unsigned a = 0; a < ROLLUP_AGGS; ++a) {
+        if (!(agg_set & (1u << a))) continue;
+        switch (dest->columns[col].type) {
+#ifndef DRIVERSQL_NO_FLOAT
+            case COL_FLOAT: floats[col] = (float)vals[a]; row[col] = &floats[col]; break;
+#endif
+#ifndef DRIVERSQL_NO_DOUBLE
+            case COL_DOUBLE: doubles[col] = vals[a]; row[col] = &doubles[col]; break;
+#endif
+            default: ints[col] = (int)vals[a]; row[col] = &ints[col]; break;
+        }
+        col++;
+    }
+    (void)floats; (void)doubles;
+    return doda_insert_row(dest, row);
+}
+
+static const DodaIndex *rollup_time_index(const DodaTable *t, int time_col) {
+    for (int i = 0; i < t->index_count; ++i) if (t->indexes[i]->active && t->indexes[i]->column_id == time_col) return t->indexes[i];
+    return NULL;
+}
+
+// k-th table a window visits: the plain table, or live chunk k when its time span meets [lo, hi]
+static const DodaTable *rollup_table(const DodaTSDB *ts, size_t k, int lo, int hi) {
+    if (!ts->chunks) return ts->table;
+    const DodaTSChunk *c = chunk_at(ts, k);
+    return c->max_time < lo || c->min_time > hi ? NULL : c->table;
+}
+
+// Rollup over the inclusive time window [lo, hi]; chunked series stream chunk by chunk, oldest first
+static DodaStatus rollup_window(const DodaTSDB *ts, const char *value_col, int lo, int hi, int bucket_width, unsigned agg_set, DodaTable *dest, doda_rollup_callback cb, void *user) {
+    if (!ts || (!ts->table && !ts->chunks) || !value_col || bucket_width <= 0 || agg_set == 0 || agg_set >= (1u << ROLLUP_AGGS)) return DodaStatus_ERR_INVALID;
+    const DodaTable *t = ts->chunks ? ts->chunks[0].table : ts->table;
+    size_t ntables = ts->chunks ? ts->live : 1u;
+    if (ts->chunks) { for (size_t k = 0; k < ts->chunk_count; ++k) if (dest == ts->chunks[k].table) return DodaStatus_ERR_INVALID; }
+    else if (dest == ts->table) return DodaStatus_ERR_INVALID;
+    int tc = doda_column_index(t, ts->time_col), vc = doda_column_index(t, value_col);
+    if (tc < 0 || vc < 0) return DodaStatus_ERR_NOT_FOUND;
+    if (t->columns[tc].type != COL_INT || !rollup_numeric(t->columns[vc].type)) return DodaStatus_ERR_UNSUPPORTED;
+    if (dest) {
+        int want = 1; for (unsigned a = 0; a < ROLLUP_AGGS; ++a) want += (agg_set >> a) & 1u;
+        if (dest->column_count != want || dest->columns[0].type != COL_INT) return DodaStatus_ERR_INVALID;
+        for (int i = 1; i < want; ++i) if (!rollup_numeric(dest->columns[i].type)) return DodaStatus_ERR_UNSUPPORTED;
+    }
+
+    // Without a time index rows arrive in row order (and chunk order); refuse rather than emit split buckets
+    bool any = false; int prev = 0;
+    for (size_t k = 0; k < ntables; ++k) {
+        if (!(t = rollup_table(ts, k, lo, hi))) continue;
+        if (rollup_time_index(t, tc)) continue;
+        const int *time = t->columns[tc].data.int_data;
+        for (size_t r = 0; r < t->count; ++r) {
+            if (doda_is_deleted(t, r) || time[r] < lo || time[r] > hi) continue;
+            if (any && time[r] < prev) return DodaStatus_ERR_UNSUPPORTED;
+            prev = time[r]; any = true;
+        }
+    }
+
+    int range[2] = {lo, hi};
+    DodaPredicate window = {ts->time_col, OP_BETWEEN, range};
+    uint32_t rows[ROLLUP_CHUNK]; size_t n;
+    DodaRollupBucket b; memset(&b, 0, sizeof(b));
+    DodaStatus st = DodaStatus_OK;
+    for (size_t k = 0; k < ntables; ++k) {
+        if (!(t = rollup_table(ts, k, lo, hi))) continue;
+        const int *time = t->columns[tc].data.int_data;
+        DodaSelectCursor cur; doda_select_cursor_init(&cur);
+        while ((st = doda_select_into(t, &window, rows, ROLLUP_CHUNK, &cur, &n)) == DodaStatus_OK && n > 0) {
+            for (size_t i = 0; i < n; ++i) {
+                int bucket = rollup_bucket(time[rows[i]], bucket_width);
+                double v = rollup_value(&t->columns[vc], rows[i]);
+                if (b.count && bucket != b.bucket) {
+                    if ((st = rollup_emit(&b, agg_set, dest, cb, user)) != DodaStatus_OK) return st;
+                    b.count = 0;
+                }
+                if (b.count == 0) { b.bucket = bucket; b.min = b.max = b.first = v; b.avg = 0.0; }
+                if (v < b.min) b.min = v;
+                if (v > b.max) b.max = v;
+                b.avg += v; b.last = v; b.count++;
+            }
+        }
+        if (st != DodaStatus_OK) return st;
+    }
+    return b.count ? rollup_emit(&b, agg_set, dest, cb, user) : DodaStatus_OK;
+}
+
+DodaStatus doda_tsdb_rollup_range(const DodaTSDB *ts, const char *value_col, int t0, int t1, int bucket_width, unsigned agg_set, DodaTable *dest, doda_rollup_callback cb, void *user) {
+    if (t1 <= t0) return rollup_window(ts, value_col, 1, 0, bucket_width, agg_set, dest, cb, user);
+    return rollup_window(ts, value_col, t0, t1 - 1, bucket_width, agg_set, dest, cb, user);
+}
+
+DodaStatus doda_tsdb_rollup(const DodaTSDB *ts, const char *value_col, int bucket_width, unsigned agg_set, DodaTable *dest, doda_rollup_callback cb, void *user) {
+    return rollup_window(ts, value_col, INT_MIN, INT_MAX, bucket_width, agg_set, dest, cb, user);
+}
+
 #endif // DRIVERSQL_TIMESERIES
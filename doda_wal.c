@@ -0,0 +1,217 @@
+#include "doda_wal.h"
+#include <string.h>
+
+static void wr_u32(uint8_t *p, uint32_t v) { p[0]=(uint8_t)v; p[1]=(uint8_t)(v>>8); p[2]=(uint8_t)(v>>16); p[3]=(uint8_t)(v>>24); }
+static void wr_u16(uint8_t *p, uint16_t v) { p[0]=(uint8_t)v; p[1]=(uint8_t)(v>>8); }
+static uint32_t rd_u32(const uint8_t *p) { return (uint32_t)p[0] | ((uint32_t)p[1]<<8) | ((uint32_t)p[2]<<16) | ((uint32_t)p[3]<<24); }
+static uint16_t rd_u16(const uint8_t *p) { return (uint16_t)((uint16_t)p[0] | ((uint16_t)p[1]<<8)); }
+
+enum { WAL_INSERT = 1, WAL_DELETE = 2 };
+#define WAL_HEAD_BYTES 3u
+#define WAL_CRC_BYTES 4u
+
+static size_t wal_cell_bytes(ColumnType ct) {
+    switch (ct) {
+        case COL_INT: return 4u;
+        case COL_BOOL: return 1u;
+#ifndef DRIVERSQL_NO_FLOAT
+        case COL_FLOAT: return sizeof(float);
+#endif
+#ifndef DRIVERSQL_NO_DOUBLE
+        case COL_DOUBLE: return sizeof(double);
+#endif
+#ifndef DRIVERSQL_NO_TEXT
+        case COL_TEXT: return MAX_TEXT_LEN; // upper bound: stored text plus its NUL
+#endif
+        default: return 0;
+    }
+}
+
+size_t doda_wal_record_max_bytes(const DodaTable *t) {
+    if (!t) return 0;
+    size_t n = WAL_HEAD_BYTES + WAL_CRC_BYTES + 4u; // + 4: a delete record always fits too
+    for (int c = 0; c < t->column_count; ++c) {
+        size_t cb = wal_cell_bytes(t->columns[c].type); if (cb == 0) return 0;
+        n += cb;
+    }
+    return n;
+}
+
+static uint32_t wal_now(const DodaWal *w) { return w->cfg.now_ms ? w->cfg.now_ms(w->cfg.user) : 0u; }
+
+DodaPersistStatus doda_wal_init(DodaWal *w, const DodaStorage *log, const DodaWalConfig *cfg) {
+    if (!w || !log || !cfg || !cfg->buf || cfg->cap < WAL_HEAD_BYTES + WAL_CRC_BYTES + 4u) return DODA_PERSIST_ERR_INVALID;
+    if (cfg->commit_ms && !cfg->now_ms) return DODA_PERSIST_ERR_INVALID;
+    memset(w, 0, sizeof(*w));
+    w->log = log; w->cfg = *cfg;
+    if (w->cfg.commit_bytes == 0 || w->cfg.commit_bytes > w->cfg.cap) w->cfg.commit_bytes = w->cfg.cap;
+    return DODA_PERSIST_OK;
+}
+
+DodaPersistStatus doda_wal_reset(DodaWal *w) {
+    if (!w || !w->log) return DODA_PERSIST_ERR_INVALID;
+    w->used = 0; w->pending = 0;
+    if (w->log->erase && !w->log->erase(w->log->ctx)) return DODA_PERSIST_ERR_IO;
+    return doda_storage_sync(w->log) ? DODA_PERSIST_OK : DODA_PERSIST_ERR_IO;
+}
+
+DodaPersistStatus doda_wal_commit(DodaWal *w) {
+    if (!w || !w->log || !w->log->write_all) return DODA_PERSIST_ERR_INVALID;
+    if (w->used == 0) return DODA_PERSIST_OK;
+    if (!w->log->write_all(w->log->ctx, w->cfg.buf, w->used) || !doda_storage_sync(w->log)) return DODA_PERSIST_ERR_IO;
+    w->commits++; w->records += w->pending;
+    w->used = 0; w->pending = 0;
+    return DODA_PERSIST_OK;
+}
+
+static bool wal_latency_due(const DodaWal *w) {
+    return w->pending && w->cfg.commit_ms && (uint32_t)(wal_now(w) - w->first_ms) >= w->cfg.commit_ms;
+}
+
+DodaPersistStatus doda_wal_poll(DodaWal *w) {
+    if (!w) return DODA_PERSIST_ERR_INVALID;
+    return wal_latency_due(w) ? doda_wal_commit(w) : DODA_PERSIST_OK;
+}
+
+// Frame the payload already written at buf[used + 3 ..] and apply the group thresholds
+static DodaPersistStatus wal_stage(DodaWal *w, uint8_t kind, size_t payload) {
+    uint8_t *rec = w->cfg.buf + w->used;
+    rec[0] = kind; wr_u16(&rec[1], (uint16_t)payload);
+    wr_u32(&rec[WAL_HEAD_BYTES + payload], doda_persist_crc32(0u, rec, WAL_HEAD_BYTES + payload));
+    if (w->pending == 0) w->first_ms = wal_now(w);
+    w->used += WAL_HEAD_BYTES + payload + WAL_CRC_BYTES; w->pending++;
+    if (w->used >= w->cfg.commit_bytes || (w->cfg.commit_records && w->pending >= w->cfg.commit_records) || wal_latency_due(w)) return doda_wal_commit(w);
+    return DODA_PERSIST_OK;
+}
+
+// Room for a record of up to `bytes`; commits the current group first if it does not fit
+static DodaPersistStatus wal_reserve(DodaWal *w, size_t bytes) {
+    if (bytes > w->cfg.cap) return DODA_PERSIST_ERR_INVALID;
+    if (w->used + bytes > w->cfg.cap) return doda_wal_commit(w);
+    return DODA_PERSIST_OK;
+}
+
+DodaPersistStatus doda_wal_log_insert(DodaWal *w, const DodaTable *t, const void *values[]) {
+    if (!w || !w->log || !t || !values) return DODA_PERSIST_ERR_INVALID;
+    size_t max = doda_wal_record_max_bytes(t);
+    if (max == 0) return DODA_PERSIST_ERR_UNSUPPORTED;
+    if (max - WAL_HEAD_BYTES - WAL_CRC_BYTES > 0xFFFFu) return DODA_PERSIST_ERR_UNSUPPORTED;
+    DodaPersistStatus s = wal_reserve(w, max); if (s != DODA_PERSIST_OK) return s;
+
+    uint8_t *p = w->cfg.buf + w->used + WAL_HEAD_BYTES, *start = p;
+    for (int c = 0; c < t->column_count; ++c) {
+        switch (t->columns[c].type) {
+            case COL_INT: wr_u32(p, (uint32_t)*(const int *)values[c]); p += 4; break;
+            case COL_BOOL: *p++ = (uint8_t)(values[c] && *(const int *)values[c] != 0); break;
+#ifndef DRIVERSQL_NO_FLOAT
+            case COL_FLOAT: memcpy(p, values[c], sizeof(float)); p += sizeof(float); break;
+#endif
+#ifndef DRIVERSQL_NO_DOUBLE
+            case COL_DOUBLE: memcpy(p, values[c], sizeof(double)); p += sizeof(double); break;
+#endif
+#ifndef DRIVERSQL_NO_TEXT
+            case COL_TEXT: {
+                const char *str = values[c] ? (const char *)values[c] : "";
+                size_t n = 0; while (n < MAX_TEXT_LEN - 1u && str[n]) n++;
+                memcpy(p, str, n); p[n] = 0; p += n + 1u;
+                break;
+            }
+#endif
+            default: return DODA_PERSIST_ERR_UNSUPPORTED;
+        }
+    }
+    return wal_stage(w, WAL_INSERT, (size_t)(p - start));
+}
+
+DodaPersistStatus doda_wal_log_delete(DodaWal *w, int key) {
+    if (!w || !w->log) return DODA_PERSIST_ERR_INVALID;
+    DodaPersistStatus s = wal_reserve(w, WAL_HEAD_BYTES + 4u + WAL_CRC_BYTES); if (s != DODA_PERSIST_OK) return s;
+    wr_u32(w->cfg.buf + w->used + WAL_HEAD_BYTES, (uint32_t)key);
+    return wal_stage(w, WAL_DELETE, 4u);
+}
+
+// One decoded cell; FLOAT/DOUBLE are unaligned inside the record, so they are copied out
+typedef union {
+    int32_t i;
+#ifndef DRIVERSQL_NO_FLOAT
+    float f;
+#endif
+#ifndef DRIVERSQL_NO_DOUBLE
+    double d;
+#endif
+} WalCell;
+
+// Decode an insert payload into values[] (TEXT cells point into the payload)
+static bool wal_decode_row(const DodaTable *t, const uint8_t *p, size_t len, const void *values[], WalCell *cells) {
+    const uint8_t *end = p + len;
+    for (int c = 0; c < t->column_count; ++c) {
+        ColumnType ct = t->columns[c].type;
+        values[c] = &cells[c];
+#ifndef DRIVERSQL_NO_TEXT
+        if (ct == COL_TEXT) {
+            const uint8_t *nul = (const uint8_t *)memchr(p, 0, (size_t)(end - p));
+            if (!nul || (size_t)(nul - p) >= MAX_TEXT_LEN) return false;
+            values[c] = p; p = nul + 1;
+            continue;
+        }
+#endif
+        size_t cb = wal_cell_bytes(ct);
+        if (cb == 0 || (size_t)(end - p) < cb) return false;
+        switch (ct) {
+            case COL_INT: cells[c].i = (int32_t)rd_u32(p); break;
+            case COL_BOOL: cells[c].i = *p != 0; break;
+#ifndef DRIVERSQL_NO_FLOAT
+            case COL_FLOAT: memcpy(&cells[c].f, p, sizeof(float)); break;
+#endif
+#ifndef DRIVERSQL_NO_DOUBLE
+            case COL_DOUBLE: memcpy(&cells[c].d, p, sizeof(double)); break;
+#endif
+            default: return false;
+        }
+        p += cb;
+    }
+    return p == end;
+}
+
+DodaPersistStatus doda_wal_replay(DodaWal *w, DodaTable *t, DodaWalReplayStats *out) {
+    if (!w || !w->log || !w->log->read_all || !t || !out) return DODA_PERSIST_ERR_INVALID;
+    memset(out, 0, sizeof(*out));
+    if (t->column_count <= 0) return DODA_PERSIST_ERR_INVALID;
+    w->used = 0; w->pending = 0;
+    uint8_t *rec = w->cfg.buf;
+    for (;;) {
+        if (!w->log->read_all(w->log->ctx, rec, WAL_HEAD_BYTES)) break;
+        // Erased (0xFF) or zeroed media ends the log; anything else unknown is a damaged record
+        if (rec[0] != WAL_INSERT && rec[0] != WAL_DELETE) { out->torn = rec[0] != 0x00u && rec[0] != 0xFFu; break; }
+        size_t len = rd_u16(&rec[1]);
+        if (WAL_HEAD_BYTES + len + WAL_CRC_BYTES > w->cfg.cap || !w->log->read_all(w->log->ctx, rec + WAL_HEAD_BYTES, len + WAL_CRC_BYTES)) { out->torn = true; break; }
+        if (doda_persist_crc32(0u, rec, WAL_HEAD_BYTES + len) != rd_u32(&rec[WAL_HEAD_BYTES + len])) { out->torn = true; break; }
+        out->bytes += WAL_HEAD_BYTES + len + WAL_CRC_BYTES;
+
+        const uint8_t *payload = rec + WAL_HEAD_BYTES;
+        if (rec[0] == WAL_DELETE) {
+            if (len != 4u) return DODA_PERSIST_ERR_CORRUPT;
+            if (t->columns[0].type != COL_INT) return DODA_PERSIST_ERR_UNSUPPORTED;
+            int key = (int)rd_u32(payload); size_t deleted = 0;
+            if (delete_where_eq(t, t->columns[0].name, &key, &deleted) != DS_OK) return DODA_PERSIST_ERR_CORRUPT;
+            if (deleted) out->applied++; else out->skipped++;
+            continue;
+        }
+        const void *values[MAX_COLUMNS]; WalCell cells[MAX_COLUMNS];
+        if (!wal_decode_row(t, payload, len, values, cells)) return DODA_PERSIST_ERR_CORRUPT;
+        switch (insert_row(t, values)) {
+            case DS_OK: out->applied++; break;
+            case DS_ERR_UNSUPPORTED: out->skipped++; break; // pk already present
+            case DS_ERR_FULL: return DODA_PERSIST_ERR_INVALID;
+            default: return DODA_PERSIST_ERR_CORRUPT;
+        }
+    }
+    return DODA_PERSIST_OK;
+}
+
+DodaPersistStatus doda_wal_checkpoint(DodaWal *w, const DodaTable *t, const DodaStorage *snapshot) {
+    if (!w || !t || !snapshot) return DODA_PERSIST_ERR_INVALID;
+    DodaPersistStatus s = doda_wal_commit(w); if (s != DODA_PERSIST_OK) return s;
+    s = doda_persist_save_table(t, snapshot); if (s != DODA_PERSIST_OK) return s;
+    return doda_wal_reset(w);
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include "doda_persist.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Append-only write-ahead log on a DodaStorage, so one new sample costs one small record
+// instead of a full doda_persist_save_table().
+//
+// Each insert/delete becomes a record
+//   u8 kind | u16 payload bytes | payload | u32 CRC32 (of kind, length and payload)
+// Insert payloads hold the cells in column order (INT/FLOAT 4 bytes, DOUBLE 8, BOOL 1,
+// TEXT NUL-terminated); delete payloads hold the primary key (column 0, INT).
+//
+// Records are staged in a caller buffer and written as one group (a single write_all) when
+// the staged bytes or records reach a threshold, when the oldest staged record is older than
+// commit_ms, or on doda_wal_commit(). A record is durable once its group is written.
+//
+// Startup: load the snapshot (or start from an empty table), doda_wal_replay() the log into it,
+// then doda_wal_checkpoint() so appends continue after a fresh snapshot on an erased log.
+// Replay stops at the first short, unknown or CRC-failing record (a torn last group).
+// DodaStorage has no seek, so a log that has been read must be checkpointed (or reset) before
+// new records are appended.
+
+typedef struct {
+    uint8_t *buf;          // staging buffer for one group (also replay scratch); >= largest record
+    size_t cap;
+    size_t commit_bytes;   // commit once this many bytes are staged (0 or > cap: when full)
+    size_t commit_records; // ... or this many records (0 = no record limit)
+    uint32_t commit_ms;    // ... or once the oldest staged record is this old (0 = off; needs now_ms)
+    uint32_t (*now_ms)(void *user); // optional monotonic millisecond clock
+    void *user;
+} DodaWalConfig;
+
+typedef struct {
+    const DodaStorage *log;
+    DodaWalConfig cfg;
+    size_t used;           // staged bytes
+    size_t pending;        // staged records
+    uint32_t first_ms;     // clock when the oldest staged record was added
+    size_t commits;        // groups written since init
+    size_t records;        // records written since init
+} DodaWal;
+
+typedef struct {
+    size_t applied;        // records applied to the table
+    size_t skipped;        // inserts of a key already present, deletes of an absent key
+    size_t bytes;          // bytes of valid records read
+    bool torn;             // replay stopped at a damaged record rather than the end of the medium
+} DodaWalReplayStats;
+
+// Worst-case record bytes for one row of t (size cfg.buf at least this large)
+size_t doda_wal_record_max_bytes(const DodaTable *t);
+
+DodaPersistStatus doda_wal_init(DodaWal *w, const DodaStorage *log, const DodaWalConfig *cfg);
+// Erase the log and drop staged records
+DodaPersistStatus doda_wal_reset(DodaWal *w);
+
+// Stage a record for a row (values as for doda_insert_row) or a primary-key delete. Call after
+// the table accepted the change. May commit the group, so it can fail with DODA_PERSIST_ERR_IO;
+// the staged records are then kept for the next commit.
+DodaPersistStatus doda_wal_log_insert(DodaWal *w, const DodaTable *t, const void *values[]);
+DodaPersistStatus doda_wal_log_delete(DodaWal *w, int key);
+
+// Write the staged group now; doda_wal_poll only if the commit_ms latency has elapsed
+// (call it when no appends arrive to bound the commit latency)
+DodaPersistStatus doda_wal_commit(DodaWal *w);
+DodaPersistStatus doda_wal_poll(DodaWal *w);
+
+// Apply every valid record of the log to t (schema must match the logged rows). Inserts of a pk
+// already in t and deletes of a missing pk are skipped, so replaying over a snapshot that
+// already contains some of the records converges to the same table.
+DodaPersistStatus doda_wal_replay(DodaWal *w, DodaTable *t, DodaWalReplayStats *out);
+
+// Commit, save t as the new snapshot, then erase the log
+DodaPersistStatus doda_wal_checkpoint(DodaWal *w, const DodaTable *t, const DodaStorage *snapshot);
+
+#ifdef __cplusplus
+}
+#endif
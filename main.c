@@ -124,13 +124,13 @@ static void test_persistence_roundtrip(void) {
 
     const char *path = "./doda_test.bin";
     FileStorageCtx wctx = { path, true };
-    DodaStorage stw = { &wctx, file_write_all, NULL, file_erase };
+    DodaStorage stw = DODA_STORAGE_INIT(&wctx, file_write_all, NULL, file_erase);
     DodaPersistStatus ps = doda_persist_save_table(&t, &stw);
     printf("persist save status=%d\n", (int)ps);
 
     // Load
     FileStorageCtx rctx = { path, false };
-    DodaStorage str = { &rctx, NULL, file_read_all, NULL };
+    DodaStorage str = DODA_STORAGE_INIT(&rctx, NULL, file_read_all, NULL);
     // reset simple reader by relying on static FILE* opening on first read
     DodaTable loaded;
     DodaPersistStatus pl = doda_persist_load_table(&loaded, &str);
@@ -144,7 +144,7 @@ static void test_persistence_load_only(void) {
     const char *path = "./doda_test.bin";
 
     FileStorageCtx rctx = { path, false };
-    DodaStorage str = { &rctx, NULL, file_read_all, NULL };
+    DodaStorage str = DODA_STORAGE_INIT(&rctx, NULL, file_read_all, NULL);
 
     DodaTable loaded;
     DodaPersistStatus pl = doda_persist_load_table(&loaded, &str);
@@ -158,20 +158,29 @@ static void test_persistence_load_only(void) {
             doda_print_row(&loaded, r);
 }
 
+#if defined(DODA_BUILD_FLASH_STUB)
 // Fake flash region in RAM for testing the flash stub adapter
 #define FAKE_FLASH_SIZE (64u * 1024u)
 static uint8_t g_fake_flash[FAKE_FLASH_SIZE];
 
+// Bytes the fake flash still programs before "losing power" (SIZE_MAX: never)
+static size_t g_fake_flash_budget = SIZE_MAX;
+
 static bool fake_flash_erase(uintptr_t base, size_t region_size) {
-    (void)base;
-    if (region_size > FAKE_FLASH_SIZE) return false;
-    memset(g_fake_flash, 0xFF, region_size);
+    if ((size_t)base + region_size > FAKE_FLASH_SIZE) return false;
+    memset(&g_fake_flash[(size_t)base], 0xFF, region_size);
     return true;
 }
 
 static bool fake_flash_program(uintptr_t addr, const void *data, size_t size) {
     // addr is treated as offset into g_fake_flash for this host test
     if ((size_t)addr + size > FAKE_FLASH_SIZE) return false;
+    if (size > g_fake_flash_budget) {
+        memcpy(&g_fake_flash[(size_t)addr], data, g_fake_flash_budget); // torn write
+        g_fake_flash_budget = 0;
+        return false;
+    }
+    if (g_fake_flash_budget != SIZE_MAX) g_fake_flash_budget -= size;
     memcpy(&g_fake_flash[(size_t)addr], data, size);
     return true;
 }
@@ -230,6 +239,44 @@ static void test_flash_stub_with_persistence(void) {
         if (!doda_is_deleted(&loaded, r))
             doda_print_row(&loaded, r);
 }
+
+// A/B slots: a save cut short by power loss leaves the previous snapshot loadable
+static void test_flash_ab_power_cut(void) {
+    const char *cols[] = {"id", "time", "value"};
+    DodaColumnType types[] = {COL_INT, COL_INT, COL_INT};
+    DodaTable t, loaded;
+    doda_init_table(&t, "ab", 3, cols, types);
+
+    DodaFlashStorageCtx fctx = {
+        .base_addr = 0,
+        .region_size = FAKE_FLASH_SIZE,
+        .cursor = 0,
+        .flash_erase_region = fake_flash_erase,
+        .flash_program = fake_flash_program,
+        .flash_read = fake_flash_read,
+        .user = NULL,
+    };
+    fake_flash_erase(0, FAKE_FLASH_SIZE);
+    DodaFlashAB ab;
+    doda_flash_ab_open(&ab, &fctx);
+
+    for (int gen = 1; gen <= 3; ++gen) {
+        int id = gen, tm = gen * 1000, v = gen * 11;
+        const void *vals[] = {&id, &tm, &v};
+        doda_insert_row(&t, vals);
+        if (gen == 3) g_fake_flash_budget = 100; // power fails partway through the third save
+        DodaPersistStatus ps = doda_flash_ab_save_table(&ab, &t);
+        printf("flash-ab save %d status=%d\n", gen, (int)ps);
+    }
+    g_fake_flash_budget = SIZE_MAX;
+
+    // "Reboot": only the two commit records are read
+    doda_flash_ab_open(&ab, &fctx);
+    DodaPersistStatus pl = doda_flash_ab_load_table(&ab, &loaded);
+    printf("flash-ab after power cut: slot=%d generation=%u load status=%d rows=%zu\n",
+           ab.active, ab.active >= 0 ? (unsigned)ab.generation[ab.active] : 0u, (int)pl, pl == DODA_PERSIST_OK ? loaded.count : 0u);
+}
+#endif
 #endif
 
 int main(void) {
@@ -243,6 +290,7 @@ int main(void) {
     test_persistence_load_only();
 #if defined(DODA_BUILD_FLASH_STUB)
     test_flash_stub_with_persistence();
+    test_flash_ab_power_cut();
 #else
     // Flash-stub demo requires -DDODA_BUILD_FLASH_STUB=ON (CMake option) to link.
 #endif
@@ -0,0 +1,158 @@
+#include "test_framework.h"
+#include "doda_agg.h"
+
+#include <math.h>
+#include <string.h>
+
+static uint32_t xorshift32(uint32_t *state) {
+    uint32_t x = *state; x ^= x << 13; x ^= x >> 17; x ^= x << 5; *state = x; return x;
+}
+
+static bool near(double a, double b) { return fabs(a - b) <= 1e-6 * (fabs(a) + fabs(b) + 1.0); }
+
+// Naive reference; squares are taken around the first value to avoid cancellation
+typedef struct { size_t n; double sum, min, max, shift, ssum, sq; } RefStats;
+
+static void ref_add(RefStats *r, double x) {
+    if (r->n == 0) { r->min = r->max = r->shift = x; }
+    if (x < r->min) r->min = x;
+    if (x > r->max) r->max = x;
+    r->n++; r->sum += x; r->ssum += x - r->shift; r->sq += (x - r->shift) * (x - r->shift);
+}
+
+static bool ref_matches(const RefStats *r, const DodaAggResult *a) {
+    if (r->n != a->count) return false;
+    if (r->n == 0) return a->sum == 0.0 && a->variance == 0.0;
+    double mean = r->sum / (double)r->n, sm = r->ssum / (double)r->n, var = r->sq / (double)r->n - sm * sm;
+    return near(r->sum, a->sum) && near(r->min, a->min) && near(r->max, a->max) && near(mean, a->mean) && near(var, a->variance);
+}
+
+#if !defined(DRIVERSQL_NO_FLOAT) && !defined(DRIVERSQL_NO_DOUBLE)
+DODA_TEST(test_agg_columns_one_pass_matches_reference) {
+    const char *cols[] = {"id", "i", "f", "d", "dev"};
+    DodaColumnType types[] = {COL_INT, COL_INT, COL_FLOAT, COL_DOUBLE, COL_INT};
+    DodaTable t;
+    doda_init_table(&t, "agg", 5, cols, types);
+    uint32_t rng = 0x5EED5u;
+    for (int i = 0; i < (int)MAX_ROWS - 5; ++i) {
+        int iv = (int)(xorshift32(&rng) % 2001u) - 1000, dev = i % 4;
+        float fv = (float)iv * 0.25f; double dv = (double)iv * 1e-3 + 1e6;
+        const void *vals[] = {&i, &iv, &fv, &dv, &dev};
+        DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_insert_row(&t, vals));
+    }
+    size_t deleted = 0;
+    for (int i = 0; i < (int)MAX_ROWS; i += 7) doda_delete_where_eq(&t, "id", &i, &deleted);
+
+    const char *metrics[] = {"i", "f", "d"};
+    int dev = 2;
+    DodaPredicate only_dev[] = {{"dev", OP_EQ, &dev}};
+    for (int filtered = 0; filtered < 2; ++filtered) {
+        RefStats ref[3]; memset(ref, 0, sizeof(ref));
+        for (size_t r = 0; r < t.count; ++r) {
+            if (doda_is_deleted(&t, r) || (filtered && t.columns[4].data.int_data[r] != dev)) continue;
+            ref_add(&ref[0], t.columns[1].data.int_data[r]);
+            ref_add(&ref[1], t.columns[2].data.float_data[r]);
+            ref_add(&ref[2], t.columns[3].data.double_data[r]);
+        }
+        DodaAggResult out[3];
+        DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_agg_columns(&t, metrics, 3, filtered ? only_dev : NULL, filtered ? 1u : 0u, out));
+        for (int k = 0; k < 3; ++k) DODA_ASSERT(ref_matches(&ref[k], &out[k]));
+    }
+
+    // Legacy helpers and the O(1) live count agree with the engine
+    DodaAggResult ri; int mn = 0, mx = 0; double avg = 0.0;
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_agg_column(&t, "i", NULL, 0, &ri));
+    DODA_ASSERT(agg_min_int(&t, "i", &mn) && agg_max_int(&t, "i", &mx) && agg_avg_int(&t, "i", &avg));
+    DODA_ASSERT_EQ_INT((int)ri.min, mn);
+    DODA_ASSERT_EQ_INT((int)ri.max, mx);
+    DODA_ASSERT(near(ri.mean, avg));
+    DODA_ASSERT_EQ_INT(ri.count, agg_count(&t));
+    DODA_ASSERT(!agg_min_int(&t, "f", &mn));
+
+    int none = 99;
+    DodaPredicate empty[] = {{"dev", OP_EQ, &none}};
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_agg_column(&t, "d", empty, 1, &ri));
+    DODA_ASSERT_EQ_INT(0, ri.count);
+    DODA_ASSERT_EQ_INT(DodaStatus_ERR_NOT_FOUND, doda_agg_column(&t, "nope", NULL, 0, &ri));
+}
+#endif
+
+#if !defined(DRIVERSQL_NO_DOUBLE) && !defined(DRIVERSQL_NO_TEXT)
+DODA_TEST(test_agg_group_by_int_and_text_keys) {
+    const char *cols[] = {"id", "dev", "name", "v"};
+    DodaColumnType types[] = {COL_INT, COL_INT, COL_TEXT, COL_DOUBLE};
+    DodaTable t;
+    doda_init_table(&t, "grp", 4, cols, types);
+    const char *names[] = {"gamma", "alpha", "beta"};
+    for (int i = 0; i < 90; ++i) {
+        int d = (i * 7) % 3; double v = (double)i;
+        const void *vals[] = {&i, &d, names[d], &v};
+        DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_insert_row(&t, vals));
+    }
+    size_t deleted = 0; int gone = 0;
+    doda_delete_where_eq(&t, "id", &gone, &deleted);
+
+    DodaAggGroup g[4]; size_t ng = 0;
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_agg_group_by(&t, "dev", "v", NULL, 0, g, 4, &ng));
+    DODA_ASSERT_EQ_INT(3, ng);
+    size_t total = 0;
+    for (size_t k = 0; k < ng; ++k) {
+        DODA_ASSERT_EQ_INT((int)k, g[k].key);
+        RefStats ref; memset(&ref, 0, sizeof(ref));
+        for (size_t r = 0; r < t.count; ++r) if (!doda_is_deleted(&t, r) && t.columns[1].data.int_data[r] == g[k].key) ref_add(&ref, t.columns[3].data.double_data[r]);
+        DODA_ASSERT(ref_matches(&ref, &g[k].stats));
+        total += g[k].stats.count;
+    }
+    DODA_ASSERT_EQ_INT(89, total);
+
+    // TEXT keys come back in byte order; filters apply before grouping
+    int lo = 45;
+    DodaPredicate late[] = {{"id", OP_GTE, &lo}};
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_agg_group_by(&t, "name", NULL, late, 1, g, 4, &ng));
+    DODA_ASSERT_EQ_INT(3, ng);
+    DODA_ASSERT(strcmp(t.columns[2].data.text_data[g[0].key_row], "alpha") == 0);
+    DODA_ASSERT(strcmp(t.columns[2].data.text_data[g[2].key_row], "gamma") == 0);
+    DODA_ASSERT_EQ_INT(45, g[0].stats.count + g[1].stats.count + g[2].stats.count);
+
+    DODA_ASSERT_EQ_INT(DodaStatus_ERR_FULL, doda_agg_group_by(&t, "dev", "v", NULL, 0, g, 2, &ng));
+    DODA_ASSERT_EQ_INT(2, ng);
+    DODA_ASSERT_EQ_INT(DodaStatus_ERR_UNSUPPORTED, doda_agg_group_by(&t, "v", NULL, NULL, 0, g, 4, &ng));
+}
+
+DODA_TEST(test_agg_group_by_full_keeps_complete_stats) {
+    const char *cols[] = {"id", "dev", "v"};
+    DodaColumnType types[] = {COL_INT, COL_INT, COL_DOUBLE};
+    DodaTable t;
+    doda_init_table(&t, "grp", 3, cols, types);
+    // Keys 5, 3, 9, 1 first appear in that order, then keep recurring
+    const int devs[] = {5, 3, 9, 1};
+    for (int i = 0; i < 120; ++i) {
+        int d = devs[(i * 5) % 4]; double v = (double)((i * 37) % 101) - 50.0;
+        const void *vals[] = {&i, &d, &v};
+        DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_insert_row(&t, vals));
+    }
+
+    // The first two keys met (5 and 3) keep stats over all of their rows, not a prefix
+    DodaAggGroup g[2]; size_t ng = 0;
+    DODA_ASSERT_EQ_INT(DodaStatus_ERR_FULL, doda_agg_group_by(&t, "dev", "v", NULL, 0, g, 2, &ng));
+    DODA_ASSERT_EQ_INT(2, ng);
+    DODA_ASSERT_EQ_INT(3, g[0].key);
+    DODA_ASSERT_EQ_INT(5, g[1].key);
+    for (size_t k = 0; k < ng; ++k) {
+        RefStats ref; memset(&ref, 0, sizeof(ref));
+        for (size_t r = 0; r < t.count; ++r) if (t.columns[1].data.int_data[r] == g[k].key) ref_add(&ref, t.columns[2].data.double_data[r]);
+        DODA_ASSERT_EQ_INT(30, g[k].stats.count);
+        DODA_ASSERT(ref_matches(&ref, &g[k].stats)); // variance is divided, not raw M2
+    }
+}
+#endif
+
+void doda_register_agg_tests(void) {
+#if !defined(DRIVERSQL_NO_FLOAT) && !defined(DRIVERSQL_NO_DOUBLE)
+    DODA_REGISTER(test_agg_columns_one_pass_matches_reference);
+#endif
+#if !defined(DRIVERSQL_NO_DOUBLE) && !defined(DRIVERSQL_NO_TEXT)
+    DODA_REGISTER(test_agg_group_by_int_and_text_keys);
+    DODA_REGISTER(test_agg_group_by_full_keeps_complete_stats);
+#endif
+}
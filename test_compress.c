@@ -0,0 +1,136 @@
+#include "test_framework.h"
+#include "doda_compress.h"
+
+#include <math.h>
+#include <string.h>
+
+#if !defined(DRIVERSQL_NO_FLOAT) && !defined(DRIVERSQL_NO_DOUBLE) && !defined(DRIVERSQL_NO_TEXT)
+static uint32_t xorshift32(uint32_t *state) {
+    uint32_t x = *state; x ^= x << 13; x ^= x >> 17; x ^= x << 5; *state = x; return x;
+}
+
+static bool near(double a, double b) { return fabs(a - b) <= 1e-9 * (fabs(a) + fabs(b) + 1.0); }
+
+// Mixed schema with deleted rows: every codec round-trips bit-exactly through unseal
+DODA_TEST(test_seal_roundtrip_all_codecs) {
+    const char *cols[] = {"id", "time", "temp", "volt", "ok", "tag"};
+    DodaColumnType types[] = {COL_INT, COL_INT, COL_FLOAT, COL_DOUBLE, COL_BOOL, COL_TEXT};
+    DodaTable t;
+    doda_init_table(&t, "src", 6, cols, types);
+    const char *tags[] = {"", "a", "sensor-long-tag"};
+    uint32_t rng = 0xC0DEu; int tm = -100000;
+    for (int i = 0; i < (int)MAX_ROWS; ++i) {
+        tm += (i % 50 == 0) ? (int)(xorshift32(&rng) % 3000u) - 1000 : 1; // mostly 1 Hz, with jumps backwards and forwards
+        float temp = (i % 3) ? 21.5f : 21.5f + (float)(xorshift32(&rng) % 100u) * 0.01f;
+        double volt = i == 7 ? -0.0 : 3.3 + (double)(xorshift32(&rng) % 1000u) * 1e-6;
+        int ok = (int)(xorshift32(&rng) & 1u), id = i * 1000003;
+        const void *vals[] = {&id, &tm, &temp, &volt, &ok, tags[i % 3]};
+        DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_insert_row(&t, vals));
+    }
+    for (size_t r = 3; r < t.count; r += 5) DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_delete_row(&t, r));
+
+    static uint8_t buf[64 * 1024];
+    size_t bound = doda_seal_bound_bytes(&t, t.count);
+    DODA_ASSERT(bound <= sizeof(buf));
+    DodaSealedBlock b;
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_seal_where(&t, NULL, 0, "time", buf, sizeof(buf), &b));
+    DODA_ASSERT_EQ_INT(t.count - t.free_top, b.rows);
+    DODA_ASSERT(b.bytes <= bound);
+    DODA_ASSERT_EQ_INT(SEAL_DOD, b.cols[1].codec);
+    DODA_ASSERT_EQ_INT(SEAL_VARINT, b.cols[0].codec);
+
+    DodaTable back;
+    doda_init_table(&back, "dst", 6, cols, types);
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_sealed_unseal(&b, &back));
+    DODA_ASSERT_EQ_INT(b.rows, back.count);
+    size_t k = 0;
+    for (size_t r = 0; r < t.count; ++r) {
+        if (doda_is_deleted(&t, r)) continue;
+        for (int c = 0; c < 6; ++c) {
+            const Column *x = &t.columns[c], *y = &back.columns[c];
+            switch (x->type) {
+                case COL_FLOAT: DODA_ASSERT(memcmp(&x->data.float_data[r], &y->data.float_data[k], sizeof(float)) == 0); break;
+                case COL_DOUBLE: DODA_ASSERT(memcmp(&x->data.double_data[r], &y->data.double_data[k], sizeof(double)) == 0); break;
+                case COL_BOOL: DODA_ASSERT_EQ_INT(x->data.bool_data[r], y->data.bool_data[k]); break;
+                case COL_TEXT: DODA_ASSERT(strcmp(x->data.text_data[r], y->data.text_data[k]) == 0); break;
+                default: DODA_ASSERT_EQ_INT(x->data.int_data[r], y->data.int_data[k]); break;
+            }
+        }
+        k++;
+    }
+
+    // Too small a buffer is reported, and damaged headers are rejected
+    DODA_ASSERT_EQ_INT(DodaStatus_ERR_FULL, doda_seal_where(&t, NULL, 0, "time", buf, b.bytes - 1u, &b));
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_seal_where(&t, NULL, 0, "time", buf, sizeof(buf), &b));
+    DodaSealedBlock v;
+    DODA_ASSERT_EQ_INT(DodaStatus_ERR_INVALID, doda_sealed_open(&v, buf, b.bytes - 1u));
+    buf[9] = (uint8_t)SEAL_XOR; // INT column claiming the XOR codec
+    DODA_ASSERT_EQ_INT(DodaStatus_ERR_INVALID, doda_sealed_open(&v, buf, b.bytes));
+    DODA_ASSERT_EQ_INT(DodaStatus_ERR_NOT_FOUND, doda_seal_where(&t, NULL, 0, "nope", buf, sizeof(buf), &b));
+    DODA_ASSERT_EQ_INT(DodaStatus_ERR_UNSUPPORTED, doda_seal_where(&t, NULL, 0, "temp", buf, sizeof(buf), &b));
+}
+
+// Block scans and aggregates agree with the same queries on the source table
+DODA_TEST(test_sealed_select_and_agg_match_table) {
+    const char *cols[] = {"id", "time", "dev", "v", "d"};
+    DodaColumnType types[] = {COL_INT, COL_INT, COL_INT, COL_FLOAT, COL_DOUBLE};
+    DodaTable t;
+    doda_init_table(&t, "src", 5, cols, types);
+    uint32_t rng = 0xBEEFu;
+    for (int i = 0; i < (int)MAX_ROWS; ++i) {
+        int tm = 1700000000 + i, dev = i % 4; float v = (float)(xorshift32(&rng) % 200u) * 0.5f; double d = 100.0 + (double)(i % 16) * 0.25;
+        const void *vals[] = {&i, &tm, &dev, &v, &d};
+        DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_insert_row(&t, vals));
+    }
+    for (int i = 0; i < (int)MAX_ROWS; i += 9) { size_t deleted = 0; doda_delete_where_eq(&t, "id", &i, &deleted); }
+
+    static uint8_t buf[32 * 1024];
+    DodaSealedBlock b;
+    int from = 1700000020;
+    DodaPredicate recent[] = {{"time", OP_GTE, &from}};
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_seal_where(&t, recent, 1, "time", buf, sizeof(buf), &b));
+    DODA_ASSERT_EQ_INT(t.count - t.free_top - 17u, b.rows); // rows 0..19 minus deleted 0, 9, 18
+    // 1 Hz time column: 1 bit per steady sample, 2 short codes around each deleted row
+    DODA_ASSERT(b.cols[1].bytes * 2u <= b.rows);
+
+    int dev = 2, lo_hi[2] = {1700000100, 1700000200}; float vmin = 40.0f;
+    DodaPredicate preds[] = {{"dev", OP_EQ, &dev}, {"time", OP_BETWEEN, lo_hi}, {"v", OP_GT, &vmin}};
+    for (size_t np = 1; np <= 3; ++np) {
+        uint64_t sel[(MAX_ROWS + 63) / 64]; size_t n = 0;
+        DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_sealed_select(&b, preds, np, sel, sizeof(sel) / sizeof(sel[0]), &n));
+        DodaPredicate all[4] = {recent[0], preds[0], preds[1], preds[2]};
+        uint32_t ids[MAX_ROWS]; DodaSelectCursor cur; size_t expect = 0, got = 0;
+        doda_select_cursor_init(&cur);
+        DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_select_into_all(&t, all, np + 1u, ids, MAX_ROWS, &cur, &expect));
+        DODA_ASSERT_EQ_INT(expect, n);
+        for (size_t w = 0; w < sizeof(sel) / sizeof(sel[0]); ++w) for (uint64_t m = sel[w]; m; m &= m - 1u) got++;
+        DODA_ASSERT_EQ_INT(n, got);
+
+        const char *metrics[] = {"time", "v", "d"};
+        DodaAggResult s[3], r[3];
+        DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_sealed_agg_columns(&b, metrics, 3, preds, np, s));
+        DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_agg_columns(&t, metrics, 3, all, np + 1u, r));
+        for (int m = 0; m < 3; ++m) {
+            DODA_ASSERT_EQ_INT(r[m].count, s[m].count);
+            DODA_ASSERT(near(r[m].sum, s[m].sum) && near(r[m].min, s[m].min) && near(r[m].max, s[m].max) && near(r[m].variance, s[m].variance));
+        }
+    }
+
+    int col = doda_sealed_column_index(&b, "d");
+    double dec[MAX_ROWS];
+    DODA_ASSERT(col == 4);
+    DODA_ASSERT_EQ_INT(DodaStatus_ERR_FULL, doda_sealed_decode_column(&b, col, dec, b.rows - 1u));
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_sealed_decode_column(&b, col, dec, MAX_ROWS));
+    DODA_ASSERT(dec[0] == 100.0 + 4.0 * 0.25); // row 20
+    DodaPredicate missing[] = {{"nope", OP_EQ, &dev}};
+    uint64_t sel[(MAX_ROWS + 63) / 64];
+    DODA_ASSERT_EQ_INT(DodaStatus_ERR_NOT_FOUND, doda_sealed_select(&b, missing, 1, sel, sizeof(sel) / sizeof(sel[0]), NULL));
+}
+#endif
+
+void doda_register_compress_tests(void) {
+#if !defined(DRIVERSQL_NO_FLOAT) && !defined(DRIVERSQL_NO_DOUBLE) && !defined(DRIVERSQL_NO_TEXT)
+    DODA_REGISTER(test_seal_roundtrip_all_codecs);
+    DODA_REGISTER(test_sealed_select_and_agg_match_table);
+#endif
+}
@@ -1,8 +1,12 @@
 #include "test_framework.h"
 #include "doda_engine.h"
+#include "doda_scan.h"
+#include "doda_agg.h"
 
+#include <stdio.h>
 #include <string.h>
 #include <stdint.h>
+#include <math.h>
 
 static void cb_count(const DodaTable *t, size_t row, void *user) {
     (void)t; (void)row;
@@ -192,24 +196,24 @@ DODA_TEST(test_index_eq_matches_full_scan) {
     DodaTable t;
     doda_init_table(&t, "idx", 2, cols, types);
 
-    // Insert many rows with repeated ids
+    // Insert many rows with repeated values (column 0 is the unique PK)
     uint32_t rng = 0x12345678u;
     for (int i = 0; i < 200; ++i) {
-        int id = (int)(xorshift32(&rng) % 64);
-        int v = i;
+        int id = i;
+        int v = (int)(xorshift32(&rng) % 64);
         const void *vals[] = { &id, &v };
         DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_insert_row(&t, vals));
     }
 
     DodaIndex idx;
-    DODA_ASSERT(doda_index_build(&t, &idx, "id"));
+    DODA_ASSERT(doda_index_build(&t, &idx, "v"));
 
     // Compare counts for a set of needles
     for (int needle = 0; needle < 64; needle += 7) {
         size_t scan_cnt = 0;
         size_t idx_cnt = 0;
 
-        doda_select_where_eq(&t, "id", &needle, cb_count, &scan_cnt);
+        doda_select_where_eq(&t, "v", &needle, cb_count, &scan_cnt);
         DodaIndexStatus s = doda_index_select_eq(&t, &idx, &needle, cb_count, &idx_cnt);
         DODA_ASSERT_EQ_INT(DodaIndexStatus_OK, s);
         DODA_ASSERT_EQ_INT(scan_cnt, idx_cnt);
@@ -225,20 +229,20 @@ DODA_TEST(test_index_range_gte_matches_full_scan) {
     doda_init_table(&t, "idxr", 2, cols, types);
 
     for (int i = 0; i < 200; ++i) {
-        int id = i % 50;
-        int v = i;
+        int id = i;
+        int v = i % 50;
         const void *vals[] = { &id, &v };
         DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_insert_row(&t, vals));
     }
 
     DodaIndex idx;
-    DODA_ASSERT(doda_index_build(&t, &idx, "id"));
+    DODA_ASSERT(doda_index_build(&t, &idx, "v"));
 
     int needle = 25;
     size_t scan_cnt = 0;
     size_t idx_cnt = 0;
 
-    doda_select_where_op(&t, "id", DodaOp_GTE, &needle, cb_count, &scan_cnt);
+    doda_select_where_op(&t, "v", DodaOp_GTE, &needle, cb_count, &scan_cnt);
     DodaIndexStatus s = doda_index_select_op(&t, &idx, DodaOp_GTE, &needle, cb_count, &idx_cnt);
     DODA_ASSERT_EQ_INT(DodaIndexStatus_OK, s);
     DODA_ASSERT_EQ_INT(scan_cnt, idx_cnt);
@@ -246,6 +250,689 @@ DODA_TEST(test_index_range_gte_matches_full_scan) {
     doda_index_drop(&idx);
 }
 
+DODA_TEST(test_arena_table_beyond_max_rows) {
+    enum { ROWS = (int)MAX_ROWS * 8 };
+    const char *cols[] = {"id", "temp", "flag"};
+#ifndef DRIVERSQL_NO_FLOAT
+    DodaColumnType types[] = {COL_INT, COL_FLOAT, COL_BOOL};
+#else
+    DodaColumnType types[] = {COL_INT, COL_INT, COL_BOOL};
+#endif
+    size_t need = doda_table_arena_bytes(3, types, ROWS);
+    DODA_ASSERT(need > 0);
+    // Dense per-type layout: far smaller than MAX_COLUMNS x union-sized columns
+    DODA_ASSERT(need < (size_t)ROWS * 32u);
+    // Capacities whose sizes would wrap size_t are refused, never undersized
+    DODA_ASSERT_EQ_INT(0, doda_table_arena_bytes(3, types, SIZE_MAX / 2u));
+    DODA_ASSERT_EQ_INT(0, doda_table_arena_bytes(3, types, SIZE_MAX / 8u + 1u));
+
+    static uint64_t arena[(ROWS * 32) / sizeof(uint64_t)];
+    DodaTable t;
+    DODA_ASSERT_EQ_INT(DodaStatus_ERR_INVALID, doda_table_init_arena(&t, "big", 3, cols, types, arena, need - 16u, ROWS));
+    DODA_ASSERT_EQ_INT(DodaStatus_ERR_INVALID, doda_table_init_arena(&t, "big", 3, cols, types, arena, SIZE_MAX, SIZE_MAX / 8u + 1u));
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_table_init_arena(&t, "big", 3, cols, types, arena, sizeof(arena), ROWS));
+    DODA_ASSERT_EQ_INT(ROWS, t.capacity);
+
+    for (int i = 0; i < ROWS; ++i) {
+        int id = 100000 + i, flag = i & 1;
+#ifndef DRIVERSQL_NO_FLOAT
+        float temp = (float)i * 0.5f;
+#else
+        int temp = i;
+#endif
+        const void *vals[] = {&id, &temp, &flag};
+        DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_insert_row(&t, vals));
+    }
+    int extra = 1;
+#ifndef DRIVERSQL_NO_FLOAT
+    float ftemp = 0.0f;
+    const void *xvals[] = {&extra, &ftemp, &extra};
+#else
+    const void *xvals[] = {&extra, &extra, &extra};
+#endif
+    DODA_ASSERT_EQ_INT(DodaStatus_ERR_FULL, doda_insert_row(&t, xvals));
+
+    // PK lookups past the 16-bit row id range of the fixed tables
+    size_t cnt = 0;
+    int needle = 100000 + ROWS - 1;
+    doda_select_where_eq(&t, "id", &needle, cb_count, &cnt);
+    DODA_ASSERT_EQ_INT(1, cnt);
+
+    size_t deleted = 0;
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_delete_where_eq(&t, "id", &needle, &deleted));
+    DODA_ASSERT_EQ_INT(1, deleted);
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_insert_row(&t, xvals));
+
+    cnt = 0;
+    int one = 1;
+    doda_select_where_eq(&t, "flag", &one, cb_count, &cnt);
+    DODA_ASSERT_EQ_INT(ROWS / 2, cnt);
+
+    static uint32_t idx_rows[ROWS];
+    DodaIndex idx;
+    DODA_ASSERT(!doda_index_build(&t, &idx, "id"));
+    DODA_ASSERT(doda_index_build_arena(&t, &idx, "id", idx_rows, ROWS));
+    cnt = 0;
+    int lo = 100000 + ROWS - 10;
+    DODA_ASSERT_EQ_INT(DodaIndexStatus_OK, doda_index_select_op(&t, &idx, DodaOp_GTE, &lo, cb_count, &cnt));
+    DODA_ASSERT_EQ_INT(9, cnt);
+}
+
+DODA_TEST(test_duplicate_pk_does_not_consume_slot) {
+    const char *cols[] = {"id", "v"};
+    DodaColumnType types[] = {COL_INT, COL_INT};
+    DodaTable t;
+    doda_init_table(&t, "dup", 2, cols, types);
+
+    int id = 7, v = 1;
+    const void *vals[] = {&id, &v};
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_insert_row(&t, vals));
+    DODA_ASSERT_EQ_INT(DodaStatus_ERR_UNSUPPORTED, doda_insert_row(&t, vals));
+    DODA_ASSERT_EQ_INT(1, t.count);
+}
+
+DODA_TEST(test_pk_hash_churn_lookups_and_probe_bound) {
+    enum { ROWS = 4096, UNIV = 1 << 16, LIVE = 3000 };
+    const char *cols[] = {"id", "v"};
+    DodaColumnType types[] = {COL_INT, COL_INT};
+    static uint64_t arena[(ROWS * 24) / sizeof(uint64_t)];
+    DodaTable t;
+    DODA_ASSERT(doda_table_arena_bytes(2, types, ROWS) <= sizeof(arena));
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_table_init_arena(&t, "churn", 2, cols, types, arena, sizeof(arena), ROWS));
+
+    static bool present[UNIV];
+    static int live[LIVE];
+    memset(present, 0, sizeof(present));
+    uint32_t rng = 0xBADC0DEu;
+    for (int i = 0; i < LIVE; ++i) {
+        int id;
+        do { id = (int)(xorshift32(&rng) % UNIV); } while (present[id]);
+        const void *vals[] = {&id, &i};
+        DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_insert_row(&t, vals));
+        present[id] = true; live[i] = id;
+    }
+
+    // Sustained delete/insert churn: chains must never be truncated by deletes
+    for (int step = 0; step < 200000; ++step) {
+        int slot = (int)(xorshift32(&rng) % LIVE);
+        size_t deleted = 0;
+        DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_delete_where_eq(&t, "id", &live[slot], &deleted));
+        DODA_ASSERT_EQ_INT(1, deleted);
+        present[live[slot]] = false;
+        int id;
+        do { id = (int)(xorshift32(&rng) % UNIV); } while (present[id]);
+        const void *vals[] = {&id, &step};
+        DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_insert_row(&t, vals));
+        present[id] = true; live[slot] = id;
+
+        if ((step % 20000) == 0) {
+            size_t found = 0;
+            for (int i = 0; i < LIVE; ++i) doda_select_where_eq(&t, "id", &live[i], cb_count, &found);
+            DODA_ASSERT_EQ_INT(LIVE, found);
+            PkHashStats hs;
+            pk_hash_stats((const Table *)&t, &hs);
+            DODA_ASSERT_EQ_INT(LIVE, hs.keys);
+            DODA_ASSERT(hs.keys * 2u <= hs.slots);
+            DODA_ASSERT(hs.max_probe <= 48u);
+            DODA_ASSERT(hs.total_probe <= hs.keys * 3u);
+        }
+    }
+}
+
+typedef struct { const DodaTable *t; int col; int last; bool sorted; size_t n; } OrderCheck;
+
+static void cb_check_sorted(const DodaTable *t, size_t row, void *user) {
+    OrderCheck *oc = (OrderCheck *)user;
+    int v = t->columns[oc->col].data.int_data[row];
+    if (oc->n > 0 && v < oc->last) oc->sorted = false;
+    oc->last = v; oc->n++;
+}
+
+DODA_TEST(test_attached_index_maintained_on_insert_delete) {
+    const char *cols[] = {"id", "v"};
+    DodaColumnType types[] = {COL_INT, COL_INT};
+    DodaTable t;
+    doda_init_table(&t, "live", 2, cols, types);
+
+    DodaIndex idx;
+    DODA_ASSERT(doda_index_build(&t, &idx, "v"));
+    DODA_ASSERT(doda_index_attach(&t, &idx));
+
+    uint32_t rng = 0x51u;
+    bool present[MAX_ROWS];
+    int vals_by_id[MAX_ROWS];
+    memset(present, 0, sizeof(present));
+    for (int step = 0; step < 3000; ++step) {
+        int id = (int)(xorshift32(&rng) % MAX_ROWS);
+        if (!present[id]) {
+            int v = (int)(xorshift32(&rng) % 40);
+            const void *vals[] = {&id, &v};
+            DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_insert_row(&t, vals));
+            present[id] = true; vals_by_id[id] = v;
+        } else {
+            size_t deleted = 0;
+            DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_delete_where_eq(&t, "id", &id, &deleted));
+            present[id] = false;
+        }
+
+        if ((step % 250) == 0) {
+            size_t live = 0, expect_ge = 0;
+            int needle = 20;
+            for (int i = 0; i < (int)MAX_ROWS; ++i) if (present[i]) { live++; if (vals_by_id[i] >= needle) expect_ge++; }
+            DODA_ASSERT(idx.active);
+            DODA_ASSERT_EQ_INT(live, idx.size);
+            // Entries stay in strict (key, row id) order across inserts and deletes
+            bool ordered = true;
+            for (size_t i = 1; i < idx.size; ++i) {
+                uint32_t a = idx.rows[i - 1], b = idx.rows[i];
+                int va = t.columns[1].data.int_data[a], vb = t.columns[1].data.int_data[b];
+                ordered &= va < vb || (va == vb && a < b);
+            }
+            DODA_ASSERT(ordered);
+
+            // select_where_op is served by the attached index: rows arrive in key order
+            OrderCheck oc = { &t, 1, 0, true, 0 };
+            doda_select_where_op(&t, "v", DodaOp_GTE, &needle, cb_check_sorted, &oc);
+            DODA_ASSERT(oc.sorted);
+            DODA_ASSERT_EQ_INT(expect_ge, oc.n);
+        }
+    }
+
+    doda_index_detach(&t, &idx);
+    DODA_ASSERT_EQ_INT(0, t.index_count);
+
+    // An index whose row buffer is exactly full deactivates on the next insert and says so
+    int free_id = -1;
+    for (int i = 0; i < (int)MAX_ROWS && free_id < 0; ++i) if (!present[i]) free_id = i;
+    DODA_ASSERT(free_id >= 0);
+    static uint32_t tight[MAX_ROWS];
+    DODA_ASSERT(doda_index_build_arena(&t, &idx, "v", tight, idx.size));
+    DODA_ASSERT(doda_index_attach(&t, &idx));
+    int v = 7, key = 7; const void *vals[] = {&free_id, &v};
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_insert_row(&t, vals));
+    DODA_ASSERT(!idx.active && idx.full);
+    size_t via_idx = 0, via_scan = 0;
+    DODA_ASSERT_EQ_INT(DodaIndexStatus_FULL, doda_index_select_op(&t, &idx, DodaOp_EQ, &key, cb_count, &via_idx));
+    doda_select_where_eq(&t, "v", &key, cb_count, &via_scan);
+    size_t expect = 1;
+    for (int i = 0; i < (int)MAX_ROWS; ++i) if (present[i] && vals_by_id[i] == key) expect++;
+    DODA_ASSERT_EQ_INT(expect, via_scan);
+    doda_index_detach(&t, &idx);
+
+    // Bulk-adopted rows: an index with room is rebuilt, one without is flagged full
+    static uint64_t arena[256];
+    static uint32_t roomy[8], small[4];
+    DodaTable b; DodaIndex fits, tiny;
+    DODA_ASSERT(doda_table_arena_bytes(2, types, 8) <= sizeof(arena));
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_table_init_arena(&b, "adopt", 2, cols, types, arena, sizeof(arena), 8));
+    DODA_ASSERT(doda_index_build_arena(&b, &fits, "v", roomy, 8) && doda_index_attach(&b, &fits));
+    DODA_ASSERT(doda_index_build_arena(&b, &tiny, "v", small, 4) && doda_index_attach(&b, &tiny));
+    for (int r = 0; r < 6; ++r) { b.columns[0].data.int_data[r] = r; b.columns[1].data.int_data[r] = 5 - r; }
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_table_adopt_rows(&b, 6));
+    DODA_ASSERT(fits.active && !fits.full);
+    DODA_ASSERT_EQ_INT(6, fits.size);
+    DODA_ASSERT_EQ_INT(5u, fits.rows[0]);
+    DODA_ASSERT(!tiny.active && tiny.full);
+    via_idx = 0;
+    DODA_ASSERT_EQ_INT(DodaIndexStatus_FULL, doda_index_select_op(&b, &tiny, DodaOp_EQ, &key, cb_count, &via_idx));
+}
+
+#ifndef DRIVERSQL_NO_FLOAT
+// Build and maintenance agree on one key order: both zeros are one key, NaNs sit past +inf
+DODA_TEST(test_attached_float_index_signed_zeros_and_nan) {
+    const char *cols[] = {"id", "f"};
+    DodaColumnType types[] = {COL_INT, COL_FLOAT};
+    static uint64_t arena[1024];
+    DodaTable t;
+    DODA_ASSERT(doda_table_arena_bytes(2, types, 40) <= sizeof(arena));
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_table_init_arena(&t, "zeros", 2, cols, types, arena, sizeof(arena), 40));
+    for (int i = 0; i < 40; ++i) {
+        float f = (i & 1) ? -0.0f : 0.0f;
+        const void *vals[] = {&i, &f};
+        DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_insert_row(&t, vals));
+    }
+    DodaIndex idx;
+    DODA_ASSERT(doda_index_build(&t, &idx, "f"));
+    DODA_ASSERT(doda_index_attach(&t, &idx));
+    for (int i = 0; i < 10; ++i) {
+        int id = i * 3; size_t deleted = 0;
+        DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_delete_where_eq(&t, "id", &id, &deleted));
+        DODA_ASSERT_EQ_INT(1, deleted);
+    }
+    DODA_ASSERT(idx.active);
+    DODA_ASSERT_EQ_INT(30, idx.size);
+
+    // Recycled slots come back once each
+    for (int i = 40; i < 50; ++i) {
+        float f = (i & 1) ? -0.0f : 0.0f;
+        const void *vals[] = {&i, &f};
+        DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_insert_row(&t, vals));
+    }
+    static uint16_t got[MAX_ROWS + 1];
+    bool seen[40] = {false}, unique = true;
+    float zero = 0.0f;
+    got[0] = 0;
+    DODA_ASSERT_EQ_INT(DodaIndexStatus_OK, doda_index_select_eq(&t, &idx, &zero, cb_collect_row_ids, got));
+    DODA_ASSERT_EQ_INT(40, got[0]);
+    for (int i = 0; i < got[0]; ++i) { uint16_t r = got[1 + i]; unique &= r < 40 && !seen[r]; if (r < 40) seen[r] = true; }
+    DODA_ASSERT(unique);
+
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_delete_row(&t, 1));
+    float nan = NAN;
+    int id = 100; const void *vals[] = {&id, &nan};
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_insert_row(&t, vals));
+    DODA_ASSERT_EQ_INT(40, idx.size);
+    DODA_ASSERT_EQ_INT(1u, idx.rows[39]);
+    size_t deleted = 0;
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_delete_where_eq(&t, "id", &id, &deleted));
+    DODA_ASSERT_EQ_INT(39, idx.size);
+    doda_index_detach(&t, &idx);
+}
+#endif
+
+#if !defined(DRIVERSQL_NO_FLOAT) && !defined(DRIVERSQL_NO_DOUBLE) && !defined(DRIVERSQL_NO_TEXT)
+DODA_TEST(test_index_build_radix_orders_all_types) {
+    enum { ROWS = 6000 };
+    const char *cols[] = {"id", "i", "f", "d", "s"};
+    DodaColumnType types[] = {COL_INT, COL_INT, COL_FLOAT, COL_DOUBLE, COL_TEXT};
+    static uint64_t arena[(ROWS * (4 + 4 + 4 + 8 + MAX_TEXT_LEN + 17)) / sizeof(uint64_t)];
+    DodaTable t;
+    DODA_ASSERT(doda_table_arena_bytes(5, types, ROWS) <= sizeof(arena));
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_table_init_arena(&t, "radix", 5, cols, types, arena, sizeof(arena), ROWS));
+
+    uint32_t rng = 0xACE1u;
+    for (int r = 0; r < ROWS; ++r) {
+        int iv = (int)xorshift32(&rng);
+        float fv = (float)((int)(xorshift32(&rng) % 20001u) - 10000) / 7.0f;
+        double dv = (double)(int32_t)xorshift32(&rng) * 1e-3;
+        char sv[MAX_TEXT_LEN];
+        // Long shared prefixes exercise the deep-bucket fallback
+        if (r & 1) snprintf(sv, sizeof(sv), "sensor/building-a/floor-%u", (unsigned)(xorshift32(&rng) % 50u));
+        else snprintf(sv, sizeof(sv), "%u", (unsigned)(xorshift32(&rng) % 100000u));
+        const void *vals[] = {&r, &iv, &fv, &dv, sv};
+        DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_insert_row(&t, vals));
+    }
+    size_t deleted = 0;
+    for (int r = 0; r < ROWS; r += 3) doda_delete_where_eq(&t, "id", &r, &deleted);
+
+    static uint32_t rows[ROWS];
+    for (int c = 1; c < 5; ++c) {
+        DodaIndex idx;
+        DODA_ASSERT(doda_index_build_arena(&t, &idx, cols[c], rows, ROWS));
+        DODA_ASSERT_EQ_INT(ROWS - ROWS / 3, idx.size);
+        const Column *col = &t.columns[c];
+        bool sorted = true;
+        for (size_t i = 1; i < idx.size; ++i) {
+            uint32_t a = idx.rows[i - 1], b = idx.rows[i]; int d;
+            if (col->type == COL_INT) d = (col->data.int_data[a] > col->data.int_data[b]) - (col->data.int_data[a] < col->data.int_data[b]);
+            else if (col->type == COL_FLOAT) d = (col->data.float_data[a] > col->data.float_data[b]) - (col->data.float_data[a] < col->data.float_data[b]);
+            else if (col->type == COL_DOUBLE) d = (col->data.double_data[a] > col->data.double_data[b]) - (col->data.double_data[a] < col->data.double_data[b]);
+            else d = strncmp(col->data.text_data[a], col->data.text_data[b], MAX_TEXT_LEN);
+            sorted &= d < 0 || (d == 0 && a < b); // equal keys by row id
+        }
+        DODA_ASSERT_MSG(sorted, cols[c]);
+    }
+}
+#endif
+
+static bool op_holds_int(int v, Op op, int k) {
+    switch (op) {
+        case OP_EQ: return v == k; case OP_GT: return v > k; case OP_LT: return v < k;
+        case OP_GTE: return v >= k; case OP_LTE: return v <= k; case OP_NE: return v != k; default: return false;
+    }
+}
+
+DODA_TEST(test_scan_kernels_match_scalar_reference) {
+    const Op ops[] = {OP_EQ, OP_GT, OP_LT, OP_GTE, OP_LTE, OP_NE};
+    uint32_t rng = 0x1234567u;
+    int iv[64];
+#ifndef DRIVERSQL_NO_FLOAT
+    float fv[64];
+#endif
+#ifndef DRIVERSQL_NO_DOUBLE
+    double dv[64];
+#endif
+    for (int round = 0; round < 200; ++round) {
+        size_t n = xorshift32(&rng) % 65u;
+        for (size_t i = 0; i < 64; ++i) {
+            iv[i] = (int)(xorshift32(&rng) % 9u) - 4;
+#ifndef DRIVERSQL_NO_FLOAT
+            fv[i] = (float)iv[i] * 0.5f;
+#endif
+#ifndef DRIVERSQL_NO_DOUBLE
+            dv[i] = (double)iv[i] * 0.25;
+#endif
+        }
+        int key = (int)(xorshift32(&rng) % 9u) - 4;
+        for (size_t o = 0; o < sizeof(ops) / sizeof(ops[0]); ++o) {
+            uint64_t expect = 0;
+            for (size_t i = 0; i < n; ++i) if (op_holds_int(iv[i], ops[o], key)) expect |= 1ULL << i;
+            DODA_ASSERT(scan_mask_int(iv, n, ops[o], key) == expect);
+#ifndef DRIVERSQL_NO_FLOAT
+            DODA_ASSERT(scan_mask_float(fv, n, ops[o], (float)key * 0.5f) == expect);
+#endif
+#ifndef DRIVERSQL_NO_DOUBLE
+            DODA_ASSERT(scan_mask_double(dv, n, ops[o], (double)key * 0.25) == expect);
+#endif
+        }
+    }
+}
+
+DODA_TEST(test_select_where_op_skips_deleted_rows) {
+    const char *cols[] = {"id", "v"};
+    DodaColumnType types[] = {COL_INT, COL_INT};
+    DodaTable t;
+    doda_init_table(&t, "scan", 2, cols, types);
+    for (int i = 0; i < (int)MAX_ROWS - 3; ++i) {
+        int v = i % 17;
+        const void *vals[] = {&i, &v};
+        DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_insert_row(&t, vals));
+    }
+    size_t deleted = 0;
+    for (int i = 0; i < (int)MAX_ROWS; i += 5) doda_delete_where_eq(&t, "id", &i, &deleted);
+
+    const Op ops[] = {OP_EQ, OP_GT, OP_LT, OP_GTE, OP_LTE, OP_NE};
+    for (size_t o = 0; o < sizeof(ops) / sizeof(ops[0]); ++o) {
+        int key = 8;
+        size_t expect = 0, got = 0;
+        for (size_t r = 0; r < t.count; ++r) if (!doda_is_deleted(&t, r) && op_holds_int(t.columns[1].data.int_data[r], ops[o], key)) expect++;
+        DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_select_where_op(&t, "v", (DodaOp)ops[o], &key, cb_count, &got));
+        DODA_ASSERT_EQ_INT(expect, got);
+    }
+}
+
+typedef struct { uint32_t rows[MAX_ROWS]; size_t n; } RowLog;
+static void cb_log(const DodaTable *t, size_t row, void *user) { (void)t; RowLog *l = (RowLog *)user; l->rows[l->n++] = (uint32_t)row; }
+
+// Drain a predicate through select_into in chunks of `cap` rows
+static size_t drain_select_into(const DodaTable *t, const DodaPredicate *p, size_t cap, uint32_t *out) {
+    DodaSelectCursor cur; doda_select_cursor_init(&cur);
+    size_t total = 0, n = 0;
+    while (doda_select_into(t, p, out + total, cap, &cur, &n) == DodaStatus_OK && n > 0) total += n;
+    return total;
+}
+
+DODA_TEST(test_select_into_chunks_match_callbacks) {
+    const char *cols[] = {"id", "v", "flag"};
+    DodaColumnType types[] = {COL_INT, COL_INT, COL_BOOL};
+    DodaTable t;
+    doda_init_table(&t, "sel", 3, cols, types);
+    for (int i = 0; i < (int)MAX_ROWS; ++i) {
+        int v = (i * 7) % 23, flag = i & 1;
+        const void *vals[] = {&i, &v, &flag};
+        DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_insert_row(&t, vals));
+    }
+    size_t deleted = 0;
+    for (int i = 3; i < (int)MAX_ROWS; i += 11) doda_delete_where_eq(&t, "id", &i, &deleted);
+
+    static RowLog ref; static uint32_t got[MAX_ROWS];
+    const DodaOp ops[] = {DodaOp_EQ, DodaOp_GT, DodaOp_LT, DodaOp_GTE, DodaOp_LTE, DodaOp_NE};
+    const size_t caps[] = {1, 7, 64, MAX_ROWS};
+    DodaIndex idx;
+    for (int pass = 0; pass < 2; ++pass) {
+        if (pass == 1) { DODA_ASSERT(doda_index_build(&t, &idx, "v")); DODA_ASSERT(doda_index_attach(&t, &idx)); }
+        for (size_t o = 0; o < sizeof(ops) / sizeof(ops[0]); ++o) {
+            int key = 11;
+            DodaPredicate p = {"v", (Op)ops[o], &key};
+            ref.n = 0;
+            DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_select_where_op(&t, "v", ops[o], &key, cb_log, &ref));
+            for (size_t c = 0; c < sizeof(caps) / sizeof(caps[0]); ++c) {
+                DODA_ASSERT_EQ_INT(ref.n, drain_select_into(&t, &p, caps[c], got));
+                DODA_ASSERT(memcmp(ref.rows, got, ref.n * sizeof(got[0])) == 0);
+            }
+        }
+    }
+    doda_index_detach(&t, &idx);
+
+    // pk path and a chained filter on another column
+    int id = 40; DodaPredicate pk = {"id", OP_EQ, &id};
+    DODA_ASSERT_EQ_INT(1, drain_select_into(&t, &pk, 4, got));
+    DODA_ASSERT_EQ_INT(40, got[0]);
+    id = 3; DODA_ASSERT_EQ_INT(0, drain_select_into(&t, &pk, 4, got));
+
+    int lo = 5, one = 1;
+    DodaPredicate gt = {"v", OP_GT, &lo}, odd = {"flag", OP_EQ, &one};
+    size_t n = drain_select_into(&t, &gt, 16, got), expect = 0;
+    for (size_t r = 0; r < t.count; ++r) if (!doda_is_deleted(&t, r) && t.columns[1].data.int_data[r] > lo && (r & 1u)) expect++;
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_select_filter(&t, &odd, got, &n));
+    DODA_ASSERT_EQ_INT(expect, n);
+    for (size_t i = 0; i < n; ++i) DODA_ASSERT(got[i] & 1u);
+
+    DodaPredicate bad = {"missing", OP_EQ, &lo};
+    DodaSelectCursor cur; doda_select_cursor_init(&cur);
+    DODA_ASSERT_EQ_INT(DodaStatus_ERR_NOT_FOUND, doda_select_into(&t, &bad, got, 4, &cur, &n));
+}
+
+DODA_TEST(test_select_where_all_conjunction) {
+    const char *cols[] = {"id", "ts", "sensor"};
+    DodaColumnType types[] = {COL_INT, COL_INT, COL_INT};
+    DodaTable t;
+    doda_init_table(&t, "win", 3, cols, types);
+    for (int i = 0; i < (int)MAX_ROWS; ++i) {
+        int ts = 1000 + i * 10, sensor = i % 5;
+        const void *vals[] = {&i, &ts, &sensor};
+        DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_insert_row(&t, vals));
+    }
+    size_t deleted = 0;
+    for (int i = 0; i < (int)MAX_ROWS; i += 9) doda_delete_where_eq(&t, "id", &i, &deleted);
+
+    int t0 = 1300, t1 = 2100, sensor = 2;
+    DodaPredicate win[] = {{"ts", OP_GTE, &t0}, {"ts", OP_LT, &t1}, {"sensor", OP_EQ, &sensor}};
+    size_t expect = 0;
+    for (size_t r = 0; r < t.count; ++r) {
+        int ts = t.columns[1].data.int_data[r];
+        if (!doda_is_deleted(&t, r) && ts >= t0 && ts < t1 && t.columns[2].data.int_data[r] == sensor) expect++;
+    }
+    DODA_ASSERT(expect > 0);
+
+    static RowLog scan, via_idx; static uint32_t got[MAX_ROWS];
+    scan.n = 0;
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_select_where_all(&t, win, 3, cb_log, &scan));
+    DODA_ASSERT_EQ_INT(expect, scan.n);
+
+    // Index on ts drives; same rows (key order == row order here)
+    DodaIndex idx;
+    DODA_ASSERT(doda_index_build(&t, &idx, "ts")); DODA_ASSERT(doda_index_attach(&t, &idx));
+    via_idx.n = 0;
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_select_where_all(&t, win, 3, cb_log, &via_idx));
+    DODA_ASSERT_EQ_INT(expect, via_idx.n);
+    DODA_ASSERT(memcmp(scan.rows, via_idx.rows, expect * sizeof(scan.rows[0])) == 0);
+
+    DodaSelectCursor cur; doda_select_cursor_init(&cur);
+    size_t total = 0, n = 0;
+    while (doda_select_into_all(&t, win, 3, got + total, 3, &cur, &n) == DodaStatus_OK && n > 0) total += n;
+    DODA_ASSERT_EQ_INT(expect, total);
+    doda_index_detach(&t, &idx);
+
+    // pk equality drives, residual predicate still applies
+    int id = 12, other = 1;
+    DodaPredicate pk_hit[] = {{"sensor", OP_EQ, &sensor}, {"id", OP_EQ, &id}};
+    DodaPredicate pk_miss[] = {{"sensor", OP_EQ, &other}, {"id", OP_EQ, &id}};
+    scan.n = 0; doda_select_where_all(&t, pk_hit, 2, cb_log, &scan);
+    DODA_ASSERT_EQ_INT(1, scan.n);
+    scan.n = 0; doda_select_where_all(&t, pk_miss, 2, cb_log, &scan);
+    DODA_ASSERT_EQ_INT(0, scan.n);
+
+    // empty intersection and bad arguments
+    int late = 1000000;
+    DodaPredicate none[] = {{"sensor", OP_EQ, &sensor}, {"ts", OP_GT, &late}};
+    scan.n = 0; DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_select_where_all(&t, none, 2, cb_log, &scan));
+    DODA_ASSERT_EQ_INT(0, scan.n);
+    DODA_ASSERT_EQ_INT(DodaStatus_ERR_INVALID, doda_select_where_all(&t, none, 0, cb_log, &scan));
+    DodaPredicate bad[] = {{"sensor", OP_EQ, &sensor}, {"nope", OP_EQ, &sensor}};
+    DODA_ASSERT_EQ_INT(DodaStatus_ERR_NOT_FOUND, doda_select_where_all(&t, bad, 2, cb_log, &scan));
+}
+
+#ifndef DRIVERSQL_NO_DOUBLE
+DODA_TEST(test_between_index_matches_scan) {
+    const char *cols[] = {"id", "v", "f"};
+    DodaColumnType types[] = {COL_INT, COL_INT, COL_DOUBLE};
+    DodaTable t;
+    doda_init_table(&t, "rng", 3, cols, types);
+    uint32_t rng = 0xABCDEFu;
+    for (int i = 0; i < (int)MAX_ROWS; ++i) {
+        int v = (int)(xorshift32(&rng) % 100u) - 50; double f = v * 0.5;
+        const void *vals[] = {&i, &v, &f};
+        DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_insert_row(&t, vals));
+    }
+    size_t deleted = 0;
+    for (int i = 1; i < (int)MAX_ROWS; i += 6) doda_delete_where_eq(&t, "id", &i, &deleted);
+
+    const int bounds[][2] = {{-10, 10}, {-50, -50}, {20, 19}, {49, 1000}, {-1000, 1000}};
+    DodaIndex iv, fv;
+    DODA_ASSERT(doda_index_build(&t, &iv, "v"));
+    DODA_ASSERT(doda_index_build(&t, &fv, "f"));
+    for (size_t b = 0; b < sizeof(bounds) / sizeof(bounds[0]); ++b) {
+        const int *k = bounds[b]; double kf[2] = {k[0] * 0.5, k[1] * 0.5};
+        size_t expect = 0, scan = 0, scan_f = 0, via_idx = 0, via_idx_f = 0;
+        for (size_t r = 0; r < t.count; ++r) {
+            int v = t.columns[1].data.int_data[r];
+            if (!doda_is_deleted(&t, r) && v >= k[0] && v <= k[1]) expect++;
+        }
+        DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_select_where_op(&t, "v", DodaOp_BETWEEN, k, cb_count, &scan));
+        DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_select_where_op(&t, "f", DodaOp_BETWEEN, kf, cb_count, &scan_f));
+        DODA_ASSERT_EQ_INT(DodaIndexStatus_OK, doda_index_select_op(&t, &iv, DodaOp_BETWEEN, k, cb_count, &via_idx));
+        DODA_ASSERT_EQ_INT(DodaIndexStatus_OK, doda_index_select_op(&t, &fv, DodaOp_BETWEEN, kf, cb_count, &via_idx_f));
+        DODA_ASSERT_EQ_INT(expect, scan);
+        DODA_ASSERT_EQ_INT(expect, scan_f);
+        DODA_ASSERT_EQ_INT(expect, via_idx);
+        DODA_ASSERT_EQ_INT(expect, via_idx_f);
+    }
+
+    // LTE via index; NE is not a single range, so the index declines it
+    int key = 0; size_t scan = 0, via_idx = 0;
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_select_where_op(&t, "v", DodaOp_LTE, &key, cb_count, &scan));
+    DODA_ASSERT_EQ_INT(DodaIndexStatus_OK, doda_index_select_op(&t, &iv, DodaOp_LTE, &key, cb_count, &via_idx));
+    DODA_ASSERT_EQ_INT(scan, via_idx);
+    DODA_ASSERT_EQ_INT(DodaIndexStatus_UNSUPPORTED, doda_index_select_op(&t, &iv, DodaOp_NE, &key, cb_count, &via_idx));
+}
+#endif
+
+#ifndef DRIVERSQL_NO_DOUBLE
+// Live rows matching op by direct cell compares (no zone maps involved)
+static size_t brute_count(const DodaTable *t, int col, Op op, const void *value) {
+    size_t n = 0;
+    for (size_t r = 0; r < t->count; ++r) if (!doda_is_deleted(t, r) && scan_cell_matches(&t->columns[col], r, op, value)) n++;
+    return n;
+}
+
+DODA_TEST(test_zone_maps_prune_without_changing_results) {
+    enum { ROWS = (int)MAX_ROWS * 4 };
+    const char *cols[] = {"id", "ts", "v"};
+    DodaColumnType types[] = {COL_INT, COL_INT, COL_DOUBLE};
+    static uint64_t arena[(ROWS * 32) / sizeof(uint64_t)];
+    DodaTable t;
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_table_init_arena(&t, "zones", 3, cols, types, arena, sizeof(arena), ROWS));
+    DODA_ASSERT(t.columns[0].zone != NULL && t.columns[2].zone != NULL);
+    for (int i = 0; i < ROWS; ++i) {
+        int ts = i * 10; double v = i == 100 ? 0.0 / 0.0 : (double)(i % 7) - 3.0;
+        const void *vals[] = {&i, &ts, &v};
+        DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_insert_row(&t, vals));
+    }
+    const double *zt = t.columns[1].zone;
+    DODA_ASSERT(zt[0] == 0.0 && zt[1] == 630.0);
+
+    const int ikeys[][2] = {{ROWS * 10 - 35, 0}, {55, 0}, {640, 700}, {1280, 1280}, {-5, -1}, {5, 5}};
+    const Op iops[] = {OP_GT, OP_LT, OP_BETWEEN, OP_EQ, OP_BETWEEN, OP_NE};
+    const double dkeys[][2] = {{0.0, 0.0}, {0.0, 0.0}, {2.5, 9.0}, {0.0 / 0.0, 0.0}};
+    const Op dops[] = {OP_NE, OP_EQ, OP_BETWEEN, OP_EQ};
+    for (int round = 0; round < 2; ++round) {
+        for (size_t k = 0; k < sizeof(iops) / sizeof(iops[0]); ++k) {
+            size_t got = 0;
+            DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_select_where_op(&t, "ts", (DodaOp)iops[k], ikeys[k], cb_count, &got));
+            DODA_ASSERT_EQ_INT(brute_count(&t, 1, iops[k], ikeys[k]), got);
+        }
+        for (size_t k = 0; k < sizeof(dops) / sizeof(dops[0]); ++k) {
+            size_t got = 0;
+            DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_select_where_op(&t, "v", (DodaOp)dops[k], dkeys[k], cb_count, &got));
+            DODA_ASSERT_EQ_INT(brute_count(&t, 2, dops[k], dkeys[k]), got);
+        }
+        AggResult r; DodaPredicate late = {"ts", OP_GTE, ikeys[0]};
+        DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_agg_column(&t, "id", &late, 1, &r));
+        DODA_ASSERT_EQ_INT(brute_count(&t, 1, OP_GTE, ikeys[0]), r.count);
+        if (round) break;
+
+        // Emptying block 2 resets its zone; a reused slot widens it again, even out of time order
+        size_t deleted = 0;
+        for (int i = 128; i < 192; ++i) doda_delete_where_eq(&t, "id", &i, &deleted);
+        DODA_ASSERT(zt[4] > zt[5]);
+        int id = ROWS, ts = 5; double v = 1.0; const void *vals[] = {&id, &ts, &v};
+        DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_insert_row(&t, vals));
+        DODA_ASSERT(zt[4] == 5.0 && zt[5] == 5.0);
+    }
+
+    doda_table_clear(&t);
+    DODA_ASSERT(zt[0] > zt[1]);
+}
+#endif
+
+// Bulk columnar insert: one copy per column, duplicates (against the table and inside the
+// batch) flagged and squeezed out, pk hash / zone maps / attached index current afterwards,
+// and the spill into recycled slots once the tail is used up
+DODA_TEST(test_insert_columns_flags_duplicates_and_fills_free_slots) {
+    const char *cols[] = {"id", "v", "flag"};
+    DodaColumnType types[] = {COL_INT, COL_INT, COL_BOOL};
+    static uint64_t arena[2048];
+    DodaTable t; DodaIndex idx; static uint32_t idx_rows[64];
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_table_init_arena(&t, "bulk", 3, cols, types, arena, sizeof(arena), 12));
+    int id5 = 5, v5 = 50, f5 = 1; const void *row5[] = {&id5, &v5, &f5};
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_insert_row(&t, row5));
+    DODA_ASSERT(doda_index_build_arena(&t, &idx, "v", idx_rows, 64));
+    DODA_ASSERT(doda_index_attach(&t, &idx));
+
+    int ids[] = {1, 2, 5, 3, 2, 4, 6, 7, 8, 9};
+    int vs[10]; uint8_t flags[10];
+    for (int i = 0; i < 10; ++i) { vs[i] = ids[i] * 10; flags[i] = (uint8_t)((ids[i] & 1) * 2); }
+    const void *arrays[] = {ids, vs, flags};
+    uint64_t failed = ~0ULL; size_t inserted = 0;
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_insert_columns(&t, 10, arrays, &failed, &inserted));
+    DODA_ASSERT_EQ_INT(8, inserted);
+    DODA_ASSERT((failed == ((1ULL << 2) | (1ULL << 4))));
+    DODA_ASSERT_EQ_INT(9, t.count);
+    const int order[] = {5, 1, 2, 3, 4, 6, 7, 8, 9};
+    for (int r = 0; r < 9; ++r) {
+        DODA_ASSERT_EQ_INT(order[r], t.columns[0].data.int_data[r]);
+        DODA_ASSERT_EQ_INT(order[r] * 10, t.columns[1].data.int_data[r]);
+        DODA_ASSERT_EQ_INT(order[r] & 1, t.columns[2].data.bool_data[r]);
+    }
+    size_t n = 0; int key = 7;
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_select_where_eq(&t, "id", &key, cb_count, &n));
+    DODA_ASSERT_EQ_INT(1, n);
+    int lo = 60; n = 0;
+    DODA_ASSERT_EQ_INT(DodaIndexStatus_OK, doda_index_select_op(&t, &idx, DodaOp_GTE, &lo, cb_count, &n));
+    DODA_ASSERT_EQ_INT(4, n);
+    DODA_ASSERT_EQ_INT(9, idx.size);
+    int hi = 85; Predicate p = {"v", OP_GT, &hi}; n = 0;
+    index_detach(&t, &idx);
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_select_where_all(&t, (const DodaPredicate *)&p, 1, cb_count, &n));
+    DODA_ASSERT_EQ_INT(1, n);
+    DODA_ASSERT(doda_table_block_dirty(&t, 0));
+
+    // 3 tail rows left and one recycled slot: the fifth row does not fit
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_delete_row(&t, 0));
+    int more[] = {20, 21, 22, 23, 24}; int mv[5] = {0}; uint8_t mf[5] = {0};
+    const void *more_arrays[] = {more, mv, mf};
+    DODA_ASSERT_EQ_INT(DodaStatus_ERR_FULL, doda_insert_columns(&t, 5, more_arrays, &failed, &inserted));
+    DODA_ASSERT_EQ_INT(4, inserted);
+    DODA_ASSERT(failed == (1ULL << 4));
+    DODA_ASSERT_EQ_INT(23, t.columns[0].data.int_data[0]);
+    key = 24; n = 0; doda_select_where_eq(&t, "id", &key, cb_count, &n);
+    DODA_ASSERT_EQ_INT(0, n);
+    DODA_ASSERT_EQ_INT(DodaStatus_ERR_INVALID, doda_insert_columns(&t, 1, NULL, NULL, NULL));
+
+    // Duplicates dropped from the tail block leave room for the rows after it
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_table_init_arena(&t, "bulk", 3, cols, types, arena, sizeof(arena), 10));
+    int ids12[] = {1, 2, 3, 4, 5, 6, 2, 7, 8, 9, 5, 10}; int v12[12] = {0}; uint8_t f12[12] = {0};
+    const void *arrays12[] = {ids12, v12, f12};
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_insert_columns(&t, 12, arrays12, &failed, &inserted));
+    DODA_ASSERT_EQ_INT(10, inserted);
+    DODA_ASSERT_EQ_INT(10, t.count);
+    DODA_ASSERT(failed == ((1ULL << 6) | (1ULL << 10)));
+    for (int r = 0; r < 10; ++r) DODA_ASSERT_EQ_INT(r + 1, t.columns[0].data.int_data[r]);
+    key = 10; n = 0; doda_select_where_eq(&t, "id", &key, cb_count, &n);
+    DODA_ASSERT_EQ_INT(1, n);
+}
+
 void doda_register_core_tests(void) {
     DODA_REGISTER(test_insert_and_select_eq_int);
     DODA_REGISTER(test_delete_where_eq_and_reuse_slot);
@@ -255,4 +942,23 @@ void doda_register_core_tests(void) {
     DODA_REGISTER(test_fuzz_insert_delete_consistency);
     DODA_REGISTER(test_index_eq_matches_full_scan);
     DODA_REGISTER(test_index_range_gte_matches_full_scan);
+    DODA_REGISTER(test_arena_table_beyond_max_rows);
+    DODA_REGISTER(test_duplicate_pk_does_not_consume_slot);
+    DODA_REGISTER(test_pk_hash_churn_lookups_and_probe_bound);
+    DODA_REGISTER(test_attached_index_maintained_on_insert_delete);
+#ifndef DRIVERSQL_NO_FLOAT
+    DODA_REGISTER(test_attached_float_index_signed_zeros_and_nan);
+#endif
+#if !defined(DRIVERSQL_NO_FLOAT) && !defined(DRIVERSQL_NO_DOUBLE) && !defined(DRIVERSQL_NO_TEXT)
+    DODA_REGISTER(test_index_build_radix_orders_all_types);
+#endif
+    DODA_REGISTER(test_scan_kernels_match_scalar_reference);
+    DODA_REGISTER(test_select_where_op_skips_deleted_rows);
+    DODA_REGISTER(test_select_into_chunks_match_callbacks);
+    DODA_REGISTER(test_select_where_all_conjunction);
+#ifndef DRIVERSQL_NO_DOUBLE
+    DODA_REGISTER(test_between_index_matches_scan);
+    DODA_REGISTER(test_zone_maps_prune_without_changing_results);
+#endif
+    DODA_REGISTER(test_insert_columns_flags_duplicates_and_fills_free_slots);
 }
@@ -1,7 +1,15 @@
 #include "test_framework.h"
 #include "doda_engine.h"
 #include "doda_persist.h"
+#include "doda_wal.h"
+#include "doda_agg.h"
+#include "doda_map.h"
+#include "doda_flash_log.h"
+#ifdef DODA_BUILD_FLASH_STUB
+#include "doda_storage_flash_stub.h"
+#endif
 
+#include <stdio.h>
 #include <string.h>
 
 typedef struct {
@@ -57,13 +65,13 @@ DODA_TEST(test_persist_roundtrip_memstore) {
 
     uint8_t buf[8192];
     MemStore ms = { buf, sizeof(buf), 0, true };
-    DodaStorage stw = { &ms, mem_write_all, NULL, mem_erase };
+    DodaStorage stw = DODA_STORAGE_INIT(&ms, mem_write_all, NULL, mem_erase);
 
     DodaPersistStatus ps = doda_persist_save_table(&t, &stw);
     DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, ps);
 
     mem_reset(&ms);
-    DodaStorage str = { &ms, NULL, mem_read_all, NULL };
+    DodaStorage str = DODA_STORAGE_INIT(&ms, NULL, mem_read_all, NULL);
     DodaTable loaded;
     DodaPersistStatus pl = doda_persist_load_table(&loaded, &str);
     DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, pl);
@@ -103,16 +111,16 @@ DODA_TEST(test_persist_crc_detects_corruption) {
 
     uint8_t buf[4096];
     MemStore ms = { buf, sizeof(buf), 0, true };
-    DodaStorage stw = { &ms, mem_write_all, NULL, mem_erase };
+    DodaStorage stw = DODA_STORAGE_INIT(&ms, mem_write_all, NULL, mem_erase);
     DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_persist_save_table(&t, &stw));
 
-    // Flip a byte in the payload region (after full header). The on-disk header is
-    // 30 bytes when CRC is enabled: 4 magic + 9*2 u16 fields + 4 payload_bytes + 4 crc32.
-    size_t flip = 30u + 8u;
+    // Flip a byte in the payload region (after the header). The on-disk header is
+    // 26 bytes: 4 magic + 9*2 u16 fields + 4 payload_bytes; the CRC32 is a trailer.
+    size_t flip = DODA_PERSIST_HEADER_BYTES + 8u;
     if (flip < sizeof(buf)) buf[flip] ^= 0x5A;
 
     mem_reset(&ms);
-    DodaStorage str = { &ms, NULL, mem_read_all, NULL };
+    DodaStorage str = DODA_STORAGE_INIT(&ms, NULL, mem_read_all, NULL);
     DodaTable loaded;
     DodaPersistStatus pl = doda_persist_load_table(&loaded, &str);
     DODA_ASSERT_EQ_INT(DODA_PERSIST_ERR_CORRUPT, pl);
@@ -136,7 +144,7 @@ DODA_TEST(test_persist_rejects_pointer_column) {
 
     uint8_t buf[1024];
     MemStore ms = { buf, sizeof(buf), 0, true };
-    DodaStorage stw = { &ms, mem_write_all, NULL, mem_erase };
+    DodaStorage stw = DODA_STORAGE_INIT(&ms, mem_write_all, NULL, mem_erase);
 
     DodaPersistStatus ps = doda_persist_save_table(&t, &stw);
     DODA_ASSERT_EQ_INT(DODA_PERSIST_ERR_UNSUPPORTED, ps);
@@ -175,7 +183,7 @@ DODA_TEST(test_persist_load_rejects_bad_magic) {
 
     MemStore ms = { buf, sizeof(buf), 0, false };
     mem_reset(&ms);
-    DodaStorage st = { &ms, NULL, mem_read_all, NULL };
+    DodaStorage st = DODA_STORAGE_INIT(&ms, NULL, mem_read_all, NULL);
     DodaTable out;
     DodaPersistStatus pl = doda_persist_load_table(&out, &st);
     DODA_ASSERT_EQ_INT(DODA_PERSIST_ERR_CORRUPT, pl);
@@ -213,12 +221,812 @@ DODA_TEST(test_persist_load_rejects_unsupported_version) {
 
     MemStore ms = { buf, sizeof(buf), 0, false };
     mem_reset(&ms);
-    DodaStorage st = { &ms, NULL, mem_read_all, NULL };
+    DodaStorage st = DODA_STORAGE_INIT(&ms, NULL, mem_read_all, NULL);
     DodaTable out;
     DodaPersistStatus pl = doda_persist_load_table(&out, &st);
     DODA_ASSERT_EQ_INT(DODA_PERSIST_ERR_UNSUPPORTED, pl);
 }
 
+// Sealed blocks are stored as encoded and opened in place on load
+DODA_TEST(test_persist_sealed_block_roundtrip) {
+    const char *cols[] = {"id", "time", "value"};
+    DodaColumnType types[] = {COL_INT, COL_INT, COL_INT};
+    DodaTable t;
+    doda_init_table(&t, "p", 3, cols, types);
+    for (int i = 0; i < 100; ++i) {
+        int tm = 5000 + i * 10, v = 20 + (i % 7);
+        const void *vals[] = {&i, &tm, &v};
+        DODA_ASSERT_EQ_INT(DS_OK, doda_insert_row(&t, vals));
+    }
+    uint8_t enc[2048], back[2048], medium[4096];
+    DodaSealedBlock b, loaded;
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_seal_where(&t, NULL, 0, "time", enc, sizeof(enc), &b));
+    DODA_ASSERT(b.bytes < 100u * 3u * 4u / 4u); // under a quarter of the raw INT payload
+
+    MemStore ms = { medium, sizeof(medium), 0, true };
+    DodaStorage stw = DODA_STORAGE_INIT(&ms, mem_write_all, NULL, mem_erase);
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_persist_save_block(&b, &stw));
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_BLOCK_HEADER_BYTES + b.bytes, ms.pos);
+
+    mem_reset(&ms);
+    DodaStorage str = DODA_STORAGE_INIT(&ms, NULL, mem_read_all, NULL);
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_persist_load_block(&loaded, back, sizeof(back), &str));
+    DODA_ASSERT_EQ_INT(100, loaded.rows);
+    int times[100];
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_sealed_decode_column(&loaded, doda_sealed_column_index(&loaded, "time"), times, 100));
+    DODA_ASSERT_EQ_INT(5990, times[99]);
+
+    mem_reset(&ms);
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_ERR_INVALID, doda_persist_load_block(&loaded, back, b.bytes - 1u, &str));
+#if DODA_PERSIST_HAS_CRC
+    medium[DODA_PERSIST_BLOCK_HEADER_BYTES + b.bytes - 1u] ^= 0x40u;
+    mem_reset(&ms);
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_ERR_CORRUPT, doda_persist_load_block(&loaded, back, sizeof(back), &str));
+#endif
+}
+
+// Counts write_all calls on a MemStore (one per WAL group commit)
+typedef struct { MemStore *m; size_t writes; } CountingStore;
+
+static bool counting_write_all(void *ctx, const void *data, size_t size) {
+    CountingStore *c = (CountingStore *)ctx;
+    c->writes++;
+    return mem_write_all(c->m, data, size);
+}
+
+static bool counting_read_all(void *ctx, void *data, size_t size) { return mem_read_all(((CountingStore *)ctx)->m, data, size); }
+static bool counting_erase(void *ctx) { return mem_erase(((CountingStore *)ctx)->m); }
+
+#if !defined(DRIVERSQL_NO_DOUBLE) && !defined(DRIVERSQL_NO_TEXT)
+DODA_TEST(test_wal_group_commit_and_replay) {
+    const char *cols[] = {"id", "time", "v", "tag"};
+    DodaColumnType types[] = {COL_INT, COL_INT, COL_DOUBLE, COL_TEXT};
+    DodaTable t, replayed;
+    doda_init_table(&t, "w", 4, cols, types);
+
+    uint8_t medium[4096], stage[1024];
+    MemStore ms = { medium, sizeof(medium), 0, true };
+    CountingStore cs = { &ms, 0 };
+    DodaStorage log = DODA_STORAGE_INIT(&cs, counting_write_all, counting_read_all, counting_erase);
+    DodaWalConfig cfg = { stage, sizeof(stage), 0, 8, 0, NULL, NULL };
+    DodaWal w;
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_wal_init(&w, &log, &cfg));
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_wal_reset(&w));
+    DODA_ASSERT(doda_wal_record_max_bytes(&t) <= sizeof(stage));
+
+    for (int i = 0; i < 20; ++i) {
+        int tm = 1000 + i; double v = i * 0.25; const char *tag = (i & 1) ? "odd" : "even";
+        const void *vals[] = {&i, &tm, &v, tag};
+        DODA_ASSERT_EQ_INT(DS_OK, doda_insert_row(&t, vals));
+        DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_wal_log_insert(&w, &t, vals));
+    }
+    const int gone[] = {3, 7};
+    for (int k = 0; k < 2; ++k) {
+        size_t deleted = 0;
+        DODA_ASSERT_EQ_INT(DS_OK, doda_delete_where_eq(&t, "id", &gone[k], &deleted));
+        DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_wal_log_delete(&w, gone[k]));
+    }
+    // 22 records in groups of 8: two commits so far, the last 6 still staged
+    DODA_ASSERT_EQ_INT(2, cs.writes);
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_wal_commit(&w));
+    DODA_ASSERT_EQ_INT(3, cs.writes);
+    DODA_ASSERT_EQ_INT(22, w.records);
+    // Records are proportional to the row: 3 + (4 + 4 + 8 + "even\0") + 4 bytes
+    DODA_ASSERT_EQ_INT(10u * 28u + 10u * 27u + 2u * 11u, ms.pos);
+
+    DodaWalReplayStats rs;
+    doda_init_table(&replayed, "w", 4, cols, types);
+    mem_reset(&ms);
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_wal_replay(&w, &replayed, &rs));
+    DODA_ASSERT_EQ_INT(22, rs.applied);
+    DODA_ASSERT(!rs.torn);
+    DODA_ASSERT_EQ_INT(18, agg_count(&replayed));
+    size_t cnt = 0; int needle = 5;
+    doda_select_where_eq(&replayed, "id", &needle, cb_find_id_eq_needle, &cnt);
+    DODA_ASSERT_EQ_INT(1, cnt);
+    DODA_ASSERT(replayed.columns[2].data.double_data[5] == 1.25);
+    DODA_ASSERT(strcmp(replayed.columns[3].data.text_data[5], "odd") == 0);
+
+    // Replaying over a table that already holds the records converges to the same rows
+    mem_reset(&ms);
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_wal_replay(&w, &replayed, &rs));
+    DODA_ASSERT_EQ_INT(18, agg_count(&replayed));
+    DODA_ASSERT(rs.skipped >= 18);
+
+    // A damaged last record ends the replay early
+    size_t end = 10u * 28u + 10u * 27u + 2u * 11u;
+    medium[end - 1u] ^= 0x01u;
+    doda_init_table(&replayed, "w", 4, cols, types);
+    mem_reset(&ms);
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_wal_replay(&w, &replayed, &rs));
+    DODA_ASSERT_EQ_INT(21, rs.applied);
+    DODA_ASSERT(rs.torn);
+    DODA_ASSERT_EQ_INT(19, agg_count(&replayed));
+}
+#endif
+
+static uint32_t g_fake_ms;
+static uint32_t fake_clock(void *user) { (void)user; return g_fake_ms; }
+
+DODA_TEST(test_wal_latency_commit_and_checkpoint) {
+    const char *cols[] = {"id", "value"};
+    DodaColumnType types[] = {COL_INT, COL_INT};
+    DodaTable t;
+    doda_init_table(&t, "w", 2, cols, types);
+
+    uint8_t medium[1024], snap_buf[4096], stage[128];
+    MemStore ms = { medium, sizeof(medium), 0, true }, snap_ms = { snap_buf, sizeof(snap_buf), 0, true };
+    CountingStore cs = { &ms, 0 };
+    DodaStorage log = DODA_STORAGE_INIT(&cs, counting_write_all, counting_read_all, counting_erase);
+    DodaStorage snap = DODA_STORAGE_INIT(&snap_ms, mem_write_all, mem_read_all, mem_erase);
+    DodaWalConfig cfg = { stage, sizeof(stage), 0, 0, 10, fake_clock, NULL };
+    DodaWal w;
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_wal_init(&w, &log, &cfg));
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_wal_reset(&w));
+    cfg.now_ms = NULL;
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_ERR_INVALID, doda_wal_init(&w, &log, &cfg));
+    cfg.now_ms = fake_clock;
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_wal_init(&w, &log, &cfg));
+
+    g_fake_ms = 100;
+    int id = 1, v = 10; const void *vals[] = {&id, &v};
+    DODA_ASSERT_EQ_INT(DS_OK, doda_insert_row(&t, vals));
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_wal_log_insert(&w, &t, vals));
+    g_fake_ms = 105;
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_wal_poll(&w));
+    DODA_ASSERT_EQ_INT(0, cs.writes);
+    g_fake_ms = 110;
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_wal_poll(&w));
+    DODA_ASSERT_EQ_INT(1, cs.writes);
+
+    // The group's age is checked on every append too
+    id = 2; g_fake_ms = 200;
+    DODA_ASSERT_EQ_INT(DS_OK, doda_insert_row(&t, vals));
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_wal_log_insert(&w, &t, vals));
+    id = 3; g_fake_ms = 215;
+    DODA_ASSERT_EQ_INT(DS_OK, doda_insert_row(&t, vals));
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_wal_log_insert(&w, &t, vals));
+    DODA_ASSERT_EQ_INT(2, cs.writes);
+
+    // Checkpoint: snapshot holds every row, the log starts over empty
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_wal_checkpoint(&w, &t, &snap));
+    DODA_ASSERT_EQ_INT(0, ms.pos);
+    DodaTable loaded; DodaWalReplayStats rs;
+    mem_reset(&snap_ms);
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_persist_load_table(&loaded, &snap));
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_wal_replay(&w, &loaded, &rs));
+    DODA_ASSERT_EQ_INT(0, rs.applied);
+    DODA_ASSERT(!rs.torn);
+    DODA_ASSERT_EQ_INT(3, agg_count(&loaded));
+}
+
+static bool row_live(const DodaTable *t, size_t r) { return r < t->count && !doda_is_deleted(t, r); }
+
+// Same live rows at the same row ids with the same INT cells
+static bool same_int_rows(const DodaTable *a, const DodaTable *b) {
+    size_t n = a->count > b->count ? a->count : b->count;
+    for (size_t r = 0; r < n; ++r) {
+        if (row_live(a, r) != row_live(b, r)) return false;
+        if (!row_live(a, r)) continue;
+        for (int c = 0; c < a->column_count; ++c) if (a->columns[c].data.int_data[r] != b->columns[c].data.int_data[r]) return false;
+    }
+    return true;
+}
+
+// Extended backends on a MemStore: gather writes, positional I/O (no cursor) and lent memory
+static bool counting_writev(void *ctx, const DodaIoVec *iov, size_t count) {
+    CountingStore *c = (CountingStore *)ctx;
+    c->writes++;
+    for (size_t i = 0; i < count; ++i) if (!mem_write_all(c->m, iov[i].data, iov[i].size)) return false;
+    return true;
+}
+
+static bool mem_write_at(void *ctx, uint64_t offset, const void *data, size_t size) {
+    MemStore *m = (MemStore *)ctx;
+    if (offset > m->cap || size > m->cap - offset) return false;
+    memcpy(m->buf + offset, data, size);
+    return true;
+}
+
+static bool mem_read_at(void *ctx, uint64_t offset, void *data, size_t size) {
+    MemStore *m = (MemStore *)ctx;
+    if (offset > m->cap || size > m->cap - offset) return false;
+    memcpy(data, m->buf + offset, size);
+    return true;
+}
+
+static void *mem_borrow(void *ctx, size_t size) {
+    MemStore *m = (MemStore *)ctx;
+    if (m->pos + size > m->cap) return NULL;
+    void *p = m->buf + m->pos;
+    m->pos += size;
+    return p;
+}
+
+DODA_TEST(test_persist_storage_extensions) {
+    const char *cols[] = {"id", "a", "b"};
+    DodaColumnType types[] = {COL_INT, COL_INT, COL_INT};
+    DodaTable t, loaded;
+    doda_init_table(&t, "x", 3, cols, types);
+    for (int i = 0; i < 200; ++i) {
+        int a = i * 3, b = -i;
+        const void *vals[] = {&i, &a, &b};
+        DODA_ASSERT_EQ_INT(DS_OK, doda_insert_row(&t, vals));
+    }
+    for (int id = 0; id < 200; id += 9) { size_t deleted = 0; DODA_ASSERT_EQ_INT(DS_OK, doda_delete_where_eq(&t, "id", &id, &deleted)); }
+
+    // Reference image through write_all
+    static uint8_t ref[4096], medium[4096];
+    MemStore rs = { ref, sizeof(ref), 0, true };
+    CountingStore rc = { &rs, 0 };
+    DodaStorage plain = DODA_STORAGE_INIT(&rc, counting_write_all, NULL, counting_erase);
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_persist_save_table(&t, &plain));
+    size_t bytes = rs.pos;
+
+    // writev: staged bytes and the column segment after them leave together, same image
+    MemStore ms = { medium, sizeof(medium), 0, true };
+    CountingStore vc = { &ms, 0 };
+    DodaStorage gather = { &vc, NULL, NULL, counting_erase, counting_writev, NULL, NULL, NULL, NULL };
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_persist_save_table(&t, &gather));
+    DODA_ASSERT_EQ_INT(bytes, ms.pos);
+    DODA_ASSERT(memcmp(ref, medium, bytes) == 0);
+    DODA_ASSERT(vc.writes < rc.writes);
+
+    // Positional only: the serializer keeps the offset; deltas need a cursor
+    memset(medium, 0, sizeof(medium));
+    DodaStorage positional = { &ms, NULL, NULL, NULL, NULL, mem_write_at, mem_read_at, NULL, NULL };
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_persist_save_table(&t, &positional));
+    DODA_ASSERT(memcmp(ref, medium, bytes) == 0);
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_persist_load_table(&loaded, &positional));
+    DODA_ASSERT(same_int_rows(&t, &loaded));
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_ERR_INVALID, doda_persist_save_delta(&t, &positional));
+
+    // Borrow: save encodes into the medium, load copies columns out of it
+    DodaStorage lend = { &ms, NULL, NULL, mem_erase, NULL, NULL, NULL, mem_borrow, NULL };
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_persist_save_table(&t, &lend));
+    DODA_ASSERT_EQ_INT(bytes, ms.pos);
+    DODA_ASSERT(memcmp(ref, medium, bytes) == 0);
+    mem_reset(&ms);
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_persist_load_table(&loaded, &lend));
+    DODA_ASSERT(same_int_rows(&t, &loaded));
+
+    // A lent sealed block is opened where it lies
+    uint8_t enc[2048];
+    DodaSealedBlock b, lb;
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_seal_where(&t, NULL, 0, "id", enc, sizeof(enc), &b));
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_persist_save_block(&b, &lend));
+    mem_reset(&ms);
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_persist_load_block(&lb, enc, 0, &lend));
+    DODA_ASSERT((const uint8_t *)lb.data == medium + DODA_PERSIST_BLOCK_HEADER_BYTES);
+    DODA_ASSERT_EQ_INT(b.rows, lb.rows);
+}
+
+DODA_TEST(test_persist_delta_snapshots) {
+    const char *cols[] = {"id", "value"};
+    DodaColumnType types[] = {COL_INT, COL_INT};
+    DodaTable t, loaded;
+    doda_init_table(&t, "d", 2, cols, types);
+    for (int i = 0; i < 200; ++i) {
+        int v = i * 3; const void *vals[] = {&i, &v};
+        DODA_ASSERT_EQ_INT(DS_OK, doda_insert_row(&t, vals));
+    }
+
+    uint8_t buf[8192];
+    memset(buf, 0xFF, sizeof(buf));
+    MemStore ms = { buf, sizeof(buf), 0, true };
+    DodaStorage st = DODA_STORAGE_INIT(&ms, mem_write_all, mem_read_all, mem_erase);
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_persist_save_table(&t, &st));
+    doda_table_clear_dirty(&t);
+    size_t base_end = ms.pos;
+
+    // Nothing changed: nothing written
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_persist_save_delta(&t, &st));
+    DODA_ASSERT_EQ_INT(base_end, ms.pos);
+
+    // Delete in block 0, reuse the slot, append a row in block 3: two blocks are written
+    size_t deleted = 0; int id = 10, v = 7;
+    const void *vals[] = {&id, &v};
+    DODA_ASSERT_EQ_INT(DS_OK, doda_delete_where_eq(&t, "id", &id, &deleted));
+    id = 1000;
+    DODA_ASSERT_EQ_INT(DS_OK, doda_insert_row(&t, vals));
+    id = 1001;
+    DODA_ASSERT_EQ_INT(DS_OK, doda_insert_row(&t, vals));
+    DODA_ASSERT(doda_table_block_dirty(&t, 0) && !doda_table_block_dirty(&t, 1) && doda_table_block_dirty(&t, 3));
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_persist_save_delta(&t, &st));
+    DODA_ASSERT(!doda_table_block_dirty(&t, 0));
+    size_t delta = 16u + 2u + 2u * 4u + 2u * 8u + (64u + 9u) * 8u + (DODA_PERSIST_HAS_CRC ? 4u : 0u);
+    DODA_ASSERT_EQ_INT(base_end + delta, ms.pos);
+
+    // A later delta deletes rows of block 1 and replaces a live row (same id, new value)
+    id = 70;
+    DODA_ASSERT_EQ_INT(DS_OK, doda_delete_where_eq(&t, "id", &id, &deleted));
+    id = 71;
+    DODA_ASSERT_EQ_INT(DS_OK, doda_delete_where_eq(&t, "id", &id, &deleted));
+    id = 5; v = -1;
+    DODA_ASSERT_EQ_INT(DS_OK, doda_delete_where_eq(&t, "id", &id, &deleted));
+    DODA_ASSERT_EQ_INT(DS_OK, doda_insert_row(&t, vals));
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_persist_save_delta(&t, &st));
+    size_t end = ms.pos;
+
+    mem_reset(&ms);
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_persist_load_table(&loaded, &st));
+    DODA_ASSERT(same_int_rows(&t, &loaded));
+    DODA_ASSERT_EQ_INT(agg_count(&t), agg_count(&loaded));
+    DODA_ASSERT(!doda_table_block_dirty(&loaded, 0));
+    size_t cnt = 0; int needle = 5;
+    doda_select_where_eq(&loaded, "id", &needle, cb_find_id_eq_needle, &cnt);
+    DODA_ASSERT_EQ_INT(1, cnt);
+
+    // The loaded table keeps taking inserts into its free slots
+    id = 2000;
+    DODA_ASSERT_EQ_INT(DS_OK, doda_insert_row(&loaded, vals));
+    DODA_ASSERT_EQ_INT(DS_OK, doda_insert_row(&t, vals));
+    DODA_ASSERT_EQ_INT(agg_count(&t), agg_count(&loaded));
+
+#if DODA_PERSIST_HAS_CRC
+    // A torn last delta is reported
+    buf[end - 1u] ^= 0x01u;
+    mem_reset(&ms);
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_ERR_CORRUPT, doda_persist_load_table(&loaded, &st));
+#else
+    (void)end;
+#endif
+
+    // An arena table larger than MAX_ROWS: no delta past it, and the blocks a clear leaves
+    // dirty up there are not written
+    static uint64_t arena[(2 * MAX_ROWS) * 3];
+    DodaTable wide;
+    DODA_ASSERT(doda_table_arena_bytes(2, types, 2 * MAX_ROWS) <= sizeof(arena));
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_table_init_arena(&wide, "wide", 2, cols, types, arena, sizeof(arena), 2 * MAX_ROWS));
+    for (int i = 0; i < 10; ++i) { const void *wv[] = {&i, &i}; DODA_ASSERT_EQ_INT(DS_OK, doda_insert_row(&wide, wv)); }
+    memset(buf, 0xFF, sizeof(buf));
+    mem_reset(&ms);
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_persist_save_table(&wide, &st));
+    doda_table_clear_dirty(&wide);
+    for (int i = 10; i <= (int)MAX_ROWS; ++i) { const void *wv[] = {&i, &i}; DODA_ASSERT_EQ_INT(DS_OK, doda_insert_row(&wide, wv)); }
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_ERR_UNSUPPORTED, doda_persist_save_delta(&wide, &st));
+    doda_table_clear(&wide);
+    for (int i = 0; i < 5; ++i) { const void *wv[] = {&i, &i}; DODA_ASSERT_EQ_INT(DS_OK, doda_insert_row(&wide, wv)); }
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_persist_save_delta(&wide, &st));
+    mem_reset(&ms);
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_persist_load_table(&loaded, &st));
+    DODA_ASSERT_EQ_INT(5, agg_count(&loaded));
+    DODA_ASSERT(same_int_rows(&wide, &loaded));
+}
+
+// One pass through the staging buffer: small pieces are staged, column segments are written
+// straight from the column arrays, and any buffer size loads it back
+DODA_TEST(test_persist_staged_single_pass) {
+    const char *cols[] = {"id", "value"};
+    DodaColumnType types[] = {COL_INT, COL_INT};
+    DodaTable t, loaded;
+    doda_init_table(&t, "s", 2, cols, types);
+    for (int i = 0; i < 200; ++i) {
+        int v = i * 7; const void *vals[] = {&i, &v};
+        DODA_ASSERT_EQ_INT(DS_OK, doda_insert_row(&t, vals));
+    }
+    size_t deleted = 0; int gone = 3;
+    DODA_ASSERT_EQ_INT(DS_OK, doda_delete_where_eq(&t, "id", &gone, &deleted));
+
+    uint8_t medium[4096], stage[512], tiny[7];
+    MemStore ms = { medium, sizeof(medium), 0, true };
+    CountingStore cs = { &ms, 0 };
+    DodaStorage st = DODA_STORAGE_INIT(&cs, counting_write_all, counting_read_all, counting_erase);
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_persist_save_table_staged(&t, &st, stage, sizeof(stage)));
+    size_t total = DODA_PERSIST_HEADER_BYTES + 2u * (MAX_NAME_LEN + 1u) + 4u * 8u + 200u * 8u + (DODA_PERSIST_HAS_CRC ? 4u : 0u);
+    DODA_ASSERT_EQ_INT(total, ms.pos);
+    // header + schema + bitmap | column "id" | column "value" | CRC trailer
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_HAS_CRC ? 4 : 3, cs.writes);
+    DODA_ASSERT(total <= doda_persist_estimate_max_bytes(&t));
+
+    mem_reset(&ms);
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_persist_load_table_staged(&loaded, &st, tiny, sizeof(tiny)));
+    DODA_ASSERT(same_int_rows(&t, &loaded));
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_ERR_INVALID, doda_persist_save_table_staged(&t, &st, stage, 0));
+}
+
+// Files written before the CRC moved to a trailer (v1: padded header, CRC at offset 26) still load
+DODA_TEST(test_persist_loads_v1_files) {
+    uint8_t img[128];
+    memset(img, 0xFF, sizeof(img));
+    const size_t hdr = DODA_PERSIST_HAS_CRC ? 32u : 28u;
+    const size_t schema = MAX_NAME_LEN + 1u;
+    memset(img, 0, hdr + schema);
+    wr_u32_le(&img[0], 0x41444F44u);
+    wr_u16_le(&img[4], 1u);
+    wr_u16_le(&img[6], (uint16_t)hdr);
+    wr_u16_le(&img[8], 1);
+    wr_u16_le(&img[10], 2);
+    wr_u16_le(&img[12], (uint16_t)MAX_ROWS);
+    wr_u16_le(&img[14], (uint16_t)MAX_COLUMNS);
+    wr_u16_le(&img[16], (uint16_t)MAX_NAME_LEN);
+#ifndef DRIVERSQL_NO_TEXT
+    wr_u16_le(&img[18], (uint16_t)MAX_TEXT_LEN);
+#endif
+    wr_u16_le(&img[20], (uint16_t)HASH_SIZE);
+    wr_u32_le(&img[22], (uint32_t)(schema + 2u * (2u + 4u)));
+    uint8_t *p = &img[hdr];
+    memcpy(p, "id", 2); p[MAX_NAME_LEN] = (uint8_t)COL_INT; p += schema;
+    wr_u16_le(p, 1); wr_u16_le(p + 2, 4); p += 4;
+    wr_u32_le(p, 41u); wr_u32_le(p + 4, 42u); p += 8;
+#if DODA_PERSIST_HAS_CRC
+    wr_u32_le(&img[26], doda_persist_crc32(0u, &img[hdr], (size_t)(p - &img[hdr])));
+#endif
+
+    MemStore ms = { img, sizeof(img), 0, false };
+    DodaStorage st = DODA_STORAGE_INIT(&ms, NULL, mem_read_all, NULL);
+    DodaTable out;
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_persist_load_table(&out, &st));
+    DODA_ASSERT_EQ_INT(5, out.count);
+    DODA_ASSERT_EQ_INT(2, agg_count(&out));
+    DODA_ASSERT_EQ_INT(42, out.columns[0].data.int_data[4]);
+    DODA_ASSERT(doda_is_deleted(&out, 0) && !doda_is_deleted(&out, 1));
+}
+
+static uint32_t crc32_bitwise_ref(uint32_t crc, const uint8_t *p, size_t len) {
+    crc = ~crc;
+    for (size_t i = 0; i < len; ++i) {
+        crc ^= p[i];
+        for (int b = 0; b < 8; ++b) crc = (crc >> 1) ^ (0xEDB88320u & -(crc & 1u));
+    }
+    return ~crc;
+}
+
+// Whatever implementation is built (tables, PCLMULQDQ, ARMv8) gives the IEEE values files carry
+DODA_TEST(test_persist_crc32_matches_reference) {
+    DODA_ASSERT_EQ_INT(0xCBF43926u, doda_persist_crc32(0u, "123456789", 9));
+    uint8_t buf[600];
+    uint32_t rng = 0x1234567u;
+    for (size_t i = 0; i < sizeof(buf); ++i) { rng = rng * 1103515245u + 12345u; buf[i] = (uint8_t)(rng >> 16); }
+    for (size_t off = 0; off < 8u; ++off) {
+        for (size_t len = 0; len + off <= sizeof(buf); len += (len < 160u ? 1u : 37u)) {
+            uint32_t ref = crc32_bitwise_ref(0u, buf + off, len);
+            if (doda_persist_crc32(0u, buf + off, len) != ref) { DODA_ASSERT(false); return; }
+            size_t cut = len / 3u;
+            if (doda_persist_crc32(doda_persist_crc32(0u, buf + off, cut), buf + off + cut, len - cut) != ref) { DODA_ASSERT(false); return; }
+        }
+    }
+}
+
+#if !defined(DRIVERSQL_NO_DOUBLE) && !defined(DRIVERSQL_NO_TEXT)
+static size_t g_read_calls;
+static bool counted_read_all(void *ctx, void *data, size_t size) { g_read_calls++; return mem_read_all(ctx, data, size); }
+
+// Columnar image: every column comes back in one read, with pk hash, zones and free slots rebuilt
+DODA_TEST(test_persist_columnar_bulk_load) {
+    const char *cols[] = {"id", "v", "ok", "tag"};
+    DodaColumnType types[] = {COL_INT, COL_DOUBLE, COL_BOOL, COL_TEXT};
+    DodaTable t, loaded;
+    doda_init_table(&t, "c", 4, cols, types);
+    for (int i = 0; i < 150; ++i) {
+        double v = i * 0.5; int ok = i & 1; const char *tag = (i % 3) ? "x" : "three";
+        const void *vals[] = {&i, &v, &ok, tag};
+        DODA_ASSERT_EQ_INT(DS_OK, doda_insert_row(&t, vals));
+    }
+    for (int id = 0; id < 150; id += 10) { size_t deleted = 0; DODA_ASSERT_EQ_INT(DS_OK, doda_delete_where_eq(&t, "id", &id, &deleted)); }
+
+    static uint8_t medium[16384];
+    uint8_t stage[256];
+    MemStore ms = { medium, sizeof(medium), 0, true };
+    DodaStorage st = DODA_STORAGE_INIT(&ms, mem_write_all, counted_read_all, mem_erase);
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_persist_save_table_staged(&t, &st, stage, sizeof(stage)));
+    mem_reset(&ms); g_read_calls = 0;
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_persist_load_table_staged(&loaded, &st, stage, sizeof(stage)));
+    // header, schema (+bitmap) in buffer-sized reads, one read per column segment, trailer, probe for a delta
+    DODA_ASSERT(g_read_calls <= 12u);
+
+    DODA_ASSERT_EQ_INT(150, loaded.count);
+    DODA_ASSERT_EQ_INT(135, agg_count(&loaded));
+    DODA_ASSERT(doda_is_deleted(&loaded, 20) && !doda_is_deleted(&loaded, 21));
+    DODA_ASSERT(loaded.columns[1].data.double_data[21] == 10.5);
+    DODA_ASSERT(strcmp(loaded.columns[3].data.text_data[21], "three") == 0);
+    DODA_ASSERT_EQ_INT(1, loaded.columns[2].data.bool_data[21]);
+
+    // Primary key and zone maps work on the bulk-loaded table; a duplicate key is refused
+    size_t cnt = 0; int needle = 5;
+    doda_select_where_eq(&loaded, "id", &needle, cb_find_id_eq_needle, &cnt);
+    DODA_ASSERT_EQ_INT(1, cnt);
+    double lim = 70.0;
+    Predicate big[] = {{"v", OP_GT, &lim}};
+    AggResult a, b;
+    DODA_ASSERT_EQ_INT(DS_OK, agg_columns(&t, (const char *[]){"v"}, 1, big, 1, &a));
+    DODA_ASSERT_EQ_INT(DS_OK, agg_columns(&loaded, (const char *[]){"v"}, 1, big, 1, &b));
+    DODA_ASSERT_EQ_INT(a.count, b.count);
+    int dup = 21; double v = 0; int ok = 0;
+    const void *vals[] = {&dup, &v, &ok, "d"};
+    DODA_ASSERT_EQ_INT(DS_ERR_UNSUPPORTED, doda_insert_row(&loaded, vals));
+
+    int fresh = 1000;
+    vals[0] = &fresh;
+    DODA_ASSERT_EQ_INT(DS_OK, doda_insert_row(&loaded, vals));
+    DODA_ASSERT_EQ_INT(136, agg_count(&loaded));
+
+    // An arena table past MAX_ROWS could not be loaded back, so it is not saved
+    const char *wide_cols[] = {"id"};
+    DodaColumnType wide_types[] = {COL_INT};
+    static uint64_t arena[(MAX_ROWS + 1) * 4];
+    DodaTable wide;
+    DODA_ASSERT(doda_table_arena_bytes(1, wide_types, MAX_ROWS + 1) <= sizeof(arena));
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_table_init_arena(&wide, "wide", 1, wide_cols, wide_types, arena, sizeof(arena), MAX_ROWS + 1));
+    for (int i = 0; i <= (int)MAX_ROWS; ++i) { const void *bv[] = {&i}; DODA_ASSERT_EQ_INT(DS_OK, doda_insert_row(&wide, bv)); }
+    mem_reset(&ms);
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_ERR_UNSUPPORTED, doda_persist_save_table_staged(&wide, &st, stage, sizeof(stage)));
+}
+#endif
+
+#ifndef DRIVERSQL_NO_DOUBLE
+static void cb_count_rows(const DodaTable *tab, size_t row, void *user) { (void)tab; (void)row; (*(size_t *)user)++; }
+
+// Mapped image: the view answers pk, index, predicate and aggregate queries from the image bytes
+DODA_TEST(test_persist_mapped_image) {
+    const char *cols[] = {"id", "v"};
+    DodaColumnType types[] = {COL_INT, COL_DOUBLE};
+    DodaTable t;
+    DodaIndex by_v;
+    doda_init_table(&t, "m", 2, cols, types);
+    for (int i = 0; i < 200; ++i) {
+        double v = (i * 37) % 200;
+        const void *vals[] = {&i, &v};
+        DODA_ASSERT_EQ_INT(DS_OK, doda_insert_row(&t, vals));
+    }
+    for (int id = 0; id < 200; id += 7) { size_t deleted = 0; DODA_ASSERT_EQ_INT(DS_OK, doda_delete_where_eq(&t, "id", &id, &deleted)); }
+    DODA_ASSERT(doda_index_build(&t, &by_v, "v"));
+
+    static uint64_t image[16384];
+    const DodaIndex *idx[] = {&by_v};
+    size_t bytes = doda_image_bytes(&t, idx, 1);
+    DODA_ASSERT(bytes > 0 && bytes <= sizeof(image));
+    MemStore ms = { (uint8_t *)image, sizeof(image), 0, true };
+    DodaStorage st = DODA_STORAGE_INIT(&ms, mem_write_all, mem_read_all, mem_erase);
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_persist_save_image(&t, idx, 1, &st));
+    DODA_ASSERT_EQ_INT(bytes, ms.pos);
+
+    DodaTableMap m;
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_table_map_memory(&m, image, bytes, true));
+    DODA_ASSERT_EQ_INT(200, m.table.count);
+    DODA_ASSERT_EQ_INT(agg_count(&t), agg_count(&m.table));
+    DODA_ASSERT((const uint8_t *)m.table.columns[1].data.double_data >= m.image);
+    DODA_ASSERT(((uintptr_t)m.table.columns[1].data.double_data - (uintptr_t)m.image) % DODA_IMAGE_PAGE == 0);
+
+    size_t cnt = 0; int needle = 5;
+    doda_select_where_eq(&m.table, "id", &needle, cb_find_id_eq_needle, &cnt);
+    DODA_ASSERT_EQ_INT(1, cnt);
+    int gone = 14;
+    cnt = 0; doda_select_where_eq(&m.table, "id", &gone, cb_find_id_eq_needle, &cnt);
+    DODA_ASSERT_EQ_INT(0, cnt);
+
+    size_t n_orig = 0, n_map = 0; double lim = 150.0;
+    DODA_ASSERT_EQ_INT(IDX_OK, doda_index_select_op(&t, &by_v, DodaOp_GTE, &lim, (doda_row_callback)cb_count_rows, &n_orig));
+    DODA_ASSERT_EQ_INT(IDX_OK, doda_index_select_op(&m.table, &m.indexes[0], DodaOp_GTE, &lim, (doda_row_callback)cb_count_rows, &n_map));
+    DODA_ASSERT(n_orig > 0);
+    DODA_ASSERT_EQ_INT(n_orig, n_map);
+
+    Predicate big[] = {{"v", OP_GT, &lim}};
+    AggResult a, b;
+    DODA_ASSERT_EQ_INT(DS_OK, agg_columns(&t, (const char *[]){"v"}, 1, big, 1, &a));
+    DODA_ASSERT_EQ_INT(DS_OK, agg_columns(&m.table, (const char *[]){"v"}, 1, big, 1, &b));
+    DODA_ASSERT_EQ_INT(a.count, b.count);
+    DODA_ASSERT(a.sum == b.sum);
+
+    // A flipped data byte fails verification; a damaged header always fails
+    uint8_t *raw = (uint8_t *)image;
+    raw[bytes - 64] ^= 0x01;
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_ERR_CORRUPT, doda_table_map_memory(&m, image, bytes, true));
+    raw[bytes - 64] ^= 0x01;
+    raw[8 * 9] ^= 0x01;
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_ERR_CORRUPT, doda_table_map_memory(&m, image, bytes, false));
+    raw[8 * 9] ^= 0x01;
+
+#if defined(__unix__) || defined(__APPLE__)
+    const char *path = "doda_map_test.img";
+    FILE *f = fopen(path, "wb");
+    DODA_ASSERT(f != NULL);
+    DODA_ASSERT_EQ_INT(bytes, fwrite(image, 1, bytes, f));
+    fclose(f);
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_table_map(&m, path, true));
+    DODA_ASSERT(m.mapped);
+    cnt = 0; doda_select_where_eq(&m.table, "id", &needle, cb_find_id_eq_needle, &cnt);
+    DODA_ASSERT_EQ_INT(1, cnt);
+    doda_table_unmap(&m);
+    remove(path);
+#endif
+}
+#endif
+
+#ifdef DODA_BUILD_FLASH_STUB
+// RAM flash for the A/B slots; programming stops after g_ab_budget bytes (a power cut)
+static uint8_t g_ab_flash[8192];
+static size_t g_ab_budget = SIZE_MAX;
+
+static bool ab_erase(uintptr_t base, size_t size) { memset(&g_ab_flash[base], 0xFF, size); return true; }
+static bool ab_read(uintptr_t addr, void *data, size_t size) { memcpy(data, &g_ab_flash[addr], size); return true; }
+static bool ab_program(uintptr_t addr, const void *data, size_t size) {
+    size_t n = size < g_ab_budget ? size : g_ab_budget;
+    memcpy(&g_ab_flash[addr], data, n);
+    if (g_ab_budget != SIZE_MAX) g_ab_budget -= n;
+    return n == size;
+}
+
+static void ab_insert(DodaTable *t, int id) {
+    int tm = id * 10, v = id * 7;
+    const void *vals[] = {&id, &tm, &v};
+    (void)doda_insert_row(t, vals);
+}
+
+DODA_TEST(test_flash_ab_snapshot_survives_power_cut) {
+    const char *cols[] = {"id", "time", "value"};
+    DodaColumnType types[] = {COL_INT, COL_INT, COL_INT};
+    DodaTable t, loaded;
+    doda_init_table(&t, "ab", 3, cols, types);
+    DodaFlashStorageCtx fctx = { 0, sizeof(g_ab_flash), 0, ab_erase, ab_program, ab_read, NULL };
+    DodaFlashAB ab;
+    memset(g_ab_flash, 0xFF, sizeof(g_ab_flash));
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_flash_ab_open(&ab, &fctx));
+    DODA_ASSERT_EQ_INT(-1, ab.active);
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_ERR_IO, doda_flash_ab_load_table(&ab, &loaded));
+
+    ab_insert(&t, 1);
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_flash_ab_save_table(&ab, &t));
+    ab_insert(&t, 2);
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_flash_ab_save_table(&ab, &t));
+    DODA_ASSERT_EQ_INT(1, ab.active);
+    DODA_ASSERT_EQ_INT(2, ab.generation[1]);
+
+    // Cut power mid-snapshot, then right before the commit record: generation 2 still loads
+    ab_insert(&t, 3);
+    size_t cuts[] = { 40, ab.bytes[1] };
+    for (size_t i = 0; i < 2; ++i) {
+        DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_flash_ab_open(&ab, &fctx));
+        g_ab_budget = cuts[i];
+        DODA_ASSERT(doda_flash_ab_save_table(&ab, &t) != DODA_PERSIST_OK);
+        g_ab_budget = SIZE_MAX;
+        DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_flash_ab_open(&ab, &fctx));
+        DODA_ASSERT_EQ_INT(1, ab.active);
+        DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_flash_ab_load_table(&ab, &loaded));
+        DODA_ASSERT_EQ_INT(2, agg_count(&loaded));
+    }
+
+    // A prepared (pre-erased) slot is used as is; the new generation wins after reopening
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_flash_ab_prepare(&ab));
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_flash_ab_save_table(&ab, &t));
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_flash_ab_open(&ab, &fctx));
+    DODA_ASSERT_EQ_INT(0, ab.active);
+    DODA_ASSERT_EQ_INT(3, ab.generation[0]);
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_flash_ab_load_table(&ab, &loaded));
+    DODA_ASSERT(same_int_rows(&t, &loaded));
+
+#if DODA_PERSIST_HAS_CRC
+    // A committed snapshot that no longer loads falls back to the older slot
+    g_ab_flash[DODA_FLASH_AB_RECORD_BYTES + 60] ^= 0x10u;
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_flash_ab_load_table(&ab, &loaded));
+    DODA_ASSERT_EQ_INT(1, ab.active);
+    DODA_ASSERT_EQ_INT(2, agg_count(&loaded));
+#endif
+}
+#endif
+
+// RAM NOR flash for the log store: programs only erased bytes, stops after g_nor_budget bytes
+#define NOR_PAGE 128u
+#define NOR_BLOCK 1024u
+#define NOR_BLOCKS 8u
+static uint8_t g_nor[NOR_BLOCK * NOR_BLOCKS];
+static size_t g_nor_budget = SIZE_MAX;
+
+static bool nor_erase(void *user, uintptr_t addr, size_t size) { (void)user; memset(&g_nor[addr], 0xFF, size); return true; }
+static bool nor_read(void *user, uintptr_t addr, void *data, size_t size) { (void)user; memcpy(data, &g_nor[addr], size); return true; }
+static bool nor_program(void *user, uintptr_t addr, const void *data, size_t size) {
+    (void)user;
+    for (size_t i = 0; i < size; ++i) if (g_nor[addr + i] != 0xFFu) return false;
+    size_t n = size < g_nor_budget ? size : g_nor_budget;
+    memcpy(&g_nor[addr], data, n);
+    if (g_nor_budget != SIZE_MAX) g_nor_budget -= n;
+    return n == size;
+}
+
+static DodaFlashLogPage g_nor_pages[NOR_BLOCKS * NOR_BLOCK / NOR_PAGE];
+static uint32_t g_nor_counts[NOR_BLOCKS];
+static uint8_t g_nor_work[2 * NOR_PAGE];
+static const DodaFlashLogConfig g_nor_cfg = { NULL, 0, NOR_PAGE, NOR_BLOCK, NOR_BLOCKS, 0, nor_erase, nor_program, nor_read, g_nor_pages, g_nor_counts, g_nor_work };
+
+DODA_TEST(test_flash_log_wear_leveled_snapshots) {
+    const char *cols[] = {"id", "time", "value"};
+    DodaColumnType types[] = {COL_INT, COL_INT, COL_INT};
+    DodaTable t, loaded;
+    doda_init_table(&t, "nor", 3, cols, types);
+    for (int i = 0; i < 40; ++i) {
+        int tm = i * 10, v = i;
+        const void *vals[] = {&i, &tm, &v};
+        DODA_ASSERT_EQ_INT(DS_OK, doda_insert_row(&t, vals));
+    }
+    memset(g_nor, 0xFF, sizeof(g_nor));
+    DodaFlashLog log;
+    DodaStorage snap;
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_flash_log_mount(&log, &g_nor_cfg));
+    doda_flash_log_storage(&log, 0, &snap);
+    DODA_ASSERT(!snap.read_all(snap.ctx, &loaded, 1)); // nothing committed yet
+
+    // Many saves cycle through every block; erases stay even and far below one per save
+    for (int gen = 0; gen < 120; ++gen) {
+        t.columns[2].data.int_data[gen % 40] = gen; // row id == key
+        DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_persist_save_table(&t, &snap));
+        if (gen % 30 == 29) {
+            DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_flash_log_mount(&log, &g_nor_cfg));
+            doda_flash_log_storage(&log, 0, &snap);
+            DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_persist_load_table(&loaded, &snap));
+            DODA_ASSERT(same_int_rows(&t, &loaded));
+        }
+    }
+    DodaFlashLogStats fs;
+    doda_flash_log_stats(&log, &fs);
+    uint32_t erases = 0;
+    for (size_t b = 0; b < NOR_BLOCKS; ++b) erases += g_nor_counts[b];
+    DODA_ASSERT(erases > NOR_BLOCKS && erases < 120u);
+    DODA_ASSERT(fs.erase_min > 0 && fs.erase_max - fs.erase_min <= 2u);
+
+    // A save cut short is never seen: the last committed snapshot loads after remount
+    int committed = t.columns[2].data.int_data[0];
+    t.columns[2].data.int_data[0] = -1;
+    g_nor_budget = 3u * NOR_PAGE + 17u;
+    DODA_ASSERT(doda_persist_save_table(&t, &snap) != DODA_PERSIST_OK);
+    g_nor_budget = SIZE_MAX;
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_flash_log_mount(&log, &g_nor_cfg));
+    doda_flash_log_storage(&log, 0, &snap);
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_persist_load_table(&loaded, &snap));
+    DODA_ASSERT_EQ_INT(committed, loaded.columns[2].data.int_data[0]);
+    t.columns[2].data.int_data[0] = committed;
+    DODA_ASSERT(same_int_rows(&t, &loaded));
+
+    // A WAL on a second stream: groups are commit points, reset starts an empty log
+    DodaStorage wal_st;
+    doda_flash_log_storage(&log, 1, &wal_st);
+    uint8_t stage[64];
+    DodaWalConfig wcfg = { stage, sizeof(stage), 0, 4, 0, NULL, NULL };
+    DodaWal w;
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_wal_init(&w, &wal_st, &wcfg));
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_wal_reset(&w));
+    for (int i = 40; i < 50; ++i) {
+        int tm = i * 10;
+        const void *vals[] = {&i, &tm, &i};
+        DODA_ASSERT_EQ_INT(DS_OK, doda_insert_row(&t, vals));
+        DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_wal_log_insert(&w, &t, vals));
+    }
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_wal_commit(&w));
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_flash_log_mount(&log, &g_nor_cfg));
+    doda_flash_log_storage(&log, 0, &snap);
+    doda_flash_log_storage(&log, 1, &wal_st);
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_persist_load_table(&loaded, &snap));
+    DodaWalReplayStats rs;
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_wal_replay(&w, &loaded, &rs));
+    DODA_ASSERT_EQ_INT(10, rs.applied);
+    DODA_ASSERT_EQ_INT(50, agg_count(&loaded));
+
+    // Background collection tops up erased blocks without losing either stream
+    DODA_ASSERT(doda_flash_log_gc(&log, NOR_BLOCKS) > 0);
+    doda_flash_log_rewind(&log, 0);
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_persist_load_table(&loaded, &snap));
+    DODA_ASSERT_EQ_INT(40, agg_count(&loaded));
+    DODA_ASSERT_EQ_INT(committed, loaded.columns[2].data.int_data[0]);
+
+    // An append torn before its commit must not shadow the next committed append
+    DodaStorage raw;
+    uint8_t a[40], b[2 * NOR_PAGE], c[40], back[2 * sizeof(a)];
+    memset(a, 'A', sizeof(a)); memset(b, 'B', sizeof(b)); memset(c, 'C', sizeof(c));
+    doda_flash_log_storage(&log, 2, &raw);
+    DODA_ASSERT(raw.erase(raw.ctx) && raw.write_all(raw.ctx, a, sizeof(a)) && raw.sync(raw.ctx));
+    DODA_ASSERT(raw.write_all(raw.ctx, b, sizeof(b))); // whole pages programmed, no sync
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_flash_log_mount(&log, &g_nor_cfg));
+    doda_flash_log_storage(&log, 2, &raw);
+    DODA_ASSERT(raw.write_all(raw.ctx, c, sizeof(c)) && raw.sync(raw.ctx));
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_flash_log_mount(&log, &g_nor_cfg));
+    doda_flash_log_storage(&log, 2, &raw);
+    DODA_ASSERT(raw.read_all(raw.ctx, back, sizeof(back)));
+    DODA_ASSERT(memcmp(back, a, sizeof(a)) == 0 && memcmp(back + sizeof(a), c, sizeof(c)) == 0);
+    DODA_ASSERT(!raw.read_all(raw.ctx, back, 1));
+    doda_flash_log_storage(&log, 0, &snap);
+    DODA_ASSERT_EQ_INT(DODA_PERSIST_OK, doda_persist_load_table(&loaded, &snap));
+    DODA_ASSERT_EQ_INT(committed, loaded.columns[2].data.int_data[0]);
+}
+
 void doda_register_persist_tests(void) {
     DODA_REGISTER(test_persist_roundtrip_memstore);
 #if DODA_PERSIST_HAS_CRC
@@ -229,4 +1037,24 @@ void doda_register_persist_tests(void) {
 #endif
     DODA_REGISTER(test_persist_load_rejects_bad_magic);
     DODA_REGISTER(test_persist_load_rejects_unsupported_version);
+    DODA_REGISTER(test_persist_sealed_block_roundtrip);
+#if !defined(DRIVERSQL_NO_DOUBLE) && !defined(DRIVERSQL_NO_TEXT)
+    DODA_REGISTER(test_wal_group_commit_and_replay);
+#endif
+    DODA_REGISTER(test_wal_latency_commit_and_checkpoint);
+    DODA_REGISTER(test_persist_delta_snapshots);
+    DODA_REGISTER(test_persist_storage_extensions);
+    DODA_REGISTER(test_flash_log_wear_leveled_snapshots);
+    DODA_REGISTER(test_persist_staged_single_pass);
+    DODA_REGISTER(test_persist_loads_v1_files);
+    DODA_REGISTER(test_persist_crc32_matches_reference);
+#if !defined(DRIVERSQL_NO_DOUBLE) && !defined(DRIVERSQL_NO_TEXT)
+    DODA_REGISTER(test_persist_columnar_bulk_load);
+#endif
+#ifndef DRIVERSQL_NO_DOUBLE
+    DODA_REGISTER(test_persist_mapped_image);
+#endif
+#ifdef DODA_BUILD_FLASH_STUB
+    DODA_REGISTER(test_flash_ab_snapshot_survives_power_cut);
+#endif
 }
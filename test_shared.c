@@ -0,0 +1,156 @@
+#include "test_framework.h"
+#include "doda_shared.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef DRIVERSQL_THREADS
+#include <pthread.h>
+
+static void *shared_table(Table *t, size_t rows) {
+    const char *cols[] = {"id", "v"};
+    ColumnType types[] = {COL_INT, COL_INT};
+    size_t need = table_arena_bytes(2, types, rows);
+    void *arena = malloc(need);
+    if (arena && init_table_arena(t, "shared", 2, cols, types, arena, need, rows) != DS_OK) { free(arena); return NULL; }
+    return arena;
+}
+
+static void count_row(const Table *t, size_t row, void *user) { (void)t; (void)row; (*(size_t *)user)++; }
+
+DODA_TEST(test_shared_reads_match_plain_queries) {
+    Table *t = (Table *)malloc(sizeof(Table));
+    void *arena = t ? shared_table(t, 512u) : NULL;
+    DODA_ASSERT(arena != NULL); if (!arena) { free(t); return; }
+    DodaSharedTable s; doda_shared_init(&s, t);
+    for (int i = 0; i < 300; ++i) { int v = i % 50; const void *vals[] = {&i, &v}; DODA_ASSERT_EQ_INT(DS_OK, doda_shared_insert_row(&s, vals)); }
+    int gone = 7; size_t deleted = 0;
+    DODA_ASSERT_EQ_INT(DS_OK, doda_shared_delete_where_eq(&s, "id", &gone, &deleted));
+    DODA_ASSERT_EQ_INT(1, deleted);
+    DODA_ASSERT_EQ_INT(DS_OK, doda_shared_delete_row(&s, 8));
+
+    int lo = 40; Predicate p = {"v", OP_GTE, &lo};
+    size_t expect = 0; select_where_all(t, &p, 1, count_row, &expect);
+    uint32_t ids[64]; size_t n = 0;
+    DODA_ASSERT_EQ_INT(DS_OK, doda_shared_select_all(&s, &p, 1, ids, 64, &n));
+    DODA_ASSERT_EQ_INT(expect, n);
+    for (size_t i = 0; i < n && i < 64; ++i) DODA_ASSERT(t->columns[1].data.int_data[ids[i]] >= 40);
+    // Too small a buffer: the first cap ids are kept, the count is exact
+    DODA_ASSERT_EQ_INT(DS_OK, doda_shared_select_all(&s, &p, 1, ids, 5, &n));
+    DODA_ASSERT_EQ_INT(expect, n);
+
+    uint32_t rows[512]; Index idx;
+    DODA_ASSERT(index_build_arena(t, &idx, "v", rows, 512u));
+    DODA_ASSERT(index_attach(t, &idx));
+    int key = 10; int v = 10, id = 1000; const void *vals[] = {&id, &v};
+    DODA_ASSERT_EQ_INT(DS_OK, doda_shared_insert_row(&s, vals));
+    DODA_ASSERT_EQ_INT(IDX_OK, doda_shared_index_select_op(&s, &idx, OP_EQ, &key, ids, 64, &n));
+    DODA_ASSERT_EQ_INT(7, n); // six of i % 50 == 10, plus id 1000
+    for (size_t i = 0; i < n; ++i) DODA_ASSERT_EQ_INT(10, t->columns[1].data.int_data[ids[i]]);
+
+    const char *cname = "v"; AggResult a, b;
+    DODA_ASSERT_EQ_INT(DS_OK, doda_shared_agg_columns(&s, &cname, 1, &p, 1, &a));
+    DODA_ASSERT_EQ_INT(DS_OK, agg_columns(t, &cname, 1, &p, 1, &b));
+    DODA_ASSERT_EQ_INT(b.count, a.count);
+    DODA_ASSERT(a.sum == b.sum);
+    DODA_ASSERT_EQ_INT(0, s.seq & 1u);
+    DODA_ASSERT_EQ_INT(0, s.read_retries);
+    index_detach(t, &idx);
+    free(arena); free(t);
+}
+
+// Every write section inserts a pair {+k, -k} (and retires the oldest pair once the table
+// holds enough), so any consistent view has sum 0, an even count and as many positive as
+// negative values. Readers check that on every read while the writer runs.
+#define SHARED_PAIRS 20000
+#define SHARED_LIVE_PAIRS 400
+#define SHARED_READERS 3
+
+typedef struct {
+    DodaSharedTable *s;
+    const Index *idx;
+    int *started;         // readers running (atomic)
+    int done;             // set by the writer (atomic)
+    size_t reads, bad;    // per reader
+} SharedRun;
+
+typedef struct { const Index *idx; size_t pos, neg; } SignCount;
+
+static DSStatus read_signs(const Table *t, void *user) {
+    SignCount *c = (SignCount *)user;
+    int zero = 0; c->pos = 0; c->neg = 0;
+    index_select_op(t, c->idx, OP_GT, &zero, count_row, &c->pos);
+    index_select_op(t, c->idx, OP_LT, &zero, count_row, &c->neg);
+    return DS_OK;
+}
+
+static void *shared_reader(void *arg) {
+    SharedRun *run = (SharedRun *)arg;
+    const char *cname = "v";
+    __atomic_fetch_add(run->started, 1, __ATOMIC_RELEASE);
+    do {
+        AggResult a;
+        if (doda_shared_agg_columns(run->s, &cname, 1, NULL, 0, &a) != DS_OK || a.sum != 0.0 || (a.count & 1u)) run->bad++;
+        SignCount c = { run->idx, 0, 0 };
+        doda_shared_read(run->s, read_signs, &c);
+        if (c.pos != c.neg) run->bad++;
+        run->reads++;
+    } while (!__atomic_load_n(&run->done, __ATOMIC_ACQUIRE));
+    return NULL;
+}
+
+DODA_TEST(test_shared_concurrent_readers_see_whole_write_sections) {
+    const size_t cap = 2u * SHARED_LIVE_PAIRS + 64u;
+    Table *t = (Table *)malloc(sizeof(Table));
+    uint32_t *rows = (uint32_t *)malloc(cap * sizeof(uint32_t));
+    void *arena = t && rows ? shared_table(t, cap) : NULL;
+    DODA_ASSERT(arena != NULL); if (!arena) { free(rows); free(t); return; }
+    Index idx;
+    DODA_ASSERT(index_build_arena(t, &idx, "v", rows, cap));
+    DODA_ASSERT(index_attach(t, &idx));
+    DodaSharedTable s; doda_shared_init(&s, t);
+
+    SharedRun run[SHARED_READERS]; pthread_t th[SHARED_READERS];
+    int started = 0;
+    for (int i = 0; i < SHARED_READERS; ++i) {
+        memset(&run[i], 0, sizeof(run[i])); run[i].s = &s; run[i].idx = &idx; run[i].started = &started;
+        DODA_ASSERT_EQ_INT(0, pthread_create(&th[i], NULL, shared_reader, &run[i]));
+    }
+    while (__atomic_load_n(&started, __ATOMIC_ACQUIRE) < SHARED_READERS) {}
+    size_t failed = 0, dropped = 0;
+    for (int k = 1; k <= SHARED_PAIRS; ++k) {
+        int id0 = 2 * k, id1 = 2 * k + 1, pos = k, neg = -k;
+        const void *a[] = {&id0, &pos}, *b[] = {&id1, &neg};
+        doda_shared_write_begin(&s);
+        if (k > SHARED_LIVE_PAIRS) {
+            int old0 = 2 * (k - SHARED_LIVE_PAIRS), old1 = old0 + 1;
+            size_t d0 = 0, d1 = 0;
+            failed += delete_where_eq(t, "id", &old0, &d0) != DS_OK;
+            failed += delete_where_eq(t, "id", &old1, &d1) != DS_OK;
+            dropped += d0 + d1;
+        }
+        failed += insert_row(t, a) != DS_OK;
+        failed += insert_row(t, b) != DS_OK;
+        doda_shared_write_end(&s);
+    }
+    for (int i = 0; i < SHARED_READERS; ++i) __atomic_store_n(&run[i].done, 1, __ATOMIC_RELEASE);
+    size_t reads = 0, bad = 0;
+    for (int i = 0; i < SHARED_READERS; ++i) { pthread_join(th[i], NULL); reads += run[i].reads; bad += run[i].bad; }
+
+    DODA_ASSERT_EQ_INT(0, failed);
+    DODA_ASSERT_EQ_INT(2 * (SHARED_PAIRS - SHARED_LIVE_PAIRS), dropped);
+    DODA_ASSERT(reads > 0);
+    DODA_ASSERT_EQ_INT(0, bad);
+    DODA_ASSERT_EQ_INT(2 * SHARED_LIVE_PAIRS, agg_count(t));
+    DODA_ASSERT_EQ_INT(2 * SHARED_LIVE_PAIRS, idx.size);
+    index_detach(t, &idx);
+    free(arena); free(rows); free(t);
+}
+#endif // DRIVERSQL_THREADS
+
+void doda_register_shared_tests(void) {
+#ifdef DRIVERSQL_THREADS
+    DODA_REGISTER(test_shared_reads_match_plain_queries);
+    DODA_REGISTER(test_shared_concurrent_readers_see_whole_write_sections);
+#endif
+}
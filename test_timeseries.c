@@ -3,6 +3,13 @@
 #ifdef DRIVERSQL_TIMESERIES
 #include "doda_api.h"
 #include "doda_engine.h"
+#include "doda_ring.h"
+
+#include <limits.h>
+#include <stdlib.h>
+#ifdef DRIVERSQL_THREADS
+#include <pthread.h>
+#endif
 
 static void cb_count(const DodaTable *t, size_t row, void *user) {
     (void)t; (void)row;
@@ -29,8 +36,318 @@ DODA_TEST(test_ts_append_and_select_ge) {
     DODA_ASSERT_EQ_INT(2, cnt);
 }
 
+DODA_TEST(test_ts_time_index_follows_appends_and_retention) {
+    const char *cols[] = {"id", "time", "value"};
+    DodaColumnType types[] = {COL_INT, COL_INT, COL_INT};
+    DodaTable t;
+    doda_init_table(&t, "metrics", 3, cols, types);
+
+    DodaTSDB ts;
+    doda_tsdb_init(&ts, &t, "time");
+    DodaIndex idx;
+    DODA_ASSERT(doda_tsdb_build_time_index(&ts, &idx));
+
+    for (int i = 0; i < 100; ++i) DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_tsdb_append_int3(&ts, i, 1000 + i * 10, i));
+    DODA_ASSERT_EQ_INT(100, idx.size);
+
+    size_t deleted = 0;
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_tsdb_delete_older_than(&ts, 1500, &deleted));
+    DODA_ASSERT_EQ_INT(50, deleted);
+    DODA_ASSERT_EQ_INT(50, idx.size);
+
+    size_t cnt = 0;
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_tsdb_select_time_ge(&ts, 1900, (doda_row_callback)cb_count, &cnt));
+    DODA_ASSERT_EQ_INT(10, cnt);
+}
+
+DODA_TEST(test_ts_select_time_range_half_open) {
+    const char *cols[] = {"id", "time", "value"};
+    DodaColumnType types[] = {COL_INT, COL_INT, COL_INT};
+    DodaTable t;
+    doda_init_table(&t, "metrics", 3, cols, types);
+
+    DodaTSDB ts;
+    doda_tsdb_init(&ts, &t, "time");
+    for (int i = 0; i < 100; ++i) DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_tsdb_append_int3(&ts, i, 1000 + i * 10, i));
+
+    for (int pass = 0; pass < 2; ++pass) {
+        DodaIndex idx;
+        if (pass == 1) DODA_ASSERT(doda_tsdb_build_time_index(&ts, &idx));
+        size_t cnt = 0;
+        DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_tsdb_select_time_range(&ts, 1200, 1300, (doda_row_callback)cb_count, &cnt));
+        DODA_ASSERT_EQ_INT(10, cnt); // 1200..1290, 1300 excluded
+        cnt = 0;
+        DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_tsdb_select_time_range(&ts, 1205, 1211, (doda_row_callback)cb_count, &cnt));
+        DODA_ASSERT_EQ_INT(1, cnt);
+        cnt = 0;
+        DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_tsdb_select_time_range(&ts, 1300, 1300, (doda_row_callback)cb_count, &cnt));
+        DODA_ASSERT_EQ_INT(0, cnt);
+        if (pass == 1) doda_index_detach(&t, &idx);
+    }
+}
+
+#ifndef DRIVERSQL_NO_DOUBLE
+typedef struct { DodaRollupBucket b[16]; size_t n; } RollupLog;
+static void cb_rollup(const DodaRollupBucket *b, void *user) { RollupLog *l = (RollupLog *)user; if (l->n < 16) l->b[l->n++] = *b; }
+
+DODA_TEST(test_ts_rollup_buckets_and_dest_table) {
+    const char *cols[] = {"id", "time", "value"};
+    DodaColumnType types[] = {COL_INT, COL_INT, COL_INT};
+    DodaTable t;
+    doda_init_table(&t, "metrics", 3, cols, types);
+    DodaTSDB ts;
+    doda_tsdb_init(&ts, &t, "time");
+    // times -25..34 step 1, value = time
+    for (int i = 0; i < 60; ++i) DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_tsdb_append_int3(&ts, i, i - 25, i - 25));
+
+    RollupLog log; log.n = 0;
+    unsigned all = DODA_ROLLUP_COUNT | DODA_ROLLUP_MIN | DODA_ROLLUP_MAX | DODA_ROLLUP_AVG | DODA_ROLLUP_FIRST | DODA_ROLLUP_LAST;
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_tsdb_rollup(&ts, "value", 10, all, NULL, cb_rollup, &log));
+    DODA_ASSERT_EQ_INT(7, log.n); // [-30,-20) .. [30,40)
+    DODA_ASSERT_EQ_INT(-30, log.b[0].bucket);
+    DODA_ASSERT_EQ_INT(5, log.b[0].count);
+    DODA_ASSERT(log.b[0].first == -25.0 && log.b[0].last == -21.0 && log.b[0].min == -25.0 && log.b[0].max == -21.0);
+    DODA_ASSERT_EQ_INT(10, log.b[1].count);
+    DODA_ASSERT(log.b[1].avg == -15.5);
+    DODA_ASSERT_EQ_INT(30, log.b[6].bucket);
+    DODA_ASSERT_EQ_INT(5, log.b[6].count);
+
+    // Window [0, 20) into a dest table keyed by bucket start
+    const char *rcols[] = {"bucket", "n", "avg", "last"};
+    DodaColumnType rtypes[] = {COL_INT, COL_INT, COL_DOUBLE, COL_INT};
+    DodaTable dest;
+    doda_init_table(&dest, "rollup", 4, rcols, rtypes);
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_tsdb_rollup_range(&ts, "value", 0, 20, 10, DODA_ROLLUP_COUNT | DODA_ROLLUP_AVG | DODA_ROLLUP_LAST, &dest, NULL, NULL));
+    DODA_ASSERT_EQ_INT(2, dest.count);
+    DODA_ASSERT_EQ_INT(10, dest.columns[0].data.int_data[1]);
+    DODA_ASSERT_EQ_INT(10, dest.columns[1].data.int_data[1]);
+    DODA_ASSERT(dest.columns[2].data.double_data[1] == 14.5);
+    DODA_ASSERT_EQ_INT(19, dest.columns[3].data.int_data[1]);
+    DODA_ASSERT_EQ_INT(DodaStatus_ERR_INVALID, doda_tsdb_rollup(&ts, "value", 10, DODA_ROLLUP_COUNT, &dest, NULL, NULL));
+
+    // Out-of-order rows need the time index
+    size_t deleted = 0; int old = -25;
+    doda_delete_where_eq(&t, "time", &old, &deleted);
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_tsdb_append_int3(&ts, 100, -26, 7)); // reuses the freed first slot
+    log.n = 0;
+    DODA_ASSERT_EQ_INT(DodaStatus_ERR_UNSUPPORTED, doda_tsdb_rollup(&ts, "value", 10, DODA_ROLLUP_FIRST, NULL, cb_rollup, &log));
+    DODA_ASSERT_EQ_INT(0, log.n);
+    DodaIndex idx;
+    DODA_ASSERT(doda_tsdb_build_time_index(&ts, &idx));
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_tsdb_rollup(&ts, "value", 10, DODA_ROLLUP_FIRST | DODA_ROLLUP_COUNT, NULL, cb_rollup, &log));
+    DODA_ASSERT_EQ_INT(7, log.n);
+    DODA_ASSERT(log.b[0].first == 7.0);
+    DODA_ASSERT_EQ_INT(5, log.b[0].count);
+    doda_index_detach(&t, &idx);
+}
+#endif
+
+DODA_TEST(test_ts_seal_older_than_moves_samples_to_block) {
+    const char *cols[] = {"id", "time", "value"};
+    DodaColumnType types[] = {COL_INT, COL_INT, COL_INT};
+    DodaTable t;
+    doda_init_table(&t, "metrics", 3, cols, types);
+    DodaTSDB ts;
+    doda_tsdb_init(&ts, &t, "time");
+    for (int i = 0; i < 50; ++i) DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_tsdb_append_int3(&ts, i, 1000 + i, i * 3));
+
+    uint8_t buf[1024], tiny[16]; DodaSealedBlock b; size_t sealed = 0, n = 0;
+    DODA_ASSERT_EQ_INT(DodaStatus_ERR_FULL, doda_tsdb_seal_older_than(&ts, 1030, tiny, sizeof(tiny), &b, &sealed));
+    DODA_ASSERT_EQ_INT(50, t.count - t.free_top); // nothing deleted on failure
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_tsdb_seal_older_than(&ts, 1030, buf, sizeof(buf), &b, &sealed));
+    DODA_ASSERT_EQ_INT(30, sealed);
+    DODA_ASSERT_EQ_INT(20, t.count - t.free_top);
+    doda_tsdb_select_time_lt(&ts, 1030, cb_count, &n);
+    DODA_ASSERT_EQ_INT(0, n);
+
+    const char *metric[] = {"value"}; DodaAggResult r;
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_sealed_agg_columns(&b, metric, 1, NULL, 0, &r));
+    DODA_ASSERT_EQ_INT(30, r.count);
+    DODA_ASSERT(r.max == 87.0 && r.sum == 3.0 * 435.0);
+}
+
+static void cb_bucket_count(const DodaRollupBucket *b, void *user) { *(size_t *)user += b->count; }
+
+// Ring of 4 x 16-row chunks: rotation at the head, FULL when every chunk is live, whole-chunk
+// retention drops, range selects skipping chunks, rollup across chunks and sealing the oldest
+DODA_TEST(test_ts_chunked_ring_rotates_and_drops_chunks) {
+    const char *cols[] = {"id", "time", "value"};
+    DodaColumnType types[] = {COL_INT, COL_INT, COL_INT};
+    static DodaTSChunk chunks[4];
+    static uint8_t arena[4 * 4096];
+    DodaTSDB ts;
+    size_t need = doda_tsdb_chunked_arena_bytes(4, 16, 3, types);
+    DODA_ASSERT(need > 0 && need <= sizeof(arena));
+    // A chunk pays for a table header and its rows, never for the static MAX_ROWS storage
+    DODA_ASSERT(need <= 4u * (doda_table_header_bytes() + doda_table_arena_bytes(3, types, 16)) + 7u);
+#ifndef DRIVERSQL_NO_STATIC_ROWS
+    DODA_ASSERT(doda_table_header_bytes() < sizeof(DodaTable) / 8u);
+#endif
+    DODA_ASSERT_EQ_INT(DodaStatus_ERR_INVALID, doda_tsdb_init_chunked(&ts, chunks, 4, 16, 3, cols, types, "time", arena, need - 1u));
+    DODA_ASSERT_EQ_INT(DodaStatus_ERR_NOT_FOUND, doda_tsdb_init_chunked(&ts, chunks, 4, 16, 3, cols, types, "nope", arena, need));
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_tsdb_init_chunked(&ts, chunks, 4, 16, 3, cols, types, "time", arena, need));
+    DODA_ASSERT(ts.table == NULL);
+
+    for (int i = 0; i < 64; ++i) DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_tsdb_append_int3(&ts, i, 1000 + i, i));
+    DODA_ASSERT_EQ_INT(4, ts.live);
+    DODA_ASSERT(ts.table == chunks[3].table);
+    DODA_ASSERT_EQ_INT(DodaStatus_ERR_FULL, doda_tsdb_append_int3(&ts, 64, 1064, 64));
+    DODA_ASSERT_EQ_INT(1000, chunks[0].min_time);
+    DODA_ASSERT_EQ_INT(1015, chunks[0].max_time);
+
+    size_t n = 0;
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_tsdb_select_time_range(&ts, 1010, 1040, cb_count, &n));
+    DODA_ASSERT_EQ_INT(30, n);
+    n = 0; doda_tsdb_select_time_gt(&ts, 1047, cb_count, &n);
+    DODA_ASSERT_EQ_INT(16, n);
+    n = 0; doda_tsdb_select_time_lt(&ts, 1000, cb_count, &n);
+    DODA_ASSERT_EQ_INT(0, n);
+
+    // Chunk 0 is dropped whole, chunk 1 straddles the cutoff and loses rows 16..19
+    size_t deleted = 0;
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_tsdb_delete_older_than(&ts, 1020, &deleted));
+    DODA_ASSERT_EQ_INT(20, deleted);
+    DODA_ASSERT_EQ_INT(3, ts.live);
+    DODA_ASSERT_EQ_INT(1020, chunks[1].min_time);
+    n = 0; doda_tsdb_select_time_ge(&ts, INT_MIN, cb_count, &n);
+    DODA_ASSERT_EQ_INT(44, n);
+
+    // The freed chunk is reused (cleared) as the new head
+    for (int i = 64; i < 70; ++i) DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_tsdb_append_int3(&ts, i, 1000 + i, i));
+    DODA_ASSERT(ts.table == chunks[0].table);
+    DODA_ASSERT_EQ_INT(6, chunks[0].table->count);
+    DODA_ASSERT_EQ_INT(1064, chunks[0].min_time);
+
+    size_t rolled = 0;
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_tsdb_rollup(&ts, "value", 8, DODA_ROLLUP_COUNT, NULL, cb_bucket_count, &rolled));
+    DODA_ASSERT_EQ_INT(50, rolled);
+    DODA_ASSERT(!doda_tsdb_build_time_index(&ts, &(DodaIndex){0}));
+
+    uint8_t buf[512]; DodaSealedBlock b; size_t sealed = 0;
+    DODA_ASSERT_EQ_INT(DodaStatus_ERR_UNSUPPORTED, doda_tsdb_seal_older_than(&ts, 1030, buf, sizeof(buf), &b, &sealed));
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_tsdb_seal_oldest_chunk(&ts, buf, sizeof(buf), &b, &sealed));
+    DODA_ASSERT_EQ_INT(12, sealed);
+    DODA_ASSERT_EQ_INT(3, ts.live);
+    const char *metric[] = {"time"}; DodaAggResult r;
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_sealed_agg_columns(&b, metric, 1, NULL, 0, &r));
+    DODA_ASSERT(r.min == 1020.0 && r.max == 1031.0);
+
+    size_t dropped = 0;
+    for (int k = 0; k < 3; ++k) DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_tsdb_drop_oldest_chunk(&ts, &dropped));
+    DODA_ASSERT_EQ_INT(6, dropped);
+    DODA_ASSERT(ts.table == NULL);
+    DODA_ASSERT_EQ_INT(DodaStatus_ERR_NOT_FOUND, doda_tsdb_drop_oldest_chunk(&ts, &dropped));
+}
+
+// SPSC: FIFO order, a full ring refuses pushes (counted as drops), partial drains, and
+// samples the table refuses (duplicate id) counted as rejected
+DODA_TEST(test_ts_ring_spsc_backpressure_and_drain) {
+    const char *cols[] = {"id", "time", "value"};
+    DodaColumnType types[] = {COL_INT, COL_INT, COL_INT};
+    DodaTable t; DodaTSDB ts; DodaTSRing r; DodaTSSample slots[8];
+    doda_init_table(&t, "ring", 3, cols, types);
+    doda_tsdb_init(&ts, &t, "time");
+    DODA_ASSERT_EQ_INT(DodaStatus_ERR_INVALID, doda_ts_ring_init(&r, slots, NULL, 6));
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_ts_ring_init(&r, slots, NULL, 8));
+
+    int accepted = 0;
+    for (int i = 0; i < 10; ++i) accepted += doda_ts_ring_push(&r, i, 100 + i, i * 2);
+    DODA_ASSERT_EQ_INT(8, accepted);
+    DODA_ASSERT_EQ_INT(8, doda_ts_ring_pending(&r));
+    DODA_ASSERT_EQ_INT(3, doda_ts_ring_drain(&r, &ts, 3));
+    DODA_ASSERT_EQ_INT(3, t.count);
+    for (int i = 10; i < 13; ++i) DODA_ASSERT(doda_ts_ring_push(&r, i, 100 + i, i * 2));
+    DODA_ASSERT(doda_ts_ring_push(&r, 0, 200, 0) == false); // full again
+    DODA_ASSERT_EQ_INT(8, doda_ts_ring_drain(&r, &ts, 0));
+    DODA_ASSERT(doda_ts_ring_push(&r, 4, 300, 0)); // id 4 is already in the table
+    DODA_ASSERT_EQ_INT(1, doda_ts_ring_drain(&r, &ts, 0));
+
+    // Rows landed in push order (ids 8 and 9 were dropped)
+    DODA_ASSERT_EQ_INT(11, t.count);
+    const int expect[] = {0, 1, 2, 3, 4, 5, 6, 7, 10, 11, 12};
+    for (size_t k = 0; k < 11; ++k) {
+        DODA_ASSERT_EQ_INT(expect[k], t.columns[0].data.int_data[k]);
+        DODA_ASSERT_EQ_INT(100 + expect[k], t.columns[1].data.int_data[k]);
+    }
+    DodaTSRingStats st; doda_ts_ring_stats(&r, &st);
+    DODA_ASSERT_EQ_INT(12, st.pushed);
+    DODA_ASSERT_EQ_INT(3, st.dropped);
+    DODA_ASSERT_EQ_INT(0, st.pending);
+    DODA_ASSERT_EQ_INT(8, st.high_water);
+    DODA_ASSERT_EQ_INT(12, st.drained);
+    DODA_ASSERT_EQ_INT(1, st.rejected);
+}
+
+#ifdef DRIVERSQL_THREADS
+#define RING_PRODUCERS 4
+#define RING_PER_PRODUCER 5000
+
+typedef struct { DodaTSRing *r; int p; uint32_t retries; } RingProducer;
+
+static void *ring_producer(void *arg) {
+    RingProducer *pr = (RingProducer *)arg;
+    for (int i = 0; i < RING_PER_PRODUCER; ++i) {
+        int id = pr->p * RING_PER_PRODUCER + i;
+        while (!doda_ts_ring_push(pr->r, id, i, pr->p)) pr->retries++; // spin on backpressure
+    }
+    return NULL;
+}
+
+// MPSC: producer threads push while the consumer drains; every sample arrives exactly once
+// and each producer's samples keep their order
+DODA_TEST(test_ts_ring_mpsc_threads_deliver_every_sample) {
+    const char *cols[] = {"id", "time", "value"};
+    DodaColumnType types[] = {COL_INT, COL_INT, COL_INT};
+    const size_t rows = (size_t)RING_PRODUCERS * RING_PER_PRODUCER;
+    DodaTable *t = (DodaTable *)malloc(sizeof(DodaTable));
+    size_t need = doda_table_arena_bytes(3, types, rows);
+    void *arena = malloc(need);
+    DODA_ASSERT(t && arena); if (!t || !arena) { free(arena); free(t); return; }
+    DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_table_init_arena(t, "mpsc", 3, cols, types, arena, need, rows));
+    DodaTSDB ts; doda_tsdb_init(&ts, t, "time");
+    static DodaTSSample slots[256]; static uint32_t seqs[256];
+    DodaTSRing r; DODA_ASSERT_EQ_INT(DodaStatus_OK, doda_ts_ring_init(&r, slots, seqs, 256));
+
+    RingProducer pr[RING_PRODUCERS]; pthread_t th[RING_PRODUCERS];
+    for (int p = 0; p < RING_PRODUCERS; ++p) {
+        pr[p].r = &r; pr[p].p = p; pr[p].retries = 0;
+        DODA_ASSERT_EQ_INT(0, pthread_create(&th[p], NULL, ring_producer, &pr[p]));
+    }
+    size_t got = 0;
+    while (got < rows) got += doda_ts_ring_drain(&r, &ts, 0);
+    uint32_t retries = 0;
+    for (int p = 0; p < RING_PRODUCERS; ++p) { pthread_join(th[p], NULL); retries += pr[p].retries; }
+
+    DodaTSRingStats st; doda_ts_ring_stats(&r, &st);
+    DODA_ASSERT_EQ_INT(rows, got);
+    DODA_ASSERT_EQ_INT(rows, st.pushed);
+    DODA_ASSERT_EQ_INT(retries, st.dropped);
+    DODA_ASSERT_EQ_INT(0, st.rejected);
+    DODA_ASSERT_EQ_INT(rows, t->count);
+    int last[RING_PRODUCERS]; size_t in_order = 0;
+    for (int p = 0; p < RING_PRODUCERS; ++p) last[p] = -1;
+    for (size_t k = 0; k < t->count; ++k) {
+        int p = t->columns[2].data.int_data[k], i = t->columns[1].data.int_data[k];
+        in_order += i == last[p] + 1; last[p] = i;
+    }
+    DODA_ASSERT_EQ_INT(rows, in_order);
+    free(arena); free(t);
+}
+#endif
+
 void doda_register_timeseries_tests(void) {
     DODA_REGISTER(test_ts_append_and_select_ge);
+    DODA_REGISTER(test_ts_time_index_follows_appends_and_retention);
+    DODA_REGISTER(test_ts_select_time_range_half_open);
+    DODA_REGISTER(test_ts_seal_older_than_moves_samples_to_block);
+    DODA_REGISTER(test_ts_chunked_ring_rotates_and_drops_chunks);
+    DODA_REGISTER(test_ts_ring_spsc_backpressure_and_drain);
+#ifdef DRIVERSQL_THREADS
+    DODA_REGISTER(test_ts_ring_mpsc_threads_deliver_every_sample);
+#endif
+#ifndef DRIVERSQL_NO_DOUBLE
+    DODA_REGISTER(test_ts_rollup_buckets_and_dest_table);
+#endif
 }
 
 #else
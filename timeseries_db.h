@@ -41,6 +41,11 @@ static inline DSStatus tsdb_select_time_gt(const TSDB *ts, int t0, row_callback
 static inline DSStatus tsdb_select_time_lt(const TSDB *ts, int t1, row_callback cb, void *user) {
     return select_where_op(ts->table, ts->time_col, OP_LT, &t1, cb, user);
 }
+// Half-open window [t0, t1)
+static inline DSStatus tsdb_select_time_range(const TSDB *ts, int t0, int t1, row_callback cb, void *user) {
+    if (t1 <= t0) return DS_OK;
+    int range[2] = {t0, t1 - 1}; return select_where_op(ts->table, ts->time_col, OP_BETWEEN, range, cb, user);
+}
 
 // Build index on time column for efficient ranges
 static inline bool tsdb_build_time_index(TSDB *ts, Index *idx) { return index_build(ts->table, idx, ts->time_col); }
@@ -52,7 +57,7 @@ static inline DSStatus tsdb_delete_older_than(TSDB *ts, int cutoff_time, size_t
     for (size_t r = 0; r < ts->table->count; ++r) {
         if (is_deleted(ts->table, r)) continue;
         int v = ts->table->columns[col].data.int_data[r];
-        if (v < cutoff_time) { ts->table->free_list[ts->table->free_top++] = (uint16_t)r; ts->table->deleted_bits[r/64] |= (1ULL << (r%64)); del++; }
+        if (v < cutoff_time) { delete_row(ts->table, r); del++; }
     }
     if (deleted_out) *deleted_out = del; return DS_OK;
 }